@@ -160,6 +160,10 @@ file_ref_t loc_file_ref(const char *name, const char *linebuf)
       .ref      = loc_files.count
    };
 
+   // The relative name cannot be resolved from the working directory
+   if (relative != NULL)
+      new.abs_str = realpath(name, NULL);
+
    APUSH(loc_files, new);
 
    return new.ref;
@@ -173,7 +177,7 @@ const char *loc_file_str(const loc_t *loc)
       return NULL;
 }
 
-static const char *loc_abs_path(const loc_t *loc)
+const char *loc_abs_path(const loc_t *loc)
 {
    if (loc->file_ref == FILE_INVALID)
       return NULL;
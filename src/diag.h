@@ -55,6 +55,7 @@ STATIC_ASSERT(sizeof(loc_t) == 8);
 
 void fmt_loc(FILE *f, const loc_t *loc);
 const char *loc_file_str(const loc_t *loc);
+const char *loc_abs_path(const loc_t *loc);
 loc_t get_loc(unsigned first_line, unsigned first_column,
               unsigned last_line, unsigned last_column,
               file_ref_t file_ref);
@@ -18,6 +18,8 @@
 #include "util.h"
 #include "fbuf.h"
 #include "fastlz.h"
+#include "lz4.h"
+#include "option.h"
 
 #include <stdlib.h>
 #include <string.h>
@@ -76,6 +78,8 @@ struct _fbuf {
    uint8_t     *rbuf;
    size_t       rptr;
    size_t       origsz;
+   uint8_t     *rmap;
+   size_t       rmapsz;
    fbuf_t      *next;
    fbuf_t      *prev;
    cs_state_t   checksum;
@@ -339,6 +343,31 @@ static void fbuf_decompress_fastlz(fbuf_t *f, uint8_t *rmap, size_t bufsz)
    }
 }
 
+static void fbuf_decompress_lz4(fbuf_t *f, uint8_t *rmap, size_t bufsz)
+{
+   uint8_t *const end = f->rbuf + f->origsz;
+   for (uint8_t *dst = f->rbuf, *src = rmap; dst < end;) {
+      const uint32_t blksz = UNPACK_BE32(src);
+      if (blksz > SPILL_SIZE)
+         fatal("file %s has invalid compression format", f->fname);
+
+      src += sizeof(uint32_t);
+
+      if (src + blksz > (uint8_t *)rmap + bufsz)
+         fatal_trace("read past end of compressed file %s", f->fname);
+
+      const int ret = LZ4_decompress_safe((char *)src, (char *)dst, blksz,
+                                          MIN(end - dst, SPILL_SIZE));
+      if (ret <= 0)
+         fatal("file %s has invalid compression format", f->fname);
+
+      checksum_update(&(f->checksum), dst, ret);
+
+      dst += ret;
+      src += blksz;
+   }
+}
+
 static void fbuf_decompress_zstd(fbuf_t *f, uint8_t *rmap, size_t bufsz)
 {
    size_t dsize = ZSTD_decompress(f->rbuf, f->origsz, rmap, bufsz);
@@ -403,18 +432,32 @@ static void fbuf_decompress(fbuf_t *f)
 
    f->origsz = len;
    f->checksum.expect = checksum;
-   f->rbuf = xmalloc(f->origsz);
 
    uint8_t *payload = rmap + header_sz + userheader;
    const size_t payloadsz = filesz - header_sz - userheader;
 
+   if (header[4] == FBUF_ZIP_NONE) {
+      if (f->origsz > payloadsz)
+         fatal("%s has inconsistent uncompressed size %zu vs payload "
+               "size %zu", f->fname, f->origsz, payloadsz);
+
+      // Read directly from the mapping which is kept until the file is
+      // closed so the pages can be shared with other processes
+      f->rbuf   = payload;
+      f->rmap   = rmap;
+      f->rmapsz = filesz;
+      checksum_update(&(f->checksum), f->rbuf, f->origsz);
+      return;
+   }
+
+   f->rbuf = xmalloc(f->origsz);
+
    switch (header[4]) {
    case FBUF_ZIP_FASTLZ:
       fbuf_decompress_fastlz(f, payload, payloadsz);
       break;
-   case FBUF_ZIP_NONE:
-      memcpy(f->rbuf, payload, f->origsz);
-      checksum_update(&(f->checksum), f->rbuf, f->origsz);
+   case FBUF_ZIP_LZ4:
+      fbuf_decompress_lz4(f, payload, payloadsz);
       break;
    case FBUF_ZIP_ZSTD:
       fbuf_decompress_zstd(f, payload, payloadsz);
@@ -427,6 +470,38 @@ static void fbuf_decompress(fbuf_t *f)
    unmap_file(rmap, filesz);
 }
 
+static fbuf_zip_t fbuf_default_zip(void)
+{
+   const char *str = opt_get_str(OPT_COMPRESSION);
+   if (str == NULL)
+      return DEFAULT_ZIP;
+   else if (strcmp(str, "none") == 0 || strcmp(str, "0") == 0)
+      return FBUF_ZIP_NONE;
+   else if (strcmp(str, "fastlz") == 0)
+      return FBUF_ZIP_FASTLZ;
+   else if (strcmp(str, "lz4") == 0)
+      return FBUF_ZIP_LZ4;
+   else if (strcmp(str, "zstd") == 0 || strcmp(str, "1") == 0)
+      return FBUF_ZIP_ZSTD;
+   else
+      fatal("invalid value '%s' for NVC_COMPRESS, valid values are none, "
+            "fastlz, lz4, and zstd", str);
+}
+
+static void fbuf_zstd_init(fbuf_t *f)
+{
+   if ((f->zstd = ZSTD_createCCtx()) == NULL)
+      fatal_trace("ZSTD_createCCtx() failed");
+
+   size_t rc = ZSTD_CCtx_setParameter(f->zstd, ZSTD_c_compressionLevel, 3);
+   if (ZSTD_isError(rc))
+      fatal("failed to set ZSTD compression level: %s",
+            ZSTD_getErrorName(rc));
+
+   f->zbufsz = ZSTD_CStreamOutSize();
+   f->zbuf = xmalloc(f->zbufsz);
+}
+
 fbuf_t *fbuf_open(const char *file, fbuf_mode_t mode, fbuf_cs_t csum)
 {
    FILE *h = fopen(file, mode == FBUF_OUT ? "wb" : "rb");
@@ -438,25 +513,16 @@ fbuf_t *fbuf_open(const char *file, fbuf_mode_t mode, fbuf_cs_t csum)
    f->fname = xstrdup(file);
    f->mode  = mode;
    f->next  = open_list;
-   f->zip   = DEFAULT_ZIP;
 
    checksum_init(&(f->checksum), csum);
 
-   if (f->zip == FBUF_ZIP_ZSTD && mode == FBUF_OUT) {
-      if ((f->zstd = ZSTD_createCCtx()) == NULL)
-         fatal_trace("ZSTD_createCCtx() failed");
-
-      size_t rc = ZSTD_CCtx_setParameter(f->zstd, ZSTD_c_compressionLevel, 3);
-      if (ZSTD_isError(rc))
-         fatal("failed to set ZSTD compression level: %s",
-               ZSTD_getErrorName(rc));
-
-      f->zbufsz = ZSTD_CStreamOutSize();
-      f->zbuf = xmalloc(f->zbufsz);
-   }
-
    if (mode == FBUF_OUT) {
+      f->zip  = fbuf_default_zip();
       f->wbuf = xmalloc(SPILL_SIZE);
+
+      if (f->zip == FBUF_ZIP_ZSTD)
+         fbuf_zstd_init(f);
+
       fbuf_write_header(f);
    }
    else
@@ -468,6 +534,33 @@ fbuf_t *fbuf_open(const char *file, fbuf_mode_t mode, fbuf_cs_t csum)
    return (open_list = f);
 }
 
+void fbuf_set_zip(fbuf_t *f, fbuf_zip_t zip)
+{
+   assert(f->mode == FBUF_OUT);
+   assert(f->wpend == 0 && f->wtotal == 0);
+
+   if (opt_get_str(OPT_COMPRESSION) != NULL)
+      return;   // NVC_COMPRESS overrides the format for every file
+   else if (zip == f->zip)
+      return;
+
+   if (f->zstd != NULL) {
+      ZSTD_freeCCtx(f->zstd);
+      free(f->zbuf);
+      f->zstd = NULL;
+      f->zbuf = NULL;
+   }
+
+   if ((f->zip = zip) == FBUF_ZIP_ZSTD)
+      fbuf_zstd_init(f);
+
+   // Rewrite the header with the new compression format
+   if (fseek(f->file, 0, SEEK_SET) != 0)
+      fatal_errno("%s: fseek", f->fname);
+
+   fbuf_write_header(f);
+}
+
 const char *fbuf_file_name(fbuf_t *f)
 {
    return f->fname;
@@ -491,6 +584,20 @@ static void fbuf_compress_fastlz(fbuf_t *f)
    fbuf_write_raw(f, out, ret);
 }
 
+static void fbuf_compress_lz4(fbuf_t *f)
+{
+   char out[LZ4_COMPRESSBOUND(BLOCK_SIZE)];
+   const int ret = LZ4_compress_default((char *)f->wbuf, out, f->wpend,
+                                        sizeof(out));
+
+   assert(ret > 0 && ret < SPILL_SIZE);
+
+   const uint8_t blksz[4] = { PACK_BE32(ret) };
+   fbuf_write_raw(f, blksz, 4);
+
+   fbuf_write_raw(f, (uint8_t *)out, ret);
+}
+
 static void fbuf_compress_zstd(fbuf_t *f, bool end)
 {
    ZSTD_EndDirective mode = end ? ZSTD_e_end : ZSTD_e_continue;
@@ -527,6 +634,9 @@ static void fbuf_maybe_flush(fbuf_t *f, size_t more, bool end)
       case FBUF_ZIP_FASTLZ:
          fbuf_compress_fastlz(f);
          break;
+      case FBUF_ZIP_LZ4:
+         fbuf_compress_lz4(f);
+         break;
       case FBUF_ZIP_NONE:
          fbuf_write_raw(f, f->wbuf, f->wpend);
          break;
@@ -556,7 +666,9 @@ void fbuf_close(fbuf_t *f, uint32_t *checksum)
    if (checksum != NULL)
       *checksum = cs;
 
-   if (f->rbuf != NULL)
+   if (f->rmap != NULL)
+      unmap_file(f->rmap, f->rmapsz);
+   else if (f->rbuf != NULL)
       free(f->rbuf);
 
    if (f->wbuf != NULL) {
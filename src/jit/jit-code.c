@@ -1287,8 +1287,11 @@ static void code_load_elf(code_blob_t *blob, const void *data, size_t size)
          switch (ELF64_ST_TYPE(sym->st_info)) {
          case STT_NOTYPE:
          case STT_FUNC:
-            if (sym->st_shndx == 0)
+            if (sym->st_shndx == 0) {
                ptr = shash_get(external, strtab + sym->st_name);
+               if (ptr == NULL && blob->symbols != NULL)
+                  ptr = shash_get(blob->symbols, strtab + sym->st_name);
+            }
             else
                ptr = load_addr[sym->st_shndx] + sym->st_value;
             break;
@@ -61,6 +61,11 @@ typedef struct {
    jit_func_t *items[0];
 } func_array_t;
 
+typedef struct {
+   jit_func_t *func;
+   jit_tier_t *tier;
+} cgen_request_t;
+
 typedef struct _jit {
    chash_t          *index;
    mspace_t         *mspace;
@@ -76,6 +81,8 @@ typedef struct _jit {
    void             *interrupt_ctx;
    unit_registry_t  *registry;
    mir_context_t    *mir;
+   nvc_lock_t        cgen_lock;
+   A(cgen_request_t) cgen_queue;
 } jit_t;
 
 static void jit_transition(jit_thread_local_t *thread, jit_t *j,
@@ -148,6 +155,7 @@ static void jit_free_func(jit_func_t *f)
 {
    mptr_free(f->jit->mspace, &(f->privdata));
    free(f->irbuf);
+   free(f->icode);
    free(f->linktab);
    free(f->cpool);
    free(f);
@@ -158,6 +166,8 @@ void jit_free(jit_t *j)
    store_release(&j->shutdown, true);
    async_barrier();
 
+   ACLEAR(j->cgen_queue);
+
    for (int i = 0; i < j->next_handle; i++)
       jit_free_func(j->funcs->items[i]);
    free(j->funcs);
@@ -329,6 +339,18 @@ void jit_fill_irbuf(jit_func_t *f)
 
    jit_irgen(f, mu);
 
+   // Prefer native code generated ahead of time or by an earlier run
+   // over interpreting and waiting for the function to become hot
+   for (jit_tier_t *t = f->next_tier; t != NULL; t = t->next) {
+      if (t->plugin.load == NULL)
+         continue;
+      else if ((*t->plugin.load)(f->jit, f->handle, t->context)) {
+         f->hotness   = 0;
+         f->next_tier = NULL;
+         break;
+      }
+   }
+
    jit_transition(thread, f->jit, JIT_COMPILING, oldstate);
 }
 
@@ -350,10 +372,12 @@ void *jit_link(jit_t *j, jit_handle_t handle)
       return NULL;
 
    jit_func_t *f = jit_get_func(j, handle);
-   if (f->privdata != MPTR_INVALID)
-      return *mptr_get(f->privdata);
 
-   f->privdata = mptr_new(j->mspace, "privdata");
+   // The privdata slot may already have been allocated by code
+   // generation for a caller before the unit is initialised
+   void **privdata = jit_get_privdata_ptr(j, f);
+   if (*privdata != NULL)
+      return *privdata;
 
    jit_fill_irbuf(f);
 
@@ -365,11 +389,9 @@ void *jit_link(jit_t *j, jit_handle_t handle)
    }
    else if (result.pointer == NULL)
       fatal_trace("link %s returned NULL", istr(f->name));
-   else if (f->privdata == MPTR_INVALID)
-      fatal_trace("cannot link unit %s", istr(f->name));
 
    // Initialisation should save the context pointer
-   assert(result.pointer == *mptr_get(f->privdata));
+   assert(result.pointer == *privdata);
 
    return result.pointer;
 }
@@ -835,11 +857,33 @@ bool jit_exit_status(jit_t *j, int *status)
 
 static void jit_async_cgen(void *context, void *arg)
 {
-   jit_func_t *f = context;
-   jit_tier_t *tier = arg;
+   jit_t *j = context;
 
-   if (!jit_is_shutdown(f->jit))
-      (*tier->plugin.cgen)(f->jit, f->handle, tier->context);
+   // Each task compiles whichever pending function is currently the
+   // hottest rather than the one that was queued with it, so the
+   // workers spend their time where the program spends its cycles
+   cgen_request_t req;
+   {
+      SCOPED_LOCK(j->cgen_lock);
+
+      assert(j->cgen_queue.count > 0);
+
+      int best = 0;
+      unsigned maxheat = 0;
+      for (int i = 0; i < j->cgen_queue.count; i++) {
+         const unsigned heat = relaxed_load(&j->cgen_queue.items[i].func->heat);
+         if (heat > maxheat) {
+            best = i;
+            maxheat = heat;
+         }
+      }
+
+      req = j->cgen_queue.items[best];
+      j->cgen_queue.items[best] = APOP(j->cgen_queue);
+   }
+
+   if (!jit_is_shutdown(j))
+      (*req.tier->plugin.cgen)(j, req.func->handle, req.tier->context);
 }
 
 void jit_tier_up(jit_func_t *f)
@@ -847,13 +891,30 @@ void jit_tier_up(jit_func_t *f)
    assert(f->hotness <= 0);
    assert(f->next_tier != NULL);
 
-   if (opt_get_int(OPT_JIT_ASYNC))
-      async_do(jit_async_cgen, f, f->next_tier);
-   else
-      (f->next_tier->plugin.cgen)(f->jit, f->handle, f->next_tier->context);
+   jit_tier_t *tier = f->next_tier;
 
-   f->hotness   = 0;
-   f->next_tier = NULL;
+   // Code generated by an intermediate tier keeps counting calls until
+   // the function is hot enough for the next one
+   if (tier->next != NULL) {
+      f->hotness   = tier->next->threshold;
+      f->next_tier = tier->next;
+   }
+   else {
+      f->hotness   = 0;
+      f->next_tier = NULL;
+   }
+
+   if (opt_get_int(OPT_JIT_ASYNC)) {
+      {
+         SCOPED_LOCK(f->jit->cgen_lock);
+         const cgen_request_t req = { f, tier };
+         APUSH(f->jit->cgen_queue, req);
+      }
+
+      async_do(jit_async_cgen, f->jit, NULL);
+   }
+   else
+      (*tier->plugin.cgen)(f->jit, f->handle, tier->context);
 }
 
 void jit_add_tier(jit_t *j, int threshold, const jit_plugin_t *plugin)
@@ -869,6 +930,80 @@ void jit_add_tier(jit_t *j, int threshold, const jit_plugin_t *plugin)
    j->tiers = t;
 }
 
+static bool jit_has_unit(jit_t *j, ident_t name)
+{
+   if (mir_get_unit(j->mir, name) != NULL)
+      return true;
+   else if (j->registry == NULL)
+      return false;
+
+   SCOPED_LOCK(j->lock);
+
+   (void)unit_registry_get(j->registry, name);
+   return mir_get_unit(j->mir, name) != NULL;
+}
+
+static void jit_precompile_cb(void *context, void *arg)
+{
+   jit_func_t *f = arg;
+
+   // Skip straight to the final tier
+   jit_tier_t *tier = f->next_tier;
+   while (tier->next != NULL)
+      tier = tier->next;
+
+   (*tier->plugin.cgen)(f->jit, f->handle, tier->context);
+
+   f->hotness   = 0;
+   f->next_tier = NULL;
+}
+
+void jit_precompile(jit_t *j)
+{
+   if (j->tiers == NULL) {
+      warnf("ahead-of-time compilation requires a native code generator");
+      return;
+   }
+
+   workq_t *wq = workq_new(j);
+
+   // Generating IR for a function registers placeholders for all its
+   // callees so this eventually visits everything reachable from the
+   // functions already known
+   for (jit_handle_t handle = 0; handle < j->next_handle; handle++) {
+      jit_func_t *f = jit_get_func(j, handle);
+
+      switch (load_acquire(&(f->state))) {
+      case JIT_FUNC_PLACEHOLDER:
+         if (f->entry != jit_interp)
+            continue;   // Intrinsic
+         else if (!jit_has_unit(j, f->name))
+            continue;   // Reported if it is ever called
+         break;
+      case JIT_FUNC_ERROR:
+         continue;
+      default:
+         break;
+      }
+
+      if (f->next_tier == NULL)
+         continue;   // Already compiled
+
+      jit_fill_irbuf(f);
+
+      if (f->next_tier == NULL)
+         continue;   // Loaded from cache
+
+      // IR generation is mostly serialised on the unit registry lock
+      // so only run the code generator in parallel
+      workq_do(wq, jit_precompile_cb, f);
+   }
+
+   workq_start(wq);
+   workq_drain(wq);
+   workq_free(wq);
+}
+
 ident_t jit_get_name(jit_t *j, jit_handle_t handle)
 {
    return jit_get_func(j, handle)->name;
@@ -963,6 +1098,7 @@ jit_handle_t jit_assemble(jit_t *j, ident_t name, const char *text)
       { "FDIV",    J_FDIV,       1, 2 },
       { "FNEG",    J_FNEG,       1, 1 },
       { "FCMP",    J_FCMP,       0, 2 },
+      { "FCCMP",   J_FCCMP,      0, 2 },
       { "FCVTNS",  J_FCVTNS,     1, 1 },
       { "SCVTF",   J_SCVTF,      1, 1 },
       { "$EXIT",   MACRO_EXIT,   0, 1 },
@@ -975,6 +1111,7 @@ jit_handle_t jit_assemble(jit_t *j, ident_t name, const char *text)
       { "$MEMSET", MACRO_MEMSET, 1, 2 },
       { "$EXP",    MACRO_EXP,    1, 2 },
       { "$FEXP",   MACRO_FEXP,   1, 2 },
+      { "$SADD",   MACRO_SADD,   0, 2 },
    };
 
    static const struct {
@@ -892,6 +892,17 @@ void __nvc_do_exit(jit_exit_t which, jit_anchor_t *anchor, jit_scalar_t *args,
       }
       break;
 
+   case JIT_EXIT_EDGE_TRIGGER:
+      {
+         sig_shared_t *shared = args[0].pointer;
+         int32_t       offset = args[1].integer;
+         uint64_t      mask   = args[2].integer;
+         void         *inner  = args[3].pointer;
+
+         args[0].pointer = x_edge_trigger(shared, offset, mask, inner);
+      }
+      break;
+
    case JIT_EXIT_ADD_TRIGGER:
       {
          void *trigger = args[0].pointer;
@@ -19,11 +19,13 @@
 #include "array.h"
 #include "common.h"
 #include "diag.h"
+#include "hash.h"
 #include "jit/jit-exits.h"
 #include "jit/jit-ffi.h"
 #include "jit/jit-priv.h"
 #include "printf.h"
 #include "rt/mspace.h"
+#include "thread.h"
 #include "tree.h"
 #include "type.h"
 
@@ -34,19 +36,71 @@
 #include <stdlib.h>
 #include <string.h>
 
+// Number of loop iterations equivalent to one call for tiering
+#define INTERP_BACKEDGE_WEIGHT 64
+
+// Opcodes which only exist in the pre-decoded instruction stream
+typedef enum {
+   I_GOTO = 0xc0,
+   I_JUMP_T,
+   I_JUMP_F,
+   I_CMP_JUMP,
+   I_RANGE_JUMP,
+   I_LOAD_ADD_STORE,
+   I_ADD_CLAMP,
+   I_UNKNOWN,
+} interp_op_t;
+
+// Each operand is decoded to a slot number which is either a register
+// or a constant copied after the registers on function entry
+typedef struct {
+   uint8_t   op;
+   uint8_t   size;
+   uint8_t   cc;
+   uint8_t   cc2;
+   uint8_t   jcc;
+   jit_reg_t result;
+   jit_reg_t result2;
+   unsigned  arg1;
+   unsigned  arg2;
+   unsigned  arg3;
+   unsigned  arg4;
+   int32_t   disp1;
+   int32_t   disp2;
+   unsigned  target;
+   jit_ir_t *ir;
+} interp_insn_t;
+
+struct _jit_icode {
+   unsigned       ninsns;
+   unsigned       nconsts;
+   jit_scalar_t  *consts;
+   interp_insn_t  insns[0];
+};
+
 typedef struct _jit_interp {
-   jit_scalar_t  *args;
-   jit_scalar_t  *regs;
-   unsigned       nargs;
-   unsigned       pc;
-   jit_func_t    *func;
-   unsigned char *frame;
-   unsigned       flags;
-   mspace_t      *mspace;
-   jit_anchor_t  *anchor;
-   tlab_t        *tlab;
+   jit_scalar_t        *args;
+   jit_scalar_t        *regs;
+   unsigned             nargs;
+   const interp_insn_t *insn;
+   jit_func_t          *func;
+   jit_icode_t         *code;
+   unsigned char       *frame;
+   unsigned             flags;
+   mspace_t            *mspace;
+   jit_anchor_t        *anchor;
+   tlab_t              *tlab;
+   unsigned             backedges;
 } jit_interp_t;
 
+typedef struct {
+   jit_func_t   *func;
+   ihash_t      *constmap;
+   jit_scalar_t *consts;
+   unsigned      nconsts;
+   unsigned      maxconsts;
+} interp_decoder_t;
+
 #ifdef DEBUG
 #define JIT_ASSERT(expr) do {                                      \
       if (unlikely(!(expr))) {                                     \
@@ -54,13 +108,8 @@ typedef struct _jit_interp {
          fatal_trace("assertion '%s' failed", #expr);              \
       }                                                            \
    } while (0)
-#define CANNOT_HANDLE(value) do {                                  \
-      interp_dump(state);                                          \
-      fatal_trace("cannot handle value kind %d", value.kind);      \
-   } while (0)
 #else
 #define JIT_ASSERT(expr)
-#define CANNOT_HANDLE(value) __builtin_unreachable()
 #endif
 
 #define FOR_EACH_SIZE(sz, macro) do {                   \
@@ -102,7 +151,8 @@ static void interp_dump_reg(jit_interp_t *state, int64_t ival)
 
 static void interp_dump(jit_interp_t *state)
 {
-   jit_dump_with_mark(state->func, state->pc - 1);
+   const int mark = state->insn ? state->insn->ir - state->func->irbuf : -1;
+   jit_dump_with_mark(state->func, mark);
 
    printf("Arguments:\n");
    for (int i = 0; i < state->nargs; i++) {
@@ -143,425 +193,391 @@ static void interp_dump(jit_interp_t *state)
 }
 
 __attribute__((always_inline))
-static inline int64_t interp_get_int(jit_interp_t *state, jit_value_t value)
+static inline int64_t interp_get_int(jit_interp_t *state, unsigned slot)
 {
-   switch (value.kind) {
-   case JIT_VALUE_REG:
-      JIT_ASSERT(value.reg < state->func->nregs);
-      return state->regs[value.reg].integer;
-   case JIT_VALUE_INT64:
-   case JIT_VALUE_DOUBLE:
-   case JIT_ADDR_ABS:
-      return value.int64;
-   default:
-      CANNOT_HANDLE(value);
-   }
+   JIT_ASSERT(slot < state->func->nregs + state->code->nconsts);
+   return state->regs[slot].integer;
 }
 
 __attribute__((always_inline))
-static inline double interp_get_real(jit_interp_t *state, jit_value_t value)
+static inline double interp_get_real(jit_interp_t *state, unsigned slot)
 {
-   switch (value.kind) {
-   case JIT_VALUE_REG:
-      JIT_ASSERT(value.reg < state->func->nregs);
-      return state->regs[value.reg].real;
-   case JIT_VALUE_INT64:
-   case JIT_VALUE_DOUBLE:
-      return value.dval;
-   default:
-      CANNOT_HANDLE(value);
-   }
+   JIT_ASSERT(slot < state->func->nregs + state->code->nconsts);
+   return state->regs[slot].real;
 }
 
 __attribute__((always_inline))
-static inline void *interp_get_pointer(jit_interp_t *state, jit_value_t value)
+static inline void *interp_get_pointer(jit_interp_t *state, unsigned slot,
+                                       int32_t disp)
 {
-   switch (value.kind) {
-   case JIT_VALUE_REG:
-      JIT_ASSERT(value.reg < state->func->nregs);
-      return state->regs[value.reg].pointer;
-   case JIT_ADDR_CPOOL:
-      JIT_ASSERT(value.int64 >= 0 && value.int64 <= state->func->cpoolsz);
-      return state->func->cpool + value.int64;
-   case JIT_ADDR_REG:
-      JIT_ASSERT(value.reg < state->func->nregs);
-      return state->regs[value.reg].pointer + value.disp;
-   case JIT_ADDR_ABS:
-      return (void *)(intptr_t)value.int64;
-   default:
-      CANNOT_HANDLE(value);
-   }
+   JIT_ASSERT(slot < state->func->nregs + state->code->nconsts);
+   return state->regs[slot].pointer + disp;
 }
 
 __attribute__((always_inline))
 static inline jit_scalar_t interp_get_scalar(jit_interp_t *state,
-                                             jit_value_t value)
+                                             unsigned slot, int32_t disp)
 {
-   switch (value.kind) {
-   case JIT_VALUE_REG:
-      JIT_ASSERT(value.reg < state->func->nregs);
-      return state->regs[value.reg];
-   case JIT_VALUE_INT64:
-      return (jit_scalar_t){ .integer = value.int64 };
-   case JIT_VALUE_DOUBLE:
-      return (jit_scalar_t){ .real = value.dval };
-   case JIT_VALUE_LABEL:
-      return (jit_scalar_t){ .integer = value.label };
-   case JIT_VALUE_HANDLE:
-      return (jit_scalar_t){ .integer = value.handle };
-   case JIT_VALUE_LOCUS:
-      return (jit_scalar_t){ .pointer = value.locus };
-   case JIT_ADDR_CPOOL:
-      JIT_ASSERT(value.int64 >= 0 && value.int64 <= state->func->cpoolsz);
-      return (jit_scalar_t){ .pointer = state->func->cpool + value.int64 };
-   case JIT_ADDR_REG:
-      JIT_ASSERT(value.reg < state->func->nregs);
-      return (jit_scalar_t){
-         .pointer = state->regs[value.reg].pointer + value.disp
-      };
-   case JIT_ADDR_ABS:
-      return (jit_scalar_t){ .pointer = (void *)(intptr_t)value.int64 };
-   default:
-      CANNOT_HANDLE(value);
-   }
+   // The displacement is only non-zero for register-relative addresses
+   JIT_ASSERT(slot < state->func->nregs + state->code->nconsts);
+   return (jit_scalar_t){ .integer = state->regs[slot].integer + disp };
 }
 
-static void interp_recv(jit_interp_t *state, jit_ir_t *ir)
+static void interp_recv(jit_interp_t *state, const interp_insn_t *insn)
 {
-   JIT_ASSERT(ir->arg1.kind == JIT_VALUE_INT64);
-   const int nth = ir->arg1.int64;
+   JIT_ASSERT(insn->ir->arg1.kind == JIT_VALUE_INT64);
+   const int nth = insn->ir->arg1.int64;
 
    JIT_ASSERT(nth < JIT_MAX_ARGS);
-   state->regs[ir->result] = state->args[nth];
+   state->regs[insn->result] = state->args[nth];
    state->nargs = MAX(state->nargs, nth + 1);
 }
 
-static void interp_send(jit_interp_t *state, jit_ir_t *ir)
+static void interp_send(jit_interp_t *state, const interp_insn_t *insn)
 {
-   JIT_ASSERT(ir->arg1.kind == JIT_VALUE_INT64);
-   const int nth = ir->arg1.int64;
+   JIT_ASSERT(insn->ir->arg1.kind == JIT_VALUE_INT64);
+   const int nth = insn->ir->arg1.int64;
 
    JIT_ASSERT(nth < JIT_MAX_ARGS);
-   state->args[nth] = interp_get_scalar(state, ir->arg2);
+   state->args[nth] = interp_get_scalar(state, insn->arg2, insn->disp2);
    state->nargs = MAX(state->nargs, nth + 1);
 }
 
-static void interp_and(jit_interp_t *state, jit_ir_t *ir)
+static void interp_and(jit_interp_t *state, const interp_insn_t *insn)
 {
-   const int64_t arg1 = interp_get_int(state, ir->arg1);
-   const int64_t arg2 = interp_get_int(state, ir->arg2);
+   const int64_t arg1 = interp_get_int(state, insn->arg1);
+   const int64_t arg2 = interp_get_int(state, insn->arg2);
 
-   state->regs[ir->result].integer = arg1 & arg2;
+   state->regs[insn->result].integer = arg1 & arg2;
 }
 
-static void interp_or(jit_interp_t *state, jit_ir_t *ir)
+static void interp_or(jit_interp_t *state, const interp_insn_t *insn)
 {
-   const int64_t arg1 = interp_get_int(state, ir->arg1);
-   const int64_t arg2 = interp_get_int(state, ir->arg2);
+   const int64_t arg1 = interp_get_int(state, insn->arg1);
+   const int64_t arg2 = interp_get_int(state, insn->arg2);
 
-   state->regs[ir->result].integer = arg1 | arg2;
+   state->regs[insn->result].integer = arg1 | arg2;
 }
 
-static void interp_xor(jit_interp_t *state, jit_ir_t *ir)
+static void interp_xor(jit_interp_t *state, const interp_insn_t *insn)
 {
-   const int64_t arg1 = interp_get_int(state, ir->arg1);
-   const int64_t arg2 = interp_get_int(state, ir->arg2);
+   const int64_t arg1 = interp_get_int(state, insn->arg1);
+   const int64_t arg2 = interp_get_int(state, insn->arg2);
 
-   state->regs[ir->result].integer = arg1 ^ arg2;
+   state->regs[insn->result].integer = arg1 ^ arg2;
 }
 
-static void interp_mul(jit_interp_t *state, jit_ir_t *ir)
+static void interp_mul(jit_interp_t *state, const interp_insn_t *insn)
 {
-   const int64_t arg1 = interp_get_int(state, ir->arg1);
-   const int64_t arg2 = interp_get_int(state, ir->arg2);
+   const int64_t arg1 = interp_get_int(state, insn->arg1);
+   const int64_t arg2 = interp_get_int(state, insn->arg2);
 
-   if (ir->cc == JIT_CC_O) {
+   if (insn->cc == JIT_CC_O) {
       int overflow = 0;
 
 #define MUL_OVERFLOW(type) do {                                 \
          type i1 = arg1, i2 = arg2, i0;                         \
          overflow = __builtin_mul_overflow(i1, i2, &i0);        \
-         state->regs[ir->result].integer = i0;                  \
+         state->regs[insn->result].integer = i0;                \
       } while (0)
 
-      FOR_EACH_SIZE(ir->size, MUL_OVERFLOW);
+      FOR_EACH_SIZE(insn->size, MUL_OVERFLOW);
 
       state->flags = overflow;
    }
-   else if (ir->cc == JIT_CC_C) {
+   else if (insn->cc == JIT_CC_C) {
       int overflow = 0;
 
 #define UMUL_OVERFLOW(type) do {                                \
          u##type i1 = arg1, i2 = arg2, i0;                      \
          overflow = __builtin_mul_overflow(i1, i2, &i0);        \
-         state->regs[ir->result].integer = i0;                  \
+         state->regs[insn->result].integer = i0;                \
       } while (0)
 
-      FOR_EACH_SIZE(ir->size, UMUL_OVERFLOW);
+      FOR_EACH_SIZE(insn->size, UMUL_OVERFLOW);
 
       state->flags = overflow;
    }
    else
-      state->regs[ir->result].integer = arg1 * arg2;
+      state->regs[insn->result].integer = arg1 * arg2;
 }
 
-static void interp_fmul(jit_interp_t *state, jit_ir_t *ir)
+static void interp_fmul(jit_interp_t *state, const interp_insn_t *insn)
 {
-   const double arg1 = interp_get_real(state, ir->arg1);
-   const double arg2 = interp_get_real(state, ir->arg2);
+   const double arg1 = interp_get_real(state, insn->arg1);
+   const double arg2 = interp_get_real(state, insn->arg2);
 
-   state->regs[ir->result].real = arg1 * arg2;
+   state->regs[insn->result].real = arg1 * arg2;
 }
 
-static void interp_div(jit_interp_t *state, jit_ir_t *ir)
+static void interp_div(jit_interp_t *state, const interp_insn_t *insn)
 {
-   const int64_t arg1 = interp_get_int(state, ir->arg1);
-   const int64_t arg2 = interp_get_int(state, ir->arg2);
+   const int64_t arg1 = interp_get_int(state, insn->arg1);
+   const int64_t arg2 = interp_get_int(state, insn->arg2);
 
-   state->regs[ir->result].integer = arg1 / arg2;
+   state->regs[insn->result].integer = arg1 / arg2;
 }
 
-static void interp_fdiv(jit_interp_t *state, jit_ir_t *ir)
+static void interp_fdiv(jit_interp_t *state, const interp_insn_t *insn)
 {
-   const double arg1 = interp_get_real(state, ir->arg1);
-   const double arg2 = interp_get_real(state, ir->arg2);
+   const double arg1 = interp_get_real(state, insn->arg1);
+   const double arg2 = interp_get_real(state, insn->arg2);
 
-   state->regs[ir->result].real = arg1 / arg2;
+   state->regs[insn->result].real = arg1 / arg2;
 }
 
-static void interp_sub(jit_interp_t *state, jit_ir_t *ir)
+static void interp_sub(jit_interp_t *state, const interp_insn_t *insn)
 {
-   const int64_t arg1 = interp_get_int(state, ir->arg1);
-   const int64_t arg2 = interp_get_int(state, ir->arg2);
+   const int64_t arg1 = interp_get_int(state, insn->arg1);
+   const int64_t arg2 = interp_get_int(state, insn->arg2);
 
-   if (ir->cc == JIT_CC_O) {
+   if (insn->cc == JIT_CC_O) {
       int overflow = 0;
 
 #define SUB_OVERFLOW(type) do {                                 \
          type i1 = arg1, i2 = arg2, i0;                         \
          overflow = __builtin_sub_overflow(i1, i2, &i0);        \
-         state->regs[ir->result].integer = i0;                  \
+         state->regs[insn->result].integer = i0;                \
       } while (0)
 
-      FOR_EACH_SIZE(ir->size, SUB_OVERFLOW);
+      FOR_EACH_SIZE(insn->size, SUB_OVERFLOW);
 
       state->flags = overflow;
    }
-   else if (ir->cc == JIT_CC_C) {
+   else if (insn->cc == JIT_CC_C) {
       int overflow = 0;
 
 #define USUB_OVERFLOW(type) do {                                \
          u##type i1 = arg1, i2 = arg2, i0;                      \
          overflow = __builtin_sub_overflow(i1, i2, &i0);        \
-         state->regs[ir->result].integer = i0;                  \
+         state->regs[insn->result].integer = i0;                \
       } while (0)
 
-      FOR_EACH_SIZE(ir->size, USUB_OVERFLOW);
+      FOR_EACH_SIZE(insn->size, USUB_OVERFLOW);
 
       state->flags = overflow;
    }
    else
-      state->regs[ir->result].integer = arg1 - arg2;
+      state->regs[insn->result].integer = arg1 - arg2;
 }
 
-static void interp_fsub(jit_interp_t *state, jit_ir_t *ir)
+static void interp_fsub(jit_interp_t *state, const interp_insn_t *insn)
 {
-   const double arg1 = interp_get_real(state, ir->arg1);
-   const double arg2 = interp_get_real(state, ir->arg2);
+   const double arg1 = interp_get_real(state, insn->arg1);
+   const double arg2 = interp_get_real(state, insn->arg2);
 
-   state->regs[ir->result].real = arg1 - arg2;
+   state->regs[insn->result].real = arg1 - arg2;
 }
 
-static void interp_add(jit_interp_t *state, jit_ir_t *ir)
+static void interp_add(jit_interp_t *state, const interp_insn_t *insn)
 {
-   const int64_t arg1 = interp_get_int(state, ir->arg1);
-   const int64_t arg2 = interp_get_int(state, ir->arg2);
+   const int64_t arg1 = interp_get_int(state, insn->arg1);
+   const int64_t arg2 = interp_get_int(state, insn->arg2);
 
-   if (ir->cc == JIT_CC_O) {
+   if (insn->cc == JIT_CC_O) {
       int overflow = 0;
 
 #define ADD_OVERFLOW(type) do {                                 \
          type i1 = arg1, i2 = arg2, i0;                         \
          overflow = __builtin_add_overflow(i1, i2, &i0);        \
-         state->regs[ir->result].integer = i0;                  \
+         state->regs[insn->result].integer = i0;                \
       } while (0)
 
-      FOR_EACH_SIZE(ir->size, ADD_OVERFLOW);
+      FOR_EACH_SIZE(insn->size, ADD_OVERFLOW);
 
       state->flags = overflow;
    }
-   else if (ir->cc == JIT_CC_C) {
+   else if (insn->cc == JIT_CC_C) {
       int overflow = 0;
 
 #define UADD_OVERFLOW(type) do {                                \
          u##type i1 = arg1, i2 = arg2, i0;                      \
          overflow = __builtin_add_overflow(i1, i2, &i0);        \
-         state->regs[ir->result].integer = i0;                  \
+         state->regs[insn->result].integer = i0;                \
       } while (0)
 
-      FOR_EACH_SIZE(ir->size, UADD_OVERFLOW);
+      FOR_EACH_SIZE(insn->size, UADD_OVERFLOW);
 
       state->flags = overflow;
    }
    else
-      state->regs[ir->result].integer = arg1 + arg2;
+      state->regs[insn->result].integer = arg1 + arg2;
 }
 
-static void interp_fadd(jit_interp_t *state, jit_ir_t *ir)
+static void interp_fadd(jit_interp_t *state, const interp_insn_t *insn)
 {
-   const double arg1 = interp_get_real(state, ir->arg1);
-   const double arg2 = interp_get_real(state, ir->arg2);
+   const double arg1 = interp_get_real(state, insn->arg1);
+   const double arg2 = interp_get_real(state, insn->arg2);
 
-   state->regs[ir->result].real = arg1 + arg2;
+   state->regs[insn->result].real = arg1 + arg2;
 }
 
-static void interp_shl(jit_interp_t *state, jit_ir_t *ir)
+static void interp_shl(jit_interp_t *state, const interp_insn_t *insn)
 {
-   const uint64_t arg1 = interp_get_int(state, ir->arg1);
-   const uint64_t arg2 = interp_get_int(state, ir->arg2);
+   const uint64_t arg1 = interp_get_int(state, insn->arg1);
+   const uint64_t arg2 = interp_get_int(state, insn->arg2);
 
-   state->regs[ir->result].integer = arg2 < 64 ? arg1 << arg2 : 0;
+   state->regs[insn->result].integer = arg2 < 64 ? arg1 << arg2 : 0;
 }
 
-static void interp_shr(jit_interp_t *state, jit_ir_t *ir)
+static void interp_shr(jit_interp_t *state, const interp_insn_t *insn)
 {
-   const uint64_t arg1 = interp_get_int(state, ir->arg1);
-   const uint64_t arg2 = interp_get_int(state, ir->arg2);
+   const uint64_t arg1 = interp_get_int(state, insn->arg1);
+   const uint64_t arg2 = interp_get_int(state, insn->arg2);
 
-   state->regs[ir->result].integer = arg2 < 64 ? arg1 >> arg2 : 0;
+   state->regs[insn->result].integer = arg2 < 64 ? arg1 >> arg2 : 0;
 }
 
-static void interp_asr(jit_interp_t *state, jit_ir_t *ir)
+static void interp_asr(jit_interp_t *state, const interp_insn_t *insn)
 {
-   const int64_t arg1 = interp_get_int(state, ir->arg1);
-   const int64_t arg2 = interp_get_int(state, ir->arg2);
+   const int64_t arg1 = interp_get_int(state, insn->arg1);
+   const int64_t arg2 = interp_get_int(state, insn->arg2);
 
    if (arg2 < 64)
-      state->regs[ir->result].integer = arg1 >> arg2;
+      state->regs[insn->result].integer = arg1 >> arg2;
    else
-      state->regs[ir->result].integer = arg1 < 0 ? -1 : 0;
+      state->regs[insn->result].integer = arg1 < 0 ? -1 : 0;
 }
 
-static void interp_store(jit_interp_t *state, jit_ir_t *ir)
+__attribute__((always_inline))
+static inline void interp_store_sized(jit_size_t size, void *ptr,
+                                      int64_t value)
 {
-   jit_scalar_t arg1 = interp_get_scalar(state, ir->arg1);
-   void *arg2 = interp_get_pointer(state, ir->arg2);
-
-   JIT_ASSERT(ir->size != JIT_SZ_UNSPEC);
-   JIT_ASSERT(arg2 != NULL);
-   JIT_ASSERT((intptr_t)arg2 >= 4096);
-
-   switch (ir->size) {
+   switch (size) {
    case JIT_SZ_8:
-      unaligned_store(arg2, arg1.integer, uint8_t);
+      unaligned_store(ptr, value, uint8_t);
       break;
    case JIT_SZ_16:
-      unaligned_store(arg2, arg1.integer, uint16_t);
+      unaligned_store(ptr, value, uint16_t);
       break;
    case JIT_SZ_32:
-      unaligned_store(arg2, arg1.integer, uint32_t);
+      unaligned_store(ptr, value, uint32_t);
       break;
    case JIT_SZ_64:
-      unaligned_store(arg2, arg1.integer, uint64_t);
+      unaligned_store(ptr, value, uint64_t);
       break;
    case JIT_SZ_UNSPEC:
       should_not_reach_here();
    }
 }
 
-static void interp_uload(jit_interp_t *state, jit_ir_t *ir)
+__attribute__((always_inline))
+static inline int64_t interp_load_sized(jit_size_t size, const void *ptr)
 {
-   void *arg1 = interp_get_pointer(state, ir->arg1);
-
-   JIT_ASSERT(ir->size != JIT_SZ_UNSPEC);
-   JIT_ASSERT(arg1 != NULL);
-   JIT_ASSERT((intptr_t)arg1 >= 4096);
-
-   switch (ir->size) {
+   switch (size) {
    case JIT_SZ_8:
-      state->regs[ir->result].integer = *(uint8_t *)arg1;
-      break;
+      return *(int8_t *)ptr;
    case JIT_SZ_16:
-      state->regs[ir->result].integer = *(uint16_t *)arg1;
-      break;
+      return *(int16_t *)ptr;
    case JIT_SZ_32:
-      state->regs[ir->result].integer = *(uint32_t *)arg1;
-      break;
+      return *(int32_t *)ptr;
    case JIT_SZ_64:
-      state->regs[ir->result].integer = *(uint64_t *)arg1;
-      break;
-   case JIT_SZ_UNSPEC:
-      break;
+      return *(int64_t *)ptr;
+   default:
+      return 0;
    }
 }
 
-static void interp_load(jit_interp_t *state, jit_ir_t *ir)
+static void interp_store(jit_interp_t *state, const interp_insn_t *insn)
 {
-   void *arg1 = interp_get_pointer(state, ir->arg1);
+   jit_scalar_t arg1 = interp_get_scalar(state, insn->arg1, insn->disp1);
+   void *arg2 = interp_get_pointer(state, insn->arg2, insn->disp2);
+
+   JIT_ASSERT(insn->size != JIT_SZ_UNSPEC);
+   JIT_ASSERT(arg2 != NULL);
+   JIT_ASSERT((intptr_t)arg2 >= 4096);
+
+   interp_store_sized(insn->size, arg2, arg1.integer);
+}
 
-   JIT_ASSERT(ir->size != JIT_SZ_UNSPEC);
+static void interp_uload(jit_interp_t *state, const interp_insn_t *insn)
+{
+   void *arg1 = interp_get_pointer(state, insn->arg1, insn->disp1);
+
+   JIT_ASSERT(insn->size != JIT_SZ_UNSPEC);
    JIT_ASSERT(arg1 != NULL);
    JIT_ASSERT((intptr_t)arg1 >= 4096);
 
-   switch (ir->size) {
+   switch (insn->size) {
    case JIT_SZ_8:
-      state->regs[ir->result].integer = *(int8_t *)arg1;
+      state->regs[insn->result].integer = *(uint8_t *)arg1;
       break;
    case JIT_SZ_16:
-      state->regs[ir->result].integer = *(int16_t *)arg1;
+      state->regs[insn->result].integer = *(uint16_t *)arg1;
       break;
    case JIT_SZ_32:
-      state->regs[ir->result].integer = *(int32_t *)arg1;
+      state->regs[insn->result].integer = *(uint32_t *)arg1;
       break;
    case JIT_SZ_64:
-      state->regs[ir->result].integer = *(int64_t *)arg1;
+      state->regs[insn->result].integer = *(uint64_t *)arg1;
       break;
    case JIT_SZ_UNSPEC:
       break;
    }
 }
 
-static void interp_cmp(jit_interp_t *state, jit_ir_t *ir)
+static void interp_load(jit_interp_t *state, const interp_insn_t *insn)
 {
-   const int64_t arg1 = interp_get_int(state, ir->arg1);
-   const int64_t arg2 = interp_get_int(state, ir->arg2);
+   void *arg1 = interp_get_pointer(state, insn->arg1, insn->disp1);
+
+   JIT_ASSERT(insn->size != JIT_SZ_UNSPEC);
+   JIT_ASSERT(arg1 != NULL);
+   JIT_ASSERT((intptr_t)arg1 >= 4096);
 
-   switch (ir->cc) {
-   case JIT_CC_EQ: state->flags = (arg1 == arg2); break;
-   case JIT_CC_NE: state->flags = (arg1 != arg2); break;
-   case JIT_CC_LT: state->flags = (arg1 < arg2); break;
-   case JIT_CC_GT: state->flags = (arg1 > arg2); break;
-   case JIT_CC_LE: state->flags = (arg1 <= arg2); break;
-   case JIT_CC_GE: state->flags = (arg1 >= arg2); break;
-   default: state->flags = 0; break;
+   state->regs[insn->result].integer = interp_load_sized(insn->size, arg1);
+}
+
+__attribute__((always_inline))
+static inline int interp_compare(jit_cc_t cc, int64_t arg1, int64_t arg2)
+{
+   switch (cc) {
+   case JIT_CC_EQ: return arg1 == arg2;
+   case JIT_CC_NE: return arg1 != arg2;
+   case JIT_CC_LT: return arg1 < arg2;
+   case JIT_CC_GT: return arg1 > arg2;
+   case JIT_CC_LE: return arg1 <= arg2;
+   case JIT_CC_GE: return arg1 >= arg2;
+   default: return 0;
    }
 }
 
-static void interp_ccmp(jit_interp_t *state, jit_ir_t *ir)
+static void interp_cmp(jit_interp_t *state, const interp_insn_t *insn)
+{
+   const int64_t arg1 = interp_get_int(state, insn->arg1);
+   const int64_t arg2 = interp_get_int(state, insn->arg2);
+
+   state->flags = interp_compare(insn->cc, arg1, arg2);
+}
+
+static void interp_ccmp(jit_interp_t *state, const interp_insn_t *insn)
 {
-   const int64_t arg1 = interp_get_int(state, ir->arg1);
-   const int64_t arg2 = interp_get_int(state, ir->arg2);
+   const int64_t arg1 = interp_get_int(state, insn->arg1);
+   const int64_t arg2 = interp_get_int(state, insn->arg2);
 
-   switch (ir->cc) {
-   case JIT_CC_EQ: state->flags &= (arg1 == arg2); break;
-   case JIT_CC_NE: state->flags &= (arg1 != arg2); break;
-   case JIT_CC_LT: state->flags &= (arg1 < arg2); break;
-   case JIT_CC_GT: state->flags &= (arg1 > arg2); break;
-   case JIT_CC_LE: state->flags &= (arg1 <= arg2); break;
-   case JIT_CC_GE: state->flags &= (arg1 >= arg2); break;
-   default: state->flags = 0; break;
+   switch (insn->cc) {
+   case JIT_CC_EQ:
+   case JIT_CC_NE:
+   case JIT_CC_LT:
+   case JIT_CC_GT:
+   case JIT_CC_LE:
+   case JIT_CC_GE:
+      state->flags &= interp_compare(insn->cc, arg1, arg2);
+      break;
+   default:
+      state->flags = 0;
+      break;
    }
 }
 
-static void interp_fcmp(jit_interp_t *state, jit_ir_t *ir)
+static void interp_fcmp(jit_interp_t *state, const interp_insn_t *insn)
 {
-   const double arg1 = interp_get_real(state, ir->arg1);
-   const double arg2 = interp_get_real(state, ir->arg2);
+   const double arg1 = interp_get_real(state, insn->arg1);
+   const double arg2 = interp_get_real(state, insn->arg2);
 
    if (isnan(arg1) || isnan(arg2))
       state->flags = 0;
    else {
-      switch (ir->cc) {
+      switch (insn->cc) {
       case JIT_CC_EQ: state->flags = (arg1 == arg2); break;
       case JIT_CC_NE: state->flags = (arg1 != arg2); break;
       case JIT_CC_LT: state->flags = (arg1 < arg2); break;
@@ -573,15 +589,15 @@ static void interp_fcmp(jit_interp_t *state, jit_ir_t *ir)
    }
 }
 
-static void interp_fccmp(jit_interp_t *state, jit_ir_t *ir)
+static void interp_fccmp(jit_interp_t *state, const interp_insn_t *insn)
 {
-   const double arg1 = interp_get_real(state, ir->arg1);
-   const double arg2 = interp_get_real(state, ir->arg2);
+   const double arg1 = interp_get_real(state, insn->arg1);
+   const double arg2 = interp_get_real(state, insn->arg2);
 
    if (isnan(arg1) || isnan(arg2))
       state->flags = 0;
    else {
-      switch (ir->cc) {
+      switch (insn->cc) {
       case JIT_CC_EQ: state->flags &= (arg1 == arg2); break;
       case JIT_CC_NE: state->flags &= (arg1 != arg2); break;
       case JIT_CC_LT: state->flags &= (arg1 < arg2); break;
@@ -593,61 +609,36 @@ static void interp_fccmp(jit_interp_t *state, jit_ir_t *ir)
    }
 }
 
-static void interp_rem(jit_interp_t *state, jit_ir_t *ir)
+static void interp_rem(jit_interp_t *state, const interp_insn_t *insn)
 {
-   const int64_t x = interp_get_int(state, ir->arg1);
-   const int64_t y = interp_get_int(state, ir->arg2);
+   const int64_t x = interp_get_int(state, insn->arg1);
+   const int64_t y = interp_get_int(state, insn->arg2);
 
-   state->regs[ir->result].integer = x - (x / y) * y;
+   state->regs[insn->result].integer = x - (x / y) * y;
 }
 
-static void interp_clamp(jit_interp_t *state, jit_ir_t *ir)
+static void interp_clamp(jit_interp_t *state, const interp_insn_t *insn)
 {
-   const int64_t value = interp_get_int(state, ir->arg1);
+   const int64_t value = interp_get_int(state, insn->arg1);
 
-   state->regs[ir->result].integer = value < 0 ? 0 : value;
+   state->regs[insn->result].integer = value < 0 ? 0 : value;
 }
 
-static void interp_cset(jit_interp_t *state, jit_ir_t *ir)
+static void interp_cset(jit_interp_t *state, const interp_insn_t *insn)
 {
-   state->regs[ir->result].integer = !!(state->flags);
+   state->regs[insn->result].integer = !!(state->flags);
 }
 
-static void interp_branch_to(jit_interp_t *state, jit_value_t label)
-{
-   JIT_ASSERT(label.kind == JIT_VALUE_LABEL);
-   state->pc = label.label;
-   JIT_ASSERT(state->pc < state->func->nirs);
-}
-
-static void interp_jump(jit_interp_t *state, jit_ir_t *ir)
-{
-   switch (ir->cc) {
-   case JIT_CC_NONE:
-      interp_branch_to(state, ir->arg1);
-      break;
-   case JIT_CC_T:
-      if (state->flags)
-         interp_branch_to(state, ir->arg1);
-      break;
-   case JIT_CC_F:
-      if (!state->flags)
-         interp_branch_to(state, ir->arg1);
-      break;
-   default:
-      interp_dump(state);
-      fatal_trace("unhandled jump condition code");
-   }
-}
-
-static void interp_trap(jit_interp_t *state, jit_ir_t *ir)
+static void interp_trap(jit_interp_t *state, const interp_insn_t *insn)
 {
+   state->insn = insn;
    interp_dump(state);
    fatal_trace("executed trap opcode");
 }
 
-static void interp_call(jit_interp_t *state, jit_ir_t *ir)
+static void interp_call(jit_interp_t *state, const interp_insn_t *insn)
 {
+   jit_ir_t *ir = insn->ir;
    JIT_ASSERT(ir->arg1.kind == JIT_VALUE_HANDLE);
 
    state->anchor->irpos = ir - state->func->irbuf;
@@ -663,64 +654,66 @@ static void interp_call(jit_interp_t *state, jit_ir_t *ir)
    }
 }
 
-static void interp_mov(jit_interp_t *state, jit_ir_t *ir)
+static void interp_mov(jit_interp_t *state, const interp_insn_t *insn)
 {
-   state->regs[ir->result] = interp_get_scalar(state, ir->arg1);
+   state->regs[insn->result] =
+      interp_get_scalar(state, insn->arg1, insn->disp1);
 }
 
-static void interp_csel(jit_interp_t *state, jit_ir_t *ir)
+static void interp_csel(jit_interp_t *state, const interp_insn_t *insn)
 {
    if (state->flags)
-      state->regs[ir->result].integer = interp_get_int(state, ir->arg1);
+      state->regs[insn->result].integer = interp_get_int(state, insn->arg1);
    else
-      state->regs[ir->result].integer = interp_get_int(state, ir->arg2);
+      state->regs[insn->result].integer = interp_get_int(state, insn->arg2);
 }
 
-static void interp_neg(jit_interp_t *state, jit_ir_t *ir)
+static void interp_neg(jit_interp_t *state, const interp_insn_t *insn)
 {
-   state->regs[ir->result].integer = -interp_get_int(state, ir->arg1);
+   state->regs[insn->result].integer = -interp_get_int(state, insn->arg1);
 }
 
-static void interp_fneg(jit_interp_t *state, jit_ir_t *ir)
+static void interp_fneg(jit_interp_t *state, const interp_insn_t *insn)
 {
-   state->regs[ir->result].real = -interp_get_real(state, ir->arg1);
+   state->regs[insn->result].real = -interp_get_real(state, insn->arg1);
 }
 
-static void interp_not(jit_interp_t *state, jit_ir_t *ir)
+static void interp_not(jit_interp_t *state, const interp_insn_t *insn)
 {
-   state->regs[ir->result].integer = !interp_get_int(state, ir->arg1);
+   state->regs[insn->result].integer = !interp_get_int(state, insn->arg1);
 }
 
-static void interp_scvtf(jit_interp_t *state, jit_ir_t *ir)
+static void interp_scvtf(jit_interp_t *state, const interp_insn_t *insn)
 {
-   state->regs[ir->result].real = interp_get_int(state, ir->arg1);
+   state->regs[insn->result].real = interp_get_int(state, insn->arg1);
 }
 
-static void interp_fcvtns(jit_interp_t *state, jit_ir_t *ir)
+static void interp_fcvtns(jit_interp_t *state, const interp_insn_t *insn)
 {
-   const double f = interp_get_real(state, ir->arg1);
-   state->regs[ir->result].integer = (int64_t)(f + copysign(0.5, f));
+   const double f = interp_get_real(state, insn->arg1);
+   state->regs[insn->result].integer = (int64_t)(f + copysign(0.5, f));
 }
 
-static void interp_lea(jit_interp_t *state, jit_ir_t *ir)
+static void interp_lea(jit_interp_t *state, const interp_insn_t *insn)
 {
-   state->regs[ir->result].pointer = interp_get_pointer(state, ir->arg1);
+   state->regs[insn->result].pointer =
+      interp_get_pointer(state, insn->arg1, insn->disp1);
 }
 
-static void interp_fexp(jit_interp_t *state, jit_ir_t *ir)
+static void interp_fexp(jit_interp_t *state, const interp_insn_t *insn)
 {
-   const double x = interp_get_real(state, ir->arg1);
-   const double y = interp_get_real(state, ir->arg2);
+   const double x = interp_get_real(state, insn->arg1);
+   const double y = interp_get_real(state, insn->arg2);
 
-   state->regs[ir->result].real = pow(x, y);
+   state->regs[insn->result].real = pow(x, y);
 }
 
-static void interp_exp(jit_interp_t *state, jit_ir_t *ir)
+static void interp_exp(jit_interp_t *state, const interp_insn_t *insn)
 {
-   const int64_t x = interp_get_int(state, ir->arg1);
-   const int64_t y = interp_get_int(state, ir->arg2);
+   const int64_t x = interp_get_int(state, insn->arg1);
+   const int64_t y = interp_get_int(state, insn->arg2);
 
-   if (ir->cc == JIT_CC_O) {
+   if (insn->cc == JIT_CC_O) {
       int overflow = 0, xo = 0;
 
 #define EXP_OVERFLOW(type) do {                                         \
@@ -731,14 +724,14 @@ static void interp_exp(jit_interp_t *state, jit_ir_t *ir)
             yt >>= 1;                                                   \
             xo |= __builtin_mul_overflow(xt, xt, &xt);                  \
          }                                                              \
-         state->regs[ir->result].integer = r;                           \
+         state->regs[insn->result].integer = r;                         \
       } while (0)
 
-      FOR_EACH_SIZE(ir->size, EXP_OVERFLOW);
+      FOR_EACH_SIZE(insn->size, EXP_OVERFLOW);
 
       state->flags = overflow;
    }
-   else if (ir->cc == JIT_CC_C) {
+   else if (insn->cc == JIT_CC_C) {
       int overflow = 0, xo = 0;
 
 #define UEXP_OVERFLOW(type) do {                                        \
@@ -749,22 +742,22 @@ static void interp_exp(jit_interp_t *state, jit_ir_t *ir)
             yt >>= 1;                                                   \
             xo |= __builtin_mul_overflow(xt, xt, &xt);                  \
          }                                                              \
-         state->regs[ir->result].integer = r;                           \
+         state->regs[insn->result].integer = r;                         \
       } while (0)
 
-      FOR_EACH_SIZE(ir->size, UEXP_OVERFLOW);
+      FOR_EACH_SIZE(insn->size, UEXP_OVERFLOW);
 
       state->flags = overflow;
    }
    else
-      state->regs[ir->result].integer = ipow(x, y);
+      state->regs[insn->result].integer = ipow(x, y);
 }
 
-static void interp_copy(jit_interp_t *state, jit_ir_t *ir)
+static void interp_copy(jit_interp_t *state, const interp_insn_t *insn)
 {
-   const size_t count = state->regs[ir->result].integer;
-   void *dest = interp_get_pointer(state, ir->arg1);
-   const void *src = interp_get_pointer(state, ir->arg2);
+   const size_t count = state->regs[insn->result].integer;
+   void *dest = interp_get_pointer(state, insn->arg1, insn->disp1);
+   const void *src = interp_get_pointer(state, insn->arg2, insn->disp2);
 
    JIT_ASSERT((uintptr_t)dest >= 4096 || count == 0);
    JIT_ASSERT((uintptr_t)src >= 4096 || count == 0);
@@ -773,11 +766,11 @@ static void interp_copy(jit_interp_t *state, jit_ir_t *ir)
    memcpy(dest, src, count);
 }
 
-static void interp_move(jit_interp_t *state, jit_ir_t *ir)
+static void interp_move(jit_interp_t *state, const interp_insn_t *insn)
 {
-   const size_t count = state->regs[ir->result].integer;
-   void *dest = interp_get_pointer(state, ir->arg1);
-   const void *src = interp_get_pointer(state, ir->arg2);
+   const size_t count = state->regs[insn->result].integer;
+   void *dest = interp_get_pointer(state, insn->arg1, insn->disp1);
+   const void *src = interp_get_pointer(state, insn->arg2, insn->disp2);
 
    JIT_ASSERT((uintptr_t)dest >= 4096 || count == 0);
    JIT_ASSERT((uintptr_t)src >= 4096 || count == 0);
@@ -785,19 +778,19 @@ static void interp_move(jit_interp_t *state, jit_ir_t *ir)
    memmove(dest, src, count);
 }
 
-static void interp_bzero(jit_interp_t *state, jit_ir_t *ir)
+static void interp_bzero(jit_interp_t *state, const interp_insn_t *insn)
 {
-   const size_t count = state->regs[ir->result].integer;
-   void *dest = interp_get_pointer(state, ir->arg1);
+   const size_t count = state->regs[insn->result].integer;
+   void *dest = interp_get_pointer(state, insn->arg1, insn->disp1);
 
    memset(dest, '\0', count);
 }
 
-static void interp_memset(jit_interp_t *state, jit_ir_t *ir)
+static void interp_memset(jit_interp_t *state, const interp_insn_t *insn)
 {
-   const size_t bytes = state->regs[ir->result].integer;
-   void *dest = interp_get_pointer(state, ir->arg1);
-   const uint64_t value = interp_get_int(state, ir->arg2);
+   const size_t bytes = state->regs[insn->result].integer;
+   void *dest = interp_get_pointer(state, insn->arg1, insn->disp1);
+   const uint64_t value = interp_get_int(state, insn->arg2);
 
    JIT_ASSERT(dest != NULL);
 
@@ -808,17 +801,17 @@ static void interp_memset(jit_interp_t *state, jit_ir_t *ir)
          *p = value;                                \
    } while (0)
 
-   FOR_EACH_SIZE(ir->size, MEMSET_LOOP);
+   FOR_EACH_SIZE(insn->size, MEMSET_LOOP);
 }
 
-static void interp_galloc(jit_interp_t *state, jit_ir_t *ir)
+static void interp_galloc(jit_interp_t *state, const interp_insn_t *insn)
 {
    jit_thread_local_t *thread = jit_thread_local();
    thread->anchor = state->anchor;
 
-   state->anchor->irpos = ir - state->func->irbuf;
+   state->anchor->irpos = insn->ir - state->func->irbuf;
 
-   uint64_t bytes = interp_get_int(state, ir->arg1);
+   uint64_t bytes = interp_get_int(state, insn->arg1);
 
    if (bytes > UINT32_MAX)
       jit_msg(NULL, DIAG_FATAL, "attempting to allocate %"PRIu64" byte object "
@@ -827,77 +820,100 @@ static void interp_galloc(jit_interp_t *state, jit_ir_t *ir)
    else if (bytes == 0)
       bytes = 1;   // Never return a NULL pointer
 
-   state->regs[ir->result].pointer = mspace_alloc(state->mspace, bytes);
+   state->regs[insn->result].pointer = mspace_alloc(state->mspace, bytes);
 
    thread->anchor = NULL;
 }
 
-static void interp_lalloc(jit_interp_t *state, jit_ir_t *ir)
+static void interp_lalloc(jit_interp_t *state, const interp_insn_t *insn)
 {
    jit_thread_local_t *thread = jit_thread_local();
    thread->anchor = state->anchor;
 
-   state->anchor->irpos = ir - state->func->irbuf;
+   state->anchor->irpos = insn->ir - state->func->irbuf;
 
-   const size_t bytes = interp_get_int(state, ir->arg1);
-   state->regs[ir->result].pointer = tlab_alloc(state->tlab, bytes);
+   const size_t bytes = interp_get_int(state, insn->arg1);
+   state->regs[insn->result].pointer = tlab_alloc(state->tlab, bytes);
 
    thread->anchor = NULL;
 }
 
-static void interp_salloc(jit_interp_t *state, jit_ir_t *ir)
+static void interp_salloc(jit_interp_t *state, const interp_insn_t *insn)
 {
+   jit_ir_t *ir = insn->ir;
    assert(ir->arg1.int64 + ir->arg2.int64 <= state->func->framesz);
-   state->regs[ir->result].pointer = state->frame + ir->arg1.int64;
+   state->regs[insn->result].pointer = state->frame + ir->arg1.int64;
 }
 
-static void interp_exit(jit_interp_t *state, jit_ir_t *ir)
+static void interp_exit(jit_interp_t *state, const interp_insn_t *insn)
 {
-   state->anchor->irpos = ir - state->func->irbuf;
-   __nvc_do_exit(ir->arg1.exit, state->anchor, state->args, state->tlab);
+   state->anchor->irpos = insn->ir - state->func->irbuf;
+   __nvc_do_exit(insn->ir->arg1.exit, state->anchor, state->args,
+                 state->tlab);
 }
 
-static void interp_getpriv(jit_interp_t *state, jit_ir_t *ir)
+static void interp_getpriv(jit_interp_t *state, const interp_insn_t *insn)
 {
-   JIT_ASSERT(ir->arg1.kind == JIT_VALUE_HANDLE);
-   jit_func_t *f = jit_get_func(state->func->jit, ir->arg1.handle);
+   JIT_ASSERT(insn->ir->arg1.kind == JIT_VALUE_HANDLE);
+   jit_func_t *f = jit_get_func(state->func->jit, insn->ir->arg1.handle);
    void *ptr = load_acquire(jit_get_privdata_ptr(state->func->jit, f));
-   state->regs[ir->result].pointer = ptr;
+   state->regs[insn->result].pointer = ptr;
 }
 
-static void interp_putpriv(jit_interp_t *state, jit_ir_t *ir)
+static void interp_putpriv(jit_interp_t *state, const interp_insn_t *insn)
 {
-   JIT_ASSERT(ir->arg1.kind == JIT_VALUE_HANDLE);
-   jit_func_t *f = jit_get_func(state->func->jit, ir->arg1.handle);
-   void *ptr = interp_get_pointer(state, ir->arg2);
+   JIT_ASSERT(insn->ir->arg1.kind == JIT_VALUE_HANDLE);
+   jit_func_t *f = jit_get_func(state->func->jit, insn->ir->arg1.handle);
+   void *ptr = interp_get_pointer(state, insn->arg2, insn->disp2);
    store_release(jit_get_privdata_ptr(state->func->jit, f), ptr);
 }
 
-static void interp_case(jit_interp_t *state, jit_ir_t *ir)
-{
-   jit_scalar_t test = state->regs[ir->result];
-   const int64_t cmp = interp_get_int(state, ir->arg1);
-
-   if (test.integer == cmp)
-      interp_branch_to(state, ir->arg2);
-}
-
-static void interp_trim(jit_interp_t *state, jit_ir_t *ir)
+static void interp_trim(jit_interp_t *state, const interp_insn_t *insn)
 {
    assert(state->tlab->alloc >= state->anchor->watermark);
    state->tlab->alloc = state->anchor->watermark;
 }
 
-static void interp_reexec(jit_interp_t *state, jit_ir_t *ir)
+static void interp_reexec(jit_interp_t *state, const interp_insn_t *insn)
 {
    jit_entry_fn_t entry = load_acquire(&state->func->entry);
    (*entry)(state->func, state->anchor->caller, state->args, state->tlab);
 }
 
-static void interp_sadd(jit_interp_t *state, jit_ir_t *ir)
+__attribute__((noinline))
+static bool interp_back_edge(jit_interp_t *state, const interp_insn_t *dest)
 {
-   const void *ptr = interp_get_pointer(state, ir->arg1);
-   const int64_t addend = interp_get_int(state, ir->arg2);
+   // Loop iterations count towards the same threshold as calls but
+   // with a lower weight, so a function that is entered once and then
+   // loops for a long time still gets compiled
+   state->backedges = INTERP_BACKEDGE_WEIGHT;
+
+   jit_func_t *f = state->func;
+   relaxed_store(&f->heat, f->heat + 1);
+
+   if (f->next_tier && --(f->hotness) <= 0)
+      jit_tier_up(f);
+
+   jit_entry_fn_t osr = load_acquire(&f->osr_entry);
+   if (osr == NULL)
+      return false;
+
+   // Transfer the rest of this activation to compiled code entering at
+   // the loop header: the argument array is free at a back edge so is
+   // used to pass the register file
+   state->args[0].pointer = state->regs;
+   state->args[1].integer = dest->ir - f->irbuf;
+   state->args[2].integer = state->flags;
+   state->args[3].integer = state->anchor->watermark;
+
+   (*osr)(f, state->anchor->caller, state->args, state->tlab);
+   return true;
+}
+
+static void interp_sadd(jit_interp_t *state, const interp_insn_t *insn)
+{
+   const void *ptr = interp_get_pointer(state, insn->arg1, insn->disp1);
+   const int64_t addend = interp_get_int(state, insn->arg2);
 
    JIT_ASSERT(ptr != NULL);
    JIT_ASSERT((intptr_t)ptr >= 4096);
@@ -907,213 +923,568 @@ static void interp_sadd(jit_interp_t *state, jit_ir_t *ir)
       *(u##type *)ptr = saturate_add(cur, addend);              \
    } while (0)
 
-   FOR_EACH_SIZE(ir->size, SADD);
+   FOR_EACH_SIZE(insn->size, SADD);
 }
 
-static void interp_pack(jit_interp_t *state, jit_ir_t *ir)
+static void interp_pack(jit_interp_t *state, const interp_insn_t *insn)
 {
-   const uint8_t *src = interp_get_pointer(state, ir->arg1);
-   const int size = interp_get_int(state, ir->arg2);
+   const uint8_t *src = interp_get_pointer(state, insn->arg1, insn->disp1);
+   const int size = interp_get_int(state, insn->arg2);
    __nvc_pack(src, size, state->args);
 }
 
-static void interp_unpack(jit_interp_t *state, jit_ir_t *ir)
+static void interp_unpack(jit_interp_t *state, const interp_insn_t *insn)
 {
-   jit_scalar_t aval = interp_get_scalar(state, ir->arg1);
-   jit_scalar_t bval = interp_get_scalar(state, ir->arg2);
+   jit_scalar_t aval = interp_get_scalar(state, insn->arg1, insn->disp1);
+   jit_scalar_t bval = interp_get_scalar(state, insn->arg2, insn->disp2);
    __nvc_unpack(aval, bval, state->args);
 }
 
-static void interp_vec4op(jit_interp_t *state, jit_ir_t *ir)
+static void interp_vec4op(jit_interp_t *state, const interp_insn_t *insn)
 {
+   jit_ir_t *ir = insn->ir;
    state->anchor->irpos = ir - state->func->irbuf;
    __nvc_vec4op(ir->arg1.int64, state->anchor, state->args, ir->arg2.int64);
 }
 
+static void interp_load_add_store(jit_interp_t *state,
+                                  const interp_insn_t *insn)
+{
+   void *ptr = interp_get_pointer(state, insn->arg1, insn->disp1);
+
+   JIT_ASSERT(ptr != NULL);
+   JIT_ASSERT((intptr_t)ptr >= 4096);
+
+   state->regs[insn->result].integer = interp_load_sized(insn->size, ptr);
+
+   const int64_t sum = state->regs[insn->result].integer
+      + interp_get_int(state, insn->arg2);
+   state->regs[insn->result2].integer = sum;
+
+   interp_store_sized(insn->size, ptr, sum);
+}
+
+static void interp_add_clamp(jit_interp_t *state, const interp_insn_t *insn)
+{
+   const int64_t sum =
+      interp_get_int(state, insn->arg1) + interp_get_int(state, insn->arg2);
+
+   state->regs[insn->result].integer = sum;
+   state->regs[insn->result2].integer = sum < 0 ? 0 : sum;
+}
+
+static void interp_unknown(jit_interp_t *state, const interp_insn_t *insn)
+{
+   state->insn = insn;
+   interp_dump(state);
+   fatal_trace("cannot interpret opcode %s", jit_op_name(insn->ir->op));
+}
+
+static void interp_bad_jump(jit_interp_t *state, const interp_insn_t *insn)
+{
+   state->insn = insn;
+   interp_dump(state);
+   fatal_trace("unhandled jump condition code");
+}
+
 static void interp_loop(jit_interp_t *state)
 {
-   for (;;) {
-      JIT_ASSERT(state->pc < state->func->nirs);
-      jit_ir_t *ir = &(state->func->irbuf[state->pc++]);
+   static const void *const dispatch[256] = {
+      [J_RECV] = &&op_recv,
+      [J_SEND] = &&op_send,
+      [J_AND] = &&op_and,
+      [J_OR] = &&op_or,
+      [J_XOR] = &&op_xor,
+      [J_SUB] = &&op_sub,
+      [J_FSUB] = &&op_fsub,
+      [J_ADD] = &&op_add,
+      [J_FADD] = &&op_fadd,
+      [J_MUL] = &&op_mul,
+      [J_FMUL] = &&op_fmul,
+      [J_DIV] = &&op_div,
+      [J_FDIV] = &&op_fdiv,
+      [J_SHL] = &&op_shl,
+      [J_SHR] = &&op_shr,
+      [J_ASR] = &&op_asr,
+      [J_RET] = &&op_ret,
+      [J_STORE] = &&op_store,
+      [J_ULOAD] = &&op_uload,
+      [J_LOAD] = &&op_load,
+      [J_CMP] = &&op_cmp,
+      [J_CCMP] = &&op_ccmp,
+      [J_FCMP] = &&op_fcmp,
+      [J_FCCMP] = &&op_fccmp,
+      [J_CSET] = &&op_cset,
+      [J_JUMP] = &&op_jump,
+      [J_TRAP] = &&op_trap,
+      [J_CALL] = &&op_call,
+      [J_MOV] = &&op_mov,
+      [J_CSEL] = &&op_csel,
+      [J_NEG] = &&op_neg,
+      [J_FNEG] = &&op_fneg,
+      [J_NOT] = &&op_not,
+      [J_SCVTF] = &&op_scvtf,
+      [J_FCVTNS] = &&op_fcvtns,
+      [J_LEA] = &&op_lea,
+      [J_REM] = &&op_rem,
+      [J_CLAMP] = &&op_clamp,
+      [MACRO_COPY] = &&op_copy,
+      [MACRO_MOVE] = &&op_move,
+      [MACRO_BZERO] = &&op_bzero,
+      [MACRO_MEMSET] = &&op_memset,
+      [MACRO_GALLOC] = &&op_galloc,
+      [MACRO_LALLOC] = &&op_lalloc,
+      [MACRO_SALLOC] = &&op_salloc,
+      [MACRO_EXIT] = &&op_exit,
+      [MACRO_FEXP] = &&op_fexp,
+      [MACRO_EXP] = &&op_exp,
+      [MACRO_GETPRIV] = &&op_getpriv,
+      [MACRO_PUTPRIV] = &&op_putpriv,
+      [MACRO_CASE] = &&op_case,
+      [MACRO_TRIM] = &&op_trim,
+      [MACRO_REEXEC] = &&op_reexec,
+      [MACRO_SADD] = &&op_sadd,
+      [MACRO_PACK] = &&op_pack,
+      [MACRO_UNPACK] = &&op_unpack,
+      [MACRO_VEC4OP] = &&op_vec4op,
+      [I_GOTO] = &&op_goto,
+      [I_JUMP_T] = &&op_jump_t,
+      [I_JUMP_F] = &&op_jump_f,
+      [I_CMP_JUMP] = &&op_cmp_jump,
+      [I_RANGE_JUMP] = &&op_range_jump,
+      [I_LOAD_ADD_STORE] = &&op_load_add_store,
+      [I_ADD_CLAMP] = &&op_add_clamp,
+      [I_UNKNOWN] = &&op_unknown,
+   };
+
+   const interp_insn_t *const base = state->code->insns;
+   const interp_insn_t *insn = base;
+
+#ifdef DEBUG
+#define DISPATCH() do {                                         \
+      JIT_ASSERT(insn < base + state->code->ninsns);            \
+      state->insn = insn;                                       \
+      goto *dispatch[insn->op];                                 \
+   } while (0)
+#else
+#define DISPATCH() goto *dispatch[insn->op]
+#endif
+#define NEXT() do { insn++; DISPATCH(); } while (0)
+#define BRANCH(to) do {                                         \
+      const interp_insn_t *dest = base + (to);                  \
+      if (dest <= insn && unlikely(--state->backedges == 0)) {  \
+         if (interp_back_edge(state, dest))                     \
+            return;                                             \
+      }                                                         \
+      insn = dest;                                              \
+      DISPATCH();                                               \
+   } while (0)
+#define SIMPLE_OP(name)                         \
+   op_##name:                                   \
+      interp_##name(state, insn);               \
+      NEXT();
+
+   DISPATCH();
+
+   SIMPLE_OP(recv);
+   SIMPLE_OP(send);
+   SIMPLE_OP(and);
+   SIMPLE_OP(or);
+   SIMPLE_OP(xor);
+   SIMPLE_OP(sub);
+   SIMPLE_OP(fsub);
+   SIMPLE_OP(add);
+   SIMPLE_OP(fadd);
+   SIMPLE_OP(mul);
+   SIMPLE_OP(fmul);
+   SIMPLE_OP(div);
+   SIMPLE_OP(fdiv);
+   SIMPLE_OP(shl);
+   SIMPLE_OP(shr);
+   SIMPLE_OP(asr);
+   SIMPLE_OP(store);
+   SIMPLE_OP(uload);
+   SIMPLE_OP(load);
+   SIMPLE_OP(cmp);
+   SIMPLE_OP(ccmp);
+   SIMPLE_OP(fcmp);
+   SIMPLE_OP(fccmp);
+   SIMPLE_OP(cset);
+   SIMPLE_OP(trap);
+   SIMPLE_OP(call);
+   SIMPLE_OP(mov);
+   SIMPLE_OP(csel);
+   SIMPLE_OP(neg);
+   SIMPLE_OP(fneg);
+   SIMPLE_OP(not);
+   SIMPLE_OP(scvtf);
+   SIMPLE_OP(fcvtns);
+   SIMPLE_OP(lea);
+   SIMPLE_OP(rem);
+   SIMPLE_OP(clamp);
+   SIMPLE_OP(copy);
+   SIMPLE_OP(move);
+   SIMPLE_OP(bzero);
+   SIMPLE_OP(memset);
+   SIMPLE_OP(galloc);
+   SIMPLE_OP(lalloc);
+   SIMPLE_OP(salloc);
+   SIMPLE_OP(exit);
+   SIMPLE_OP(fexp);
+   SIMPLE_OP(exp);
+   SIMPLE_OP(getpriv);
+   SIMPLE_OP(putpriv);
+   SIMPLE_OP(trim);
+   SIMPLE_OP(sadd);
+   SIMPLE_OP(pack);
+   SIMPLE_OP(unpack);
+   SIMPLE_OP(vec4op);
+   SIMPLE_OP(load_add_store);
+   SIMPLE_OP(add_clamp);
+   SIMPLE_OP(unknown);
+
+ op_ret:
+   return;
+
+ op_reexec:
+   interp_reexec(state, insn);
+   return;
+
+ op_jump:
+   interp_bad_jump(state, insn);
+   return;
+
+ op_goto:
+   BRANCH(insn->target);
+
+ op_jump_t:
+   if (state->flags)
+      BRANCH(insn->target);
+   else
+      NEXT();
+
+ op_jump_f:
+   if (state->flags)
+      NEXT();
+   else
+      BRANCH(insn->target);
+
+ op_case:
+   if (state->regs[insn->result].integer == interp_get_int(state, insn->arg1))
+      BRANCH(insn->target);
+   else
+      NEXT();
+
+ op_cmp_jump:
+   {
+      const int64_t arg1 = interp_get_int(state, insn->arg1);
+      const int64_t arg2 = interp_get_int(state, insn->arg2);
+
+      state->flags = interp_compare(insn->cc, arg1, arg2);
+
+      if (state->flags == (insn->jcc == JIT_CC_T))
+         BRANCH(insn->target);
+      else
+         NEXT();
+   }
+
+ op_range_jump:
+   {
+      const int64_t arg1 = interp_get_int(state, insn->arg1);
+      const int64_t arg2 = interp_get_int(state, insn->arg2);
+      const int64_t arg3 = interp_get_int(state, insn->arg3);
+      const int64_t arg4 = interp_get_int(state, insn->arg4);
+
+      state->flags = interp_compare(insn->cc, arg1, arg2)
+         && interp_compare(insn->cc2, arg3, arg4);
+
+      if (state->flags == (insn->jcc == JIT_CC_T))
+         BRANCH(insn->target);
+      else
+         NEXT();
+   }
+
+#undef SIMPLE_OP
+#undef BRANCH
+#undef NEXT
+#undef DISPATCH
+}
+
+static unsigned interp_decode_const(interp_decoder_t *d, jit_scalar_t value)
+{
+   void *map = ihash_get(d->constmap, value.integer);
+   if (map != NULL)
+      return d->func->nregs + (uintptr_t)map - 1;
+
+   if (d->nconsts == d->maxconsts) {
+      d->maxconsts = MAX(16, d->maxconsts * 2);
+      d->consts = xrealloc_array(d->consts, d->maxconsts,
+                                 sizeof(jit_scalar_t));
+   }
+
+   const unsigned index = d->nconsts++;
+   d->consts[index] = value;
+   ihash_put(d->constmap, value.integer, (void *)(uintptr_t)(index + 1));
+
+   return d->func->nregs + index;
+}
+
+static unsigned interp_decode_value(interp_decoder_t *d, jit_value_t value,
+                                    int32_t *disp)
+{
+   *disp = 0;
+
+   switch (value.kind) {
+   case JIT_VALUE_REG:
+      return value.reg;
+   case JIT_ADDR_REG:
+      *disp = value.disp;
+      return value.reg;
+   case JIT_VALUE_INT64:
+   case JIT_VALUE_DOUBLE:
+   case JIT_ADDR_ABS:
+      return interp_decode_const(d, (jit_scalar_t){ .integer = value.int64 });
+   case JIT_ADDR_CPOOL:
+      {
+         void *ptr = d->func->cpool + value.int64;
+         return interp_decode_const(d, (jit_scalar_t){ .pointer = ptr });
+      }
+   case JIT_VALUE_LABEL:
+      return interp_decode_const(d, (jit_scalar_t){ .integer = value.label });
+   case JIT_VALUE_HANDLE:
+      return interp_decode_const(d, (jit_scalar_t){ .integer = value.handle });
+   case JIT_VALUE_LOCUS:
+      return interp_decode_const(d, (jit_scalar_t){ .pointer = value.locus });
+   default:
+      // Only used directly from the IR by the instruction handler
+      return interp_decode_const(d, (jit_scalar_t){ .integer = 0 });
+   }
+}
+
+static void interp_decode_args(interp_decoder_t *d, interp_insn_t *insn,
+                               jit_ir_t *ir)
+{
+   insn->op     = ir->op;
+   insn->size   = ir->size;
+   insn->cc     = ir->cc;
+   insn->result = ir->result;
+   insn->ir     = ir;
+   insn->arg1   = interp_decode_value(d, ir->arg1, &insn->disp1);
+   insn->arg2   = interp_decode_value(d, ir->arg2, &insn->disp2);
+}
+
+static bool interp_same_address(jit_value_t a, jit_value_t b)
+{
+   if (a.kind != b.kind)
+      return false;
+
+   switch (a.kind) {
+   case JIT_ADDR_REG:
+      return a.reg == b.reg && a.disp == b.disp;
+   case JIT_ADDR_ABS:
+   case JIT_ADDR_CPOOL:
+      return a.int64 == b.int64;
+   default:
+      return false;
+   }
+}
+
+static bool interp_is_reg(jit_value_t value, jit_reg_t reg)
+{
+   return value.kind == JIT_VALUE_REG && value.reg == reg;
+}
+
+static bool interp_is_cond_jump(jit_ir_t *ir)
+{
+   return ir->op == J_JUMP && (ir->cc == JIT_CC_T || ir->cc == JIT_CC_F);
+}
+
+static int interp_fuse(interp_decoder_t *d, interp_insn_t *insn,
+                       jit_ir_t *ir, int remain)
+{
+   // Instructions after the first cannot be fused if they are the
+   // target of a branch
+   int limit = 1;
+   while (limit < remain && limit < 3 && !ir[limit].target)
+      limit++;
+
+   switch (ir[0].op) {
+   case J_CMP:
+      if (limit >= 3 && ir[1].op == J_CCMP && interp_is_cond_jump(&ir[2])) {
+         // Bounds check
+         int32_t disp;
+         interp_decode_args(d, insn, &ir[0]);
+         insn->op     = I_RANGE_JUMP;
+         insn->cc2    = ir[1].cc;
+         insn->jcc    = ir[2].cc;
+         insn->arg3   = interp_decode_value(d, ir[1].arg1, &disp);
+         insn->arg4   = interp_decode_value(d, ir[1].arg2, &disp);
+         insn->target = ir[2].arg1.label;
+         return 3;
+      }
+      else if (limit >= 2 && interp_is_cond_jump(&ir[1])) {
+         interp_decode_args(d, insn, &ir[0]);
+         insn->op     = I_CMP_JUMP;
+         insn->jcc    = ir[1].cc;
+         insn->target = ir[1].arg1.label;
+         return 2;
+      }
+      break;
+
+   case J_LOAD:
+      if (limit >= 3 && ir[1].op == J_ADD && ir[1].cc == JIT_CC_NONE
+          && ir[2].op == J_STORE && ir[2].size == ir[0].size
+          && interp_same_address(ir[0].arg1, ir[2].arg2)
+          && interp_is_reg(ir[2].arg1, ir[1].result)) {
+         const jit_reg_t loaded = ir[0].result;
+         if (ir[0].arg1.kind == JIT_ADDR_REG
+             && (ir[0].arg1.reg == loaded || ir[0].arg1.reg == ir[1].result))
+            break;
+
+         jit_value_t addend;
+         if (interp_is_reg(ir[1].arg1, loaded))
+            addend = ir[1].arg2;
+         else if (interp_is_reg(ir[1].arg2, loaded))
+            addend = ir[1].arg1;
+         else
+            break;
+
+         int32_t disp;
+         interp_decode_args(d, insn, &ir[0]);
+         insn->op      = I_LOAD_ADD_STORE;
+         insn->result2 = ir[1].result;
+         insn->arg2    = interp_decode_value(d, addend, &disp);
+         return 3;
+      }
+      break;
+
+   case J_ADD:
+      if (limit >= 2 && ir[0].cc == JIT_CC_NONE && ir[1].op == J_CLAMP
+          && interp_is_reg(ir[1].arg1, ir[0].result)) {
+         // Array length calculation
+         interp_decode_args(d, insn, &ir[0]);
+         insn->op      = I_ADD_CLAMP;
+         insn->result2 = ir[1].result;
+         return 2;
+      }
+      break;
+
+   default:
+      break;
+   }
+
+   return 0;
+}
+
+static jit_icode_t *interp_decode(jit_func_t *f)
+{
+   interp_decoder_t d = {
+      .func     = f,
+      .constmap = ihash_new(64),
+   };
+
+   interp_insn_t *insns LOCAL = xmalloc_array(f->nirs, sizeof(interp_insn_t));
+   unsigned *map LOCAL = xmalloc_array(f->nirs + 1, sizeof(unsigned));
+
+   unsigned ninsns = 0;
+   for (int i = 0; i < f->nirs;) {
+      jit_ir_t *ir = &(f->irbuf[i]);
+      map[i] = ninsns;
+
+      if (ir->op == J_NOP || ir->op == J_DEBUG) {
+         i++;
+         continue;
+      }
+
+      interp_insn_t *insn = &(insns[ninsns++]);
+      memset(insn, '\0', sizeof(interp_insn_t));
+
+      const int nfused = interp_fuse(&d, insn, ir, f->nirs - i);
+      if (nfused > 0) {
+         for (int j = 1; j < nfused; j++)
+            map[i + j] = ninsns - 1;
+         i += nfused;
+         continue;
+      }
+
+      interp_decode_args(&d, insn, ir);
+
       switch (ir->op) {
-      case J_RECV:
-         interp_recv(state, ir);
-         break;
-      case J_SEND:
-         interp_send(state, ir);
-         break;
-      case J_AND:
-         interp_and(state, ir);
-         break;
-      case J_OR:
-         interp_or(state, ir);
-         break;
-      case J_XOR:
-         interp_xor(state, ir);
-         break;
-      case J_SUB:
-         interp_sub(state, ir);
-         break;
-      case J_FSUB:
-         interp_fsub(state, ir);
-         break;
-      case J_ADD:
-         interp_add(state, ir);
-         break;
-      case J_FADD:
-         interp_fadd(state, ir);
-         break;
-      case J_MUL:
-         interp_mul(state, ir);
-         break;
-      case J_FMUL:
-         interp_fmul(state, ir);
-         break;
-      case J_DIV:
-         interp_div(state, ir);
-         break;
-      case J_FDIV:
-         interp_fdiv(state, ir);
-         break;
-      case J_SHL:
-         interp_shl(state, ir);
-         break;
-      case J_SHR:
-         interp_shr(state, ir);
-         break;
-      case J_ASR:
-         interp_asr(state, ir);
-         break;
-      case J_RET:
-         return;
-      case J_STORE:
-         interp_store(state, ir);
-         break;
-      case J_ULOAD:
-         interp_uload(state, ir);
-         break;
-      case J_LOAD:
-         interp_load(state, ir);
-         break;
-      case J_CMP:
-         interp_cmp(state, ir);
-         break;
-      case J_CCMP:
-         interp_ccmp(state, ir);
-         break;
-      case J_FCMP:
-         interp_fcmp(state, ir);
-         break;
-      case J_FCCMP:
-         interp_fccmp(state, ir);
-         break;
-      case J_CSET:
-         interp_cset(state, ir);
-         break;
       case J_JUMP:
-         interp_jump(state, ir);
-         break;
-      case J_TRAP:
-         interp_trap(state, ir);
-         break;
-      case J_CALL:
-         interp_call(state, ir);
-         break;
-      case J_MOV:
-         interp_mov(state, ir);
-         break;
-      case J_CSEL:
-         interp_csel(state, ir);
-         break;
-      case J_NEG:
-         interp_neg(state, ir);
-         break;
-      case J_FNEG:
-         interp_fneg(state, ir);
-         break;
-      case J_NOT:
-         interp_not(state, ir);
-         break;
-      case J_SCVTF:
-         interp_scvtf(state, ir);
-         break;
-      case J_FCVTNS:
-         interp_fcvtns(state, ir);
-         break;
-      case J_LEA:
-         interp_lea(state, ir);
-         break;
-      case J_REM:
-         interp_rem(state, ir);
-         break;
-      case J_CLAMP:
-         interp_clamp(state, ir);
-         break;
-      case J_DEBUG:
-      case J_NOP:
-         break;
-      case MACRO_COPY:
-         interp_copy(state, ir);
-         break;
-      case MACRO_MOVE:
-         interp_move(state, ir);
-         break;
-      case MACRO_BZERO:
-         interp_bzero(state, ir);
-         break;
-      case MACRO_MEMSET:
-         interp_memset(state, ir);
-         break;
-      case MACRO_GALLOC:
-         interp_galloc(state, ir);
-         break;
-      case MACRO_LALLOC:
-         interp_lalloc(state, ir);
-         break;
-      case MACRO_SALLOC:
-         interp_salloc(state, ir);
-         break;
-      case MACRO_EXIT:
-         interp_exit(state, ir);
-         break;
-      case MACRO_FEXP:
-         interp_fexp(state, ir);
-         break;
-      case MACRO_EXP:
-         interp_exp(state, ir);
-         break;
-      case MACRO_GETPRIV:
-         interp_getpriv(state, ir);
-         break;
-      case MACRO_PUTPRIV:
-         interp_putpriv(state, ir);
+         insn->target = ir->arg1.label;
+         if (ir->cc == JIT_CC_NONE)
+            insn->op = I_GOTO;
+         else if (ir->cc == JIT_CC_T)
+            insn->op = I_JUMP_T;
+         else if (ir->cc == JIT_CC_F)
+            insn->op = I_JUMP_F;
          break;
       case MACRO_CASE:
-         interp_case(state, ir);
-         break;
-      case MACRO_TRIM:
-         interp_trim(state, ir);
-         break;
-      case MACRO_REEXEC:
-         interp_reexec(state, ir);
-         return;
-      case MACRO_SADD:
-         interp_sadd(state, ir);
+         insn->target = ir->arg2.label;
          break;
-      case MACRO_PACK:
-         interp_pack(state, ir);
+      case J_RECV: case J_SEND: case J_AND: case J_OR: case J_XOR:
+      case J_SUB: case J_FSUB: case J_ADD: case J_FADD: case J_MUL:
+      case J_FMUL: case J_DIV: case J_FDIV: case J_SHL: case J_SHR:
+      case J_ASR: case J_RET: case J_STORE: case J_ULOAD: case J_LOAD:
+      case J_CMP: case J_CCMP: case J_FCMP: case J_FCCMP: case J_CSET:
+      case J_TRAP: case J_CALL: case J_MOV: case J_CSEL: case J_NEG:
+      case J_FNEG: case J_NOT: case J_SCVTF: case J_FCVTNS: case J_LEA:
+      case J_REM: case J_CLAMP: case MACRO_COPY: case MACRO_MOVE:
+      case MACRO_BZERO: case MACRO_MEMSET: case MACRO_GALLOC:
+      case MACRO_LALLOC: case MACRO_SALLOC: case MACRO_EXIT:
+      case MACRO_FEXP: case MACRO_EXP: case MACRO_GETPRIV:
+      case MACRO_PUTPRIV: case MACRO_TRIM: case MACRO_REEXEC:
+      case MACRO_SADD: case MACRO_PACK: case MACRO_UNPACK:
+      case MACRO_VEC4OP:
          break;
-      case MACRO_UNPACK:
-         interp_unpack(state, ir);
+      default:
+         insn->op = I_UNKNOWN;
          break;
-      case MACRO_VEC4OP:
-         interp_vec4op(state, ir);
+      }
+
+      i++;
+   }
+
+   map[f->nirs] = ninsns;
+
+   // Resolve branch targets to offsets in the compacted stream
+   for (int i = 0; i < ninsns; i++) {
+      switch (insns[i].op) {
+      case I_GOTO:
+      case I_JUMP_T:
+      case I_JUMP_F:
+      case I_CMP_JUMP:
+      case I_RANGE_JUMP:
+      case MACRO_CASE:
+         assert(insns[i].target < f->nirs);
+         insns[i].target = map[insns[i].target];
          break;
       default:
-         interp_dump(state);
-         fatal_trace("cannot interpret opcode %s", jit_op_name(ir->op));
+         break;
       }
    }
+
+   const size_t insnsz = ninsns * sizeof(interp_insn_t);
+   const size_t constsz = d.nconsts * sizeof(jit_scalar_t);
+
+   jit_icode_t *code = xmalloc(sizeof(jit_icode_t) + insnsz + constsz);
+   code->ninsns  = ninsns;
+   code->nconsts = d.nconsts;
+   code->consts  = (jit_scalar_t *)((char *)code->insns + insnsz);
+
+   memcpy(code->insns, insns, insnsz);
+   memcpy(code->consts, d.consts, constsz);
+
+   free(d.consts);
+   ihash_free(d.constmap);
+
+   if (!atomic_cas(&f->icode, NULL, code)) {
+      // Another thread decoded this function concurrently
+      free(code);
+      return load_acquire(&f->icode);
+   }
+
+   return code;
 }
 
 void jit_interp(jit_func_t *f, jit_anchor_t *caller, jit_scalar_t *args,
@@ -1128,9 +1499,15 @@ void jit_interp(jit_func_t *f, jit_anchor_t *caller, jit_scalar_t *args,
 
    jit_fill_irbuf(f);
 
+   relaxed_store(&f->heat, f->heat + 1);
+
    if (f->next_tier && --(f->hotness) <= 0)
       jit_tier_up(f);
 
+   jit_icode_t *code = load_acquire(&f->icode);
+   if (unlikely(code == NULL))
+      code = interp_decode(f);
+
    jit_anchor_t anchor = {
       .caller    = caller,
       .func      = f,
@@ -1139,7 +1516,7 @@ void jit_interp(jit_func_t *f, jit_anchor_t *caller, jit_scalar_t *args,
 
    // Using VLAs here as we need these allocated on the stack so the
    // mspace GC can scan them
-   jit_scalar_t regs[f->nregs + 1];
+   jit_scalar_t regs[f->nregs + code->nconsts + 1];
    unsigned char frame[f->framesz + 1];
 
 #ifdef DEBUG
@@ -1147,16 +1524,20 @@ void jit_interp(jit_func_t *f, jit_anchor_t *caller, jit_scalar_t *args,
    memset(frame, 0xde, f->framesz);
 #endif
 
+   // Constant operands are read from slots following the registers
+   memcpy(regs + f->nregs, code->consts, code->nconsts * sizeof(jit_scalar_t));
+
    jit_interp_t state = {
-      .args     = args,
-      .regs     = regs,
-      .nargs    = 0,
-      .pc       = 0,
-      .func     = f,
-      .frame    = frame,
-      .mspace   = jit_get_mspace(f->jit),
-      .anchor   = &anchor,
-      .tlab     = tlab,
+      .args      = args,
+      .regs      = regs,
+      .nargs     = 0,
+      .func      = f,
+      .code      = code,
+      .frame     = frame,
+      .mspace    = jit_get_mspace(f->jit),
+      .anchor    = &anchor,
+      .tlab      = tlab,
+      .backedges = INTERP_BACKEDGE_WEIGHT,
    };
 
    interp_loop(&state);
@@ -32,7 +32,7 @@
 #define HAVE_NEON
 #endif
 
-#if defined HAVE_AVX2 || defined HAVE_SSE41
+#if defined HAVE_AVX512BW || defined HAVE_AVX2 || defined HAVE_SSE41
 #include <x86intrin.h>
 #endif
 
@@ -45,9 +45,10 @@
 #endif
 
 typedef enum {
-   CPU_AVX2  = 0x1,
-   CPU_SSE41 = 0x2,
-   CPU_NEON  = 0x04,
+   CPU_AVX2     = 0x1,
+   CPU_SSE41    = 0x2,
+   CPU_NEON     = 0x04,
+   CPU_AVX512BW = 0x08,
 } cpu_feature_t;
 
 typedef struct {
@@ -125,7 +126,7 @@ static const uint8_t or_table[16][16] = {
    {    _U, _X, _X, _1, _X, _X, _X, _1, _X   },  // | - |
 };
 
-#if defined HAVE_SSE41
+#if defined HAVE_SSE41 || defined HAVE_AVX2 || defined HAVE_AVX512BW
 static const uint8_t not_table[1][16] = {
    // ---------------------------------------------------
    // |  U   X   0   1   Z   W   L   H   -          |   |
@@ -133,7 +134,8 @@ static const uint8_t not_table[1][16] = {
 };
 #endif
 
-#if defined HAVE_SSE41 || defined HAVE_NEON
+#if defined HAVE_SSE41 || defined HAVE_AVX2 || defined HAVE_AVX512BW \
+   || defined HAVE_NEON
 
 // Compressed lookup tables for vectorised intrinsics.  Note the
 // vectorised intrinsics all rely on being able to read up to
@@ -1652,6 +1654,322 @@ static void ieee_not_vector_sse41(jit_func_t *func, jit_anchor_t *anchor,
 }
 #endif
 
+// Generate the "and", "or", and "xor" entry points for an instruction
+// set from its __std_logic_op_<isa> helper: only the lookup table, the
+// operator name in the error message, and the result allocation differ
+#define STD_LOGIC_BINOP(op, isa, feature, alloc, align)               \
+   __attribute__((target(feature)))                                   \
+   static void ieee_##op##_vector_##isa(jit_func_t *func,             \
+                                        jit_anchor_t *anchor,         \
+                                        jit_scalar_t *args,           \
+                                        tlab_t *tlab)                 \
+   {                                                                  \
+      const int lsize = ffi_array_length(args[3].integer);            \
+      const int rsize = ffi_array_length(args[6].integer);            \
+      uint8_t *left = args[1].pointer;                                \
+      uint8_t *right = args[4].pointer;                               \
+                                                                      \
+      if (unlikely(lsize != rsize))                                   \
+         __ieee_msg(func, anchor, SEVERITY_FAILURE,                   \
+                    "STD_LOGIC_1164.\"" #op "\": arguments of "       \
+                    "overloaded '" #op "' operator are not of the "   \
+                    "same length");                                   \
+      else {                                                          \
+         uint8_t *result = __tlab_alloc(tlab, (alloc), (align));      \
+         __std_logic_op_##isa(left, right, lsize, small_##op##_table, \
+                              result);                                \
+                                                                      \
+         args[0].pointer = result;                                    \
+         args[1].integer = 1;                                         \
+         args[2].integer = lsize;                                     \
+      }                                                               \
+   }
+
+#ifdef HAVE_AVX2
+// The AVX2 byte shuffle only indexes within each 128-bit lane so the
+// 16-entry lookup tables are duplicated into both halves
+
+__attribute__((target("avx2"), always_inline))
+static inline __m256i __load_table_avx2(const void *table)
+{
+   return _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i *)table));
+}
+
+__attribute__((target("avx2"), always_inline))
+static inline void __std_logic_op_avx2(const uint8_t *left,
+                                       const uint8_t *right, int size,
+                                       const void *table, uint8_t *result)
+{
+   const __m256i left_tbl  = __load_table_avx2(compress_left);
+   const __m256i right_tbl = __load_table_avx2(compress_right);
+   const __m256i op_tbl    = __load_table_avx2(table);
+
+   for (int pos = 0; pos < size; pos += 32) {
+      __m256i left1  = _mm256_loadu_si256((const __m256i *)(left + pos));
+      __m256i right1 = _mm256_loadu_si256((const __m256i *)(right + pos));
+      __m256i left2  = _mm256_shuffle_epi8(left_tbl, left1);
+      __m256i right2 = _mm256_shuffle_epi8(right_tbl, right1);
+      __m256i comb   = _mm256_or_si256(left2, right2);
+      __m256i out    = _mm256_shuffle_epi8(op_tbl, comb);
+      _mm256_storeu_si256((__m256i *)(result + pos), out);
+   }
+}
+
+__attribute__((target("avx2")))
+static void std_to_x01_avx2(jit_func_t *func, jit_anchor_t *anchor,
+                            jit_scalar_t *args, tlab_t *tlab)
+{
+   const int size = args[3].integer ^ (args[3].integer >> 63);
+   const uint8_t *input = args[1].pointer;
+
+   uint8_t *result = __tlab_alloc(tlab, ALIGN_UP(size, 32), 32);
+
+   const __m256i lookup = __load_table_avx2(cvt_to_x01);
+
+   for (int pos = 0; pos < size; pos += 32) {
+      __m256i in = _mm256_loadu_si256((const __m256i *)(input + pos));
+      __m256i out = _mm256_shuffle_epi8(lookup, in);
+      _mm256_storeu_si256((__m256i *)(result + pos), out);
+   }
+
+   args[0].pointer = result;
+   args[1].integer = size - 1;
+   args[2].integer = ~size;
+}
+
+STD_LOGIC_BINOP(and, avx2, "avx2", ALIGN_UP(lsize, 32), 32)
+STD_LOGIC_BINOP(or, avx2, "avx2", ALIGN_UP(lsize, 32), 32)
+STD_LOGIC_BINOP(xor, avx2, "avx2", ALIGN_UP(lsize, 32), 32)
+
+__attribute__((target("avx2")))
+static void ieee_not_vector_avx2(jit_func_t *func, jit_anchor_t *anchor,
+                                 jit_scalar_t *args, tlab_t *tlab)
+{
+   const int lsize = ffi_array_length(args[3].integer);
+   uint8_t *left = args[1].pointer;
+
+   uint8_t *result = __tlab_alloc(tlab, ALIGN_UP(lsize, 32), 32);
+
+   const __m256i not_tbl = __load_table_avx2(not_table);
+
+   for (int pos = 0; pos < lsize; pos += 32) {
+      __m256i input  = _mm256_loadu_si256((const __m256i *)(left + pos));
+      __m256i output = _mm256_shuffle_epi8(not_tbl, input);
+      _mm256_storeu_si256((__m256i *)(result + pos), output);
+   }
+
+   args[0].pointer = result;
+   args[1].integer = 1;
+   args[2].integer = lsize;
+}
+#endif
+
+#ifdef HAVE_AVX512BW
+// AVX-512 has masked loads and stores so these do not rely on reading
+// or writing past the end of the arrays
+
+__attribute__((target("avx512bw"), always_inline))
+static inline __m512i __load_table_avx512(const void *table)
+{
+   return _mm512_broadcast_i32x4(_mm_load_si128((const __m128i *)table));
+}
+
+__attribute__((always_inline))
+static inline __mmask64 __tail_mask_avx512(int remain)
+{
+   return remain >= 64 ? ~UINT64_C(0) : (UINT64_C(1) << remain) - 1;
+}
+
+__attribute__((target("avx512bw"), always_inline))
+static inline void __std_logic_op_avx512(const uint8_t *left,
+                                         const uint8_t *right, int size,
+                                         const void *table, uint8_t *result)
+{
+   const __m512i left_tbl  = __load_table_avx512(compress_left);
+   const __m512i right_tbl = __load_table_avx512(compress_right);
+   const __m512i op_tbl    = __load_table_avx512(table);
+
+   for (int pos = 0; pos < size; pos += 64) {
+      const __mmask64 mask = __tail_mask_avx512(size - pos);
+      __m512i left1  = _mm512_maskz_loadu_epi8(mask, left + pos);
+      __m512i right1 = _mm512_maskz_loadu_epi8(mask, right + pos);
+      __m512i left2  = _mm512_shuffle_epi8(left_tbl, left1);
+      __m512i right2 = _mm512_shuffle_epi8(right_tbl, right1);
+      __m512i comb   = _mm512_or_si512(left2, right2);
+      __m512i out    = _mm512_shuffle_epi8(op_tbl, comb);
+      _mm512_mask_storeu_epi8(result + pos, mask, out);
+   }
+}
+
+__attribute__((target("avx512bw")))
+static void std_to_x01_avx512(jit_func_t *func, jit_anchor_t *anchor,
+                              jit_scalar_t *args, tlab_t *tlab)
+{
+   const int size = args[3].integer ^ (args[3].integer >> 63);
+   const uint8_t *input = args[1].pointer;
+
+   uint8_t *result = __tlab_alloc(tlab, size, 8);
+
+   const __m512i lookup = __load_table_avx512(cvt_to_x01);
+
+   for (int pos = 0; pos < size; pos += 64) {
+      const __mmask64 mask = __tail_mask_avx512(size - pos);
+      __m512i in = _mm512_maskz_loadu_epi8(mask, input + pos);
+      __m512i out = _mm512_shuffle_epi8(lookup, in);
+      _mm512_mask_storeu_epi8(result + pos, mask, out);
+   }
+
+   args[0].pointer = result;
+   args[1].integer = size - 1;
+   args[2].integer = ~size;
+}
+
+STD_LOGIC_BINOP(and, avx512, "avx512bw", lsize, 8)
+STD_LOGIC_BINOP(or, avx512, "avx512bw", lsize, 8)
+STD_LOGIC_BINOP(xor, avx512, "avx512bw", lsize, 8)
+
+__attribute__((target("avx512bw")))
+static void ieee_not_vector_avx512(jit_func_t *func, jit_anchor_t *anchor,
+                                   jit_scalar_t *args, tlab_t *tlab)
+{
+   const int lsize = ffi_array_length(args[3].integer);
+   uint8_t *left = args[1].pointer;
+
+   uint8_t *result = __tlab_alloc(tlab, lsize, 8);
+
+   const __m512i not_tbl = __load_table_avx512(not_table);
+
+   for (int pos = 0; pos < lsize; pos += 64) {
+      const __mmask64 mask = __tail_mask_avx512(lsize - pos);
+      __m512i input  = _mm512_maskz_loadu_epi8(mask, left + pos);
+      __m512i output = _mm512_shuffle_epi8(not_tbl, input);
+      _mm512_mask_storeu_epi8(result + pos, mask, output);
+   }
+
+   args[0].pointer = result;
+   args[1].integer = 1;
+   args[2].integer = lsize;
+}
+#endif
+
+#undef STD_LOGIC_BINOP
+
+__attribute__((always_inline))
+static inline void __pack_planes(const uint8_t *vec, int count,
+                                 uint64_t *value, uint64_t *unknown)
+{
+   // Pack up to 64 elements into two bit planes with the first element
+   // in the most significant bit: VALUE holds the low bit of each
+   // element and UNKNOWN is set for anything other than '0' or '1'
+   assert(count <= 64);
+
+   uint64_t vbits = 0, ubits = 0;
+   int pos = 0;
+   for (; pos + 8 <= count; pos += 8) {
+      const uint64_t word = unaligned_load(vec + pos, uint64_t);
+      const uint64_t notbin = (word & UINT64_C(0x0e0e0e0e0e0e0e0e))
+         ^ UINT64_C(0x0202020202020202);
+      const uint64_t flags = ((notbin + UINT64_C(0x7f7f7f7f7f7f7f7f))
+                              & UINT64_C(0x8080808080808080)) >> 7;
+
+      vbits = (vbits << 8) | __pack_low_bits(&word);
+      ubits = (ubits << 8) | ((flags * UINT64_C(0x8040201008040201)) >> 56);
+   }
+
+   for (; pos < count; pos++) {
+      vbits = (vbits << 1) | (vec[pos] & 1);
+      ubits = (ubits << 1) | !IS_01(vec[pos]);
+   }
+
+   *value = vbits;
+   *unknown = ubits;
+}
+
+static uint8_t __reduce_vector(const uint8_t *vec, int size,
+                               const uint8_t table[16][16], uint8_t init)
+{
+   // Most vectors only contain '0' and '1' in which case the result
+   // can be computed 64 elements at a time from the packed value bits
+   int ones = 0;
+   for (int pos = 0; pos < size; pos += 64) {
+      uint64_t value, unknown;
+      __pack_planes(vec + pos, MIN(size - pos, 64), &value, &unknown);
+
+      if (unknown != 0)
+         goto slow_path;
+
+      ones += __builtin_popcountll(value);
+   }
+
+   if (table == and_table)
+      return ones == size ? _1 : _0;
+   else if (table == or_table)
+      return ones > 0 ? _1 : _0;
+   else
+      return (ones & 1) ? _1 : _0;
+
+ slow_path:
+   {
+      uint8_t result = init;
+      for (int i = size - 1; i >= 0; i--)
+         result = table[vec[i]][result];
+      return result;
+   }
+}
+
+static inline uint8_t __not_logic(uint8_t value)
+{
+   return value == _0 ? _1 : (value == _1 ? _0 : value);
+}
+
+static void ieee_and_reduce(jit_func_t *func, jit_anchor_t *anchor,
+                            jit_scalar_t *args, tlab_t *tlab)
+{
+   const int size = ffi_array_length(args[3].integer);
+   args[0].integer = __reduce_vector(args[1].pointer, size, and_table, _1);
+}
+
+static void ieee_nand_reduce(jit_func_t *func, jit_anchor_t *anchor,
+                             jit_scalar_t *args, tlab_t *tlab)
+{
+   const int size = ffi_array_length(args[3].integer);
+   const uint8_t result = __reduce_vector(args[1].pointer, size,
+                                          and_table, _1);
+   args[0].integer = __not_logic(result);
+}
+
+static void ieee_or_reduce(jit_func_t *func, jit_anchor_t *anchor,
+                           jit_scalar_t *args, tlab_t *tlab)
+{
+   const int size = ffi_array_length(args[3].integer);
+   args[0].integer = __reduce_vector(args[1].pointer, size, or_table, _0);
+}
+
+static void ieee_nor_reduce(jit_func_t *func, jit_anchor_t *anchor,
+                            jit_scalar_t *args, tlab_t *tlab)
+{
+   const int size = ffi_array_length(args[3].integer);
+   const uint8_t result = __reduce_vector(args[1].pointer, size,
+                                          or_table, _0);
+   args[0].integer = __not_logic(result);
+}
+
+static void ieee_xor_reduce(jit_func_t *func, jit_anchor_t *anchor,
+                            jit_scalar_t *args, tlab_t *tlab)
+{
+   const int size = ffi_array_length(args[3].integer);
+   args[0].integer = __reduce_vector(args[1].pointer, size, xor_table, _0);
+}
+
+static void ieee_xnor_reduce(jit_func_t *func, jit_anchor_t *anchor,
+                             jit_scalar_t *args, tlab_t *tlab)
+{
+   const int size = ffi_array_length(args[3].integer);
+   const uint8_t result = __reduce_vector(args[1].pointer, size,
+                                          xor_table, _0);
+   args[0].integer = __not_logic(result);
+}
+
 static void ieee_to_unsigned(jit_func_t *func, jit_anchor_t *anchor,
                              jit_scalar_t *args, tlab_t *tlab)
 {
@@ -2034,6 +2352,70 @@ static void byte_vector_equal_sse41(jit_func_t *func, jit_anchor_t *anchor,
 }
 #endif
 
+#ifdef HAVE_AVX2
+__attribute__((target("avx2")))
+static void byte_vector_equal_avx2(jit_func_t *func, jit_anchor_t *anchor,
+                                   jit_scalar_t *args, tlab_t *tlab)
+{
+   const int lsize = ffi_array_length(args[2].integer);
+   const int rsize = ffi_array_length(args[5].integer);
+   uint8_t *left = args[0].pointer;
+   uint8_t *right = args[3].pointer;
+
+   args[0].integer = 0;
+
+   if (lsize != rsize)
+      return;
+
+   int pos = 0;
+   for (; pos + 31 < lsize; pos += 32) {
+      __m256i left1  = _mm256_loadu_si256((const __m256i *)(left + pos));
+      __m256i right1 = _mm256_loadu_si256((const __m256i *)(right + pos));
+      __m256i eq     = _mm256_cmpeq_epi8(left1, right1);
+      if ((uint32_t)_mm256_movemask_epi8(eq) != UINT32_MAX)
+         return;
+   }
+
+   if (pos < lsize) {
+      const uint32_t mask = (UINT32_C(1) << (lsize - pos)) - 1;
+      __m256i left1  = _mm256_loadu_si256((const __m256i *)(left + pos));
+      __m256i right1 = _mm256_loadu_si256((const __m256i *)(right + pos));
+      __m256i eq     = _mm256_cmpeq_epi8(left1, right1);
+      if ((~(uint32_t)_mm256_movemask_epi8(eq) & mask) != 0)
+         return;
+   }
+
+   args[0].integer = 1;
+}
+#endif
+
+#ifdef HAVE_AVX512BW
+__attribute__((target("avx512bw")))
+static void byte_vector_equal_avx512(jit_func_t *func, jit_anchor_t *anchor,
+                                     jit_scalar_t *args, tlab_t *tlab)
+{
+   const int lsize = ffi_array_length(args[2].integer);
+   const int rsize = ffi_array_length(args[5].integer);
+   uint8_t *left = args[0].pointer;
+   uint8_t *right = args[3].pointer;
+
+   args[0].integer = 0;
+
+   if (lsize != rsize)
+      return;
+
+   for (int pos = 0; pos < lsize; pos += 64) {
+      const __mmask64 mask = __tail_mask_avx512(lsize - pos);
+      __m512i left1  = _mm512_maskz_loadu_epi8(mask, left + pos);
+      __m512i right1 = _mm512_maskz_loadu_epi8(mask, right + pos);
+      if (_mm512_cmpneq_epi8_mask(left1, right1) != 0)
+         return;
+   }
+
+   args[0].integer = 1;
+}
+#endif
+
 #ifdef HAVE_NEON
 static void byte_vector_equal_neon(jit_func_t *func, jit_anchor_t *anchor,
                                    jit_scalar_t *args, tlab_t *tlab)
@@ -2230,6 +2612,14 @@ static jit_intrinsic_t intrinsic_list[] = {
    { NS "TO_INTEGER(" UU ")N", ieee_to_integer_unsigned },
    { NS "TO_INTEGER(" S ")I", ieee_to_integer_signed },
    { NS "TO_INTEGER(" US ")I", ieee_to_integer_signed },
+#ifdef HAVE_AVX512BW
+   { SL "TO_X01(V)V", std_to_x01_avx512, CPU_AVX512BW },
+   { SL "TO_X01(Y)Y", std_to_x01_avx512, CPU_AVX512BW },
+#endif
+#ifdef HAVE_AVX2
+   { SL "TO_X01(V)V", std_to_x01_avx2, CPU_AVX2 },
+   { SL "TO_X01(Y)Y", std_to_x01_avx2, CPU_AVX2 },
+#endif
 #ifdef HAVE_SSE41
    { SL "TO_X01(V)V", std_to_x01_sse41, CPU_SSE41 },
    { SL "TO_X01(Y)Y", std_to_x01_sse41, CPU_SSE41 },
@@ -2244,6 +2634,14 @@ static jit_intrinsic_t intrinsic_list[] = {
    { NS "RESIZE(" UU "N)" UU, ieee_resize_unsigned },
    { NS "RESIZE(" S "N)" S, ieee_resize_signed },
    { NS "RESIZE(" US "N)" US, ieee_resize_signed },
+#ifdef HAVE_AVX512BW
+   { SL "\"and\"(VV)V", ieee_and_vector_avx512, CPU_AVX512BW },
+   { SL "\"and\"(YY)Y", ieee_and_vector_avx512, CPU_AVX512BW },
+#endif
+#ifdef HAVE_AVX2
+   { SL "\"and\"(VV)V", ieee_and_vector_avx2, CPU_AVX2 },
+   { SL "\"and\"(YY)Y", ieee_and_vector_avx2, CPU_AVX2 },
+#endif
 #ifdef HAVE_SSE41
    { SL "\"and\"(VV)V", ieee_and_vector_sse41, CPU_SSE41 },
    { SL "\"and\"(YY)Y", ieee_and_vector_sse41, CPU_SSE41 },
@@ -2254,6 +2652,14 @@ static jit_intrinsic_t intrinsic_list[] = {
 #endif
    { SL "\"and\"(VV)V", ieee_and_vector },
    { SL "\"and\"(YY)Y", ieee_and_vector },
+#ifdef HAVE_AVX512BW
+   { SL "\"or\"(VV)V", ieee_or_vector_avx512, CPU_AVX512BW },
+   { SL "\"or\"(YY)Y", ieee_or_vector_avx512, CPU_AVX512BW },
+#endif
+#ifdef HAVE_AVX2
+   { SL "\"or\"(VV)V", ieee_or_vector_avx2, CPU_AVX2 },
+   { SL "\"or\"(YY)Y", ieee_or_vector_avx2, CPU_AVX2 },
+#endif
 #ifdef HAVE_SSE41
    { SL "\"or\"(VV)V", ieee_or_vector_sse41, CPU_SSE41 },
    { SL "\"or\"(YY)Y", ieee_or_vector_sse41, CPU_SSE41 },
@@ -2264,6 +2670,14 @@ static jit_intrinsic_t intrinsic_list[] = {
 #endif
    { SL "\"or\"(VV)V", ieee_or_vector },
    { SL "\"or\"(YY)Y", ieee_or_vector },
+#ifdef HAVE_AVX512BW
+   { SL "\"xor\"(VV)V", ieee_xor_vector_avx512, CPU_AVX512BW },
+   { SL "\"xor\"(YY)Y", ieee_xor_vector_avx512, CPU_AVX512BW },
+#endif
+#ifdef HAVE_AVX2
+   { SL "\"xor\"(VV)V", ieee_xor_vector_avx2, CPU_AVX2 },
+   { SL "\"xor\"(YY)Y", ieee_xor_vector_avx2, CPU_AVX2 },
+#endif
 #ifdef HAVE_SSE41
    { SL "\"xor\"(VV)V", ieee_xor_vector_sse41, CPU_SSE41 },
    { SL "\"xor\"(YY)Y", ieee_xor_vector_sse41, CPU_SSE41 },
@@ -2274,14 +2688,40 @@ static jit_intrinsic_t intrinsic_list[] = {
 #endif
    { SL "\"xor\"(VV)V", std_xor_vector },
    { SL "\"xor\"(YY)Y", std_xor_vector },
+#ifdef HAVE_AVX512BW
+   { SL "\"not\"(V)V", ieee_not_vector_avx512, CPU_AVX512BW },
+   { SL "\"not\"(Y)Y", ieee_not_vector_avx512, CPU_AVX512BW },
+#endif
+#ifdef HAVE_AVX2
+   { SL "\"not\"(V)V", ieee_not_vector_avx2, CPU_AVX2 },
+   { SL "\"not\"(Y)Y", ieee_not_vector_avx2, CPU_AVX2 },
+#endif
 #ifdef HAVE_SSE41
    { SL "\"not\"(V)V", ieee_not_vector_sse41, CPU_SSE41 },
    { SL "\"not\"(Y)Y", ieee_not_vector_sse41, CPU_SSE41 },
 #endif
+   { SL "\"and\"(Y)U", ieee_and_reduce },
+   { SL "\"nand\"(Y)U", ieee_nand_reduce },
+   { SL "\"or\"(Y)U", ieee_or_reduce },
+   { SL "\"nor\"(Y)U", ieee_nor_reduce },
+   { SL "\"xor\"(Y)U", ieee_xor_reduce },
+   { SL "\"xnor\"(Y)U", ieee_xnor_reduce },
    { NS "TO_UNSIGNED(NN)" U, ieee_to_unsigned },
    { NS "TO_UNSIGNED(NN)" UU, ieee_to_unsigned },
    { NS "TO_SIGNED(IN)" S, ieee_to_signed },
    { NS "TO_SIGNED(IN)" US, ieee_to_signed },
+#ifdef HAVE_AVX512BW
+   { SL "\"=\"(VV)B$predef", byte_vector_equal_avx512, CPU_AVX512BW },
+   { SL "\"=\"(YY)B$predef", byte_vector_equal_avx512, CPU_AVX512BW },
+   { ST "\"=\"(QQ)B$predef", byte_vector_equal_avx512, CPU_AVX512BW },
+   { ST "\"=\"(SS)B$predef", byte_vector_equal_avx512, CPU_AVX512BW },
+#endif
+#ifdef HAVE_AVX2
+   { SL "\"=\"(VV)B$predef", byte_vector_equal_avx2, CPU_AVX2 },
+   { SL "\"=\"(YY)B$predef", byte_vector_equal_avx2, CPU_AVX2 },
+   { ST "\"=\"(QQ)B$predef", byte_vector_equal_avx2, CPU_AVX2 },
+   { ST "\"=\"(SS)B$predef", byte_vector_equal_avx2, CPU_AVX2 },
+#endif
 #ifdef HAVE_SSE41
    { SL "\"=\"(VV)B$predef", byte_vector_equal_sse41, CPU_SSE41 },
    { SL "\"=\"(YY)B$predef", byte_vector_equal_sse41, CPU_SSE41 },
@@ -2350,32 +2790,49 @@ static jit_intrinsic_t intrinsic_list[] = {
    { NULL, NULL }
 };
 
+static inline bool vector_width_ok(int max_width, int bits)
+{
+   // One means no limit so the default for NVC_VECTOR_INTRINSICS
+   // enables every instruction set the CPU supports
+   return max_width == 1 || max_width >= bits;
+}
+
 jit_entry_fn_t jit_bind_intrinsic(ident_t name)
 {
    INIT_ONCE({
          const bool want_intrinsics = !!opt_get_int(OPT_JIT_INTRINSICS);
 
 #if ASAN_ENABLED
-         const bool want_vector = false;   // Reads past end of input (benign)
+         const int max_width = 0;   // Reads past end of input (benign)
 #else
-         const bool want_vector = !!opt_get_int(OPT_VECTOR_INTRINSICS);
+         // Zero disables the vector intrinsics and any value other than
+         // one limits the vector width in bits, which is useful for
+         // comparing implementations
+         const int max_width = opt_get_int(OPT_VECTOR_INTRINSICS);
 #endif
 
          ieee_packed_add = __ieee_packed_add_scalar;
 
          cpu_feature_t mask = 0;
 #ifdef HAVE_SSE41
-         if (want_vector && __builtin_cpu_supports("sse4.1")) {
+         if (vector_width_ok(max_width, 128)
+             && __builtin_cpu_supports("sse4.1")) {
             mask |= CPU_SSE41;
             ieee_packed_add = __ieee_packed_add_sse41;
          }
 #endif
 #if HAVE_AVX2
-         if (want_vector && __builtin_cpu_supports("avx2"))
+         if (vector_width_ok(max_width, 256)
+             && __builtin_cpu_supports("avx2"))
             mask |= CPU_AVX2;
 #endif
+#ifdef HAVE_AVX512BW
+         if (vector_width_ok(max_width, 512)
+             && __builtin_cpu_supports("avx512bw"))
+            mask |= CPU_AVX512BW;
+#endif
 #ifdef HAVE_NEON
-         if (want_vector)
+         if (vector_width_ok(max_width, 128))
             mask |= CPU_NEON;
 #endif
 
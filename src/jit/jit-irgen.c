@@ -3859,6 +3859,23 @@ static void irgen_op_level_trigger(jit_irgen_t *g, mir_value_t n)
    j_recv(g, g->map[n.id], 0);
 }
 
+static void irgen_op_edge_trigger(jit_irgen_t *g, mir_value_t n)
+{
+   jit_value_t shared = irgen_get_arg_slot(g, n, 0, 0);
+   jit_value_t offset = irgen_get_arg_slot(g, n, 0, 1);
+   jit_value_t mask = irgen_get_arg(g, n, 1);
+   jit_value_t inner = irgen_get_arg(g, n, 2);
+
+   j_send(g, 0, shared);
+   j_send(g, 1, offset);
+   j_send(g, 2, mask);
+   j_send(g, 3, inner);
+
+   macro_exit(g, JIT_EXIT_EDGE_TRIGGER);
+
+   j_recv(g, g->map[n.id], 0);
+}
+
 static void irgen_op_add_trigger(jit_irgen_t *g, mir_value_t n)
 {
    jit_value_t trigger = irgen_get_arg(g, n, 0);
@@ -4834,6 +4851,9 @@ static void irgen_block(jit_irgen_t *g, mir_block_t block)
       case MIR_OP_LEVEL_TRIGGER:
          irgen_op_level_trigger(g, n);
          break;
+      case MIR_OP_EDGE_TRIGGER:
+         irgen_op_edge_trigger(g, n);
+         break;
       case MIR_OP_ADD_TRIGGER:
          irgen_op_add_trigger(g, n);
          break;
@@ -27,11 +27,17 @@
 #include "thread.h"
 
 #include <assert.h>
+#include <errno.h>
 #include <libgen.h>
 #include <stdlib.h>
 #include <limits.h>
 #include <string.h>
 #include <stdint.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/stat.h>
 
 #include <llvm-c/Analysis.h>
 #include <llvm-c/Core.h>
@@ -171,6 +177,28 @@ typedef struct _cgen_block cgen_block_t;
 #define DWARF_ONLY(x)
 #endif
 
+#if HAVE_GIT_SHA
+#include "gitsha.h"
+#define GIT_SHA_ONLY(x) x
+#else
+#define GIT_SHA_ONLY(x)
+#endif
+
+#if defined __linux__ && defined ARCH_X86_64
+#define HAVE_OBJECT_CACHE 1
+#endif
+
+#define CACHE_MAGIC   0x4a43564e
+#define CACHE_DIR     "_NVC_JIT"
+
+// Objects written to the persistent cache only reference run-specific
+// addresses through these external symbols
+#define CPOOL_SYMBOL  "__nvc_cpool$%s"
+#define FUNC_SYMBOL   "__nvc_func$%s"
+#define PRIV_SYMBOL   "__nvc_priv$%s"
+#define LOCUS_SYMBOL  "__nvc_locus$%s$%"PRIiPTR
+#define ABS_SYMBOL    "__nvc_abs$%"PRIuPTR
+
 typedef struct _llvm_obj {
    LLVMModuleRef         module;
    LLVMContextRef        context;
@@ -186,6 +214,8 @@ typedef struct _llvm_obj {
    LLVMTypeRef           fntypes[LLVM_LAST_FN];
    LLVMValueRef          strtab;
    unsigned              opt_hint;
+   bool                  relocatable;
+   ihash_t              *abstab;
 } llvm_obj_t;
 
 typedef struct _cgen_block {
@@ -292,6 +322,22 @@ static LLVMValueRef llvm_real(llvm_obj_t *obj, double r)
    return LLVMConstReal(obj->types[LLVM_DOUBLE], r);
 }
 
+static LLVMValueRef llvm_extern_ptr(llvm_obj_t *obj, const char *fmt, ...)
+{
+   va_list ap;
+   va_start(ap, fmt);
+   char *name LOCAL = xvasprintf(fmt, ap);
+   va_end(ap);
+
+   LLVMValueRef global = LLVMGetNamedGlobal(obj->module, name);
+   if (global == NULL) {
+      global = LLVMAddGlobal(obj->module, obj->types[LLVM_INT8], name);
+      LLVMSetLinkage(global, LLVMExternalLinkage);
+   }
+
+   return global;
+}
+
 static void llvm_add_func_attr(llvm_obj_t *obj, LLVMValueRef fn,
                                func_attr_t attr, int param)
 {
@@ -1160,7 +1206,15 @@ static LLVMValueRef cgen_get_value(llvm_obj_t *obj, cgen_block_t *cgb,
       return llvm_real(obj, value.dval);
    case JIT_ADDR_CPOOL:
       assert(value.int64 >= 0 && value.int64 <= cgb->func->source->cpoolsz);
-      return llvm_ptr(obj, cgb->func->source->cpool + value.int64);
+      if (obj->relocatable) {
+         LLVMValueRef cpool = llvm_extern_ptr(obj, CPOOL_SYMBOL,
+                                              istr(cgb->func->source->name));
+         LLVMValueRef indexes[] = { llvm_intptr(obj, value.int64) };
+         return LLVMBuildGEP2(obj->builder, obj->types[LLVM_INT8],
+                              cpool, indexes, 1, "");
+      }
+      else
+         return llvm_ptr(obj, cgb->func->source->cpool + value.int64);
    case JIT_ADDR_REG:
       {
          assert(value.reg < cgb->func->source->nregs);
@@ -1182,11 +1236,41 @@ static LLVMValueRef cgen_get_value(llvm_obj_t *obj, cgen_block_t *cgb,
    case JIT_VALUE_EXIT:
       return llvm_int32(obj, value.exit);
    case JIT_VALUE_HANDLE:
-      return llvm_int32(obj, value.handle);
+      if (obj->relocatable) {
+         // Handles are assigned in a different order on each run
+         jit_func_t *f = jit_get_func(cgb->func->source->jit, value.handle);
+         LLVMValueRef fptr = llvm_extern_ptr(obj, FUNC_SYMBOL, istr(f->name));
+         LLVMValueRef indexes[] = {
+            llvm_intptr(obj, offsetof(jit_func_t, handle))
+         };
+         LLVMValueRef ptr = LLVMBuildGEP2(obj->builder, obj->types[LLVM_INT8],
+                                          fptr, indexes, 1, "");
+#ifndef LLVM_HAS_OPAQUE_POINTERS
+         LLVMTypeRef ptr_type = LLVMPointerType(obj->types[LLVM_INT32], 0);
+         ptr = LLVMBuildPointerCast(obj->builder, ptr, ptr_type, "");
+#endif
+         return LLVMBuildLoad2(obj->builder, obj->types[LLVM_INT32], ptr, "");
+      }
+      else
+         return llvm_int32(obj, value.handle);
    case JIT_ADDR_ABS:
-      return llvm_ptr(obj, (void *)(intptr_t)value.int64);
+      if (obj->relocatable && value.int64 != 0) {
+         const uintptr_t n = (uintptr_t)ihash_get(obj->abstab, value.int64);
+         assert(n > 0);
+         return llvm_extern_ptr(obj, ABS_SYMBOL, n - 1);
+      }
+      else
+         return llvm_ptr(obj, (void *)(intptr_t)value.int64);
    case JIT_VALUE_LOCUS:
-      return llvm_ptr(obj, value.locus);
+      if (obj->relocatable) {
+         ident_t module;
+         ptrdiff_t offset;
+         object_locus(value.locus, &module, &offset);
+
+         return llvm_extern_ptr(obj, LOCUS_SYMBOL, istr(module), offset);
+      }
+      else
+         return llvm_ptr(obj, value.locus);
    default:
       fatal_trace("cannot handle value kind %d", value.kind);
    }
@@ -1337,6 +1421,9 @@ static void cgen_debug_loc(llvm_obj_t *obj, cgen_func_t *func, const loc_t *loc)
 
 static LLVMValueRef cgen_maybe_inline(llvm_obj_t *obj, jit_func_t *callee)
 {
+   if (obj->relocatable)
+      return NULL;   // Cache key does not cover the callee
+
    if (load_acquire(&callee->state) != JIT_FUNC_READY)
       return NULL;
 
@@ -1868,7 +1955,11 @@ static void cgen_op_call(llvm_obj_t *obj, cgen_block_t *cgb, jit_ir_t *ir)
 
    jit_func_t *callee = jit_get_func(cgb->func->source->jit, ir->arg1.handle);
 
-   LLVMValueRef fptr = llvm_ptr(obj, callee);
+   LLVMValueRef fptr;
+   if (obj->relocatable)
+      fptr = llvm_extern_ptr(obj, FUNC_SYMBOL, istr(callee->name));
+   else
+      fptr = llvm_ptr(obj, callee);
 
    LLVMValueRef entry = cgen_maybe_inline(obj, callee);
    if (entry == NULL) {
@@ -2162,7 +2253,11 @@ static void cgen_macro_salloc(llvm_obj_t *obj, cgen_block_t *cgb, jit_ir_t *ir)
 static void cgen_macro_getpriv(llvm_obj_t *obj, cgen_block_t *cgb, jit_ir_t *ir)
 {
    jit_func_t *f = jit_get_func(cgb->func->source->jit, ir->arg1.handle);
-   LLVMValueRef ptrptr = llvm_ptr(obj, jit_get_privdata_ptr(f->jit, f));
+   LLVMValueRef ptrptr;
+   if (obj->relocatable)
+      ptrptr = llvm_extern_ptr(obj, PRIV_SYMBOL, istr(f->name));
+   else
+      ptrptr = llvm_ptr(obj, jit_get_privdata_ptr(f->jit, f));
 
 #ifndef LLVM_HAS_OPAQUE_POINTERS
    LLVMTypeRef ptr_type = LLVMPointerType(obj->types[LLVM_PTR], 0);
@@ -3123,8 +3218,325 @@ static void cgen_memset_body(llvm_obj_t *obj, llvm_fn_t which,
 
 typedef struct {
    code_cache_t *code;
+   char         *cachedir;
+   uint64_t      seed;
+   hash_t       *libdirs;
+   nvc_lock_t    lock;
 } llvm_jit_state_t;
 
+typedef struct {
+   uint64_t  hash;
+   shash_t  *symbols;
+   ihash_t  *abstab;
+   uintptr_t nabs;
+} cache_key_t;
+
+typedef struct {
+   uint32_t magic;
+   uint32_t namelen;
+   uint64_t hash;
+   uint64_t size;
+} cache_header_t;
+
+static void cache_hash_bytes(cache_key_t *key, const void *data, size_t len)
+{
+   // FNV-1a
+   const uint8_t *p = data;
+   for (size_t i = 0; i < len; i++)
+      key->hash = (key->hash ^ p[i]) * UINT64_C(0x100000001b3);
+}
+
+static void cache_hash_string(cache_key_t *key, const char *str)
+{
+   cache_hash_bytes(key, str, strlen(str) + 1);
+}
+
+static void cache_add_symbol(cache_key_t *key, void *ptr, const char *fmt, ...)
+{
+   va_list ap;
+   va_start(ap, fmt);
+   char *name LOCAL = xvasprintf(fmt, ap);
+   va_end(ap);
+
+   cache_hash_string(key, name);
+   shash_put(key->symbols, name, ptr);
+}
+
+static bool cache_hash_value(cache_key_t *key, jit_func_t *f, jit_ir_t *ir,
+                             const jit_value_t *value)
+{
+   cache_hash_bytes(key, &value->kind, sizeof(value->kind));
+
+   switch (value->kind) {
+   case JIT_VALUE_INVALID:
+   case JIT_VALUE_LOC:   // Only used for debug information
+      return true;
+   case JIT_VALUE_REG:
+      cache_hash_bytes(key, &value->reg, sizeof(value->reg));
+      return true;
+   case JIT_ADDR_REG:
+      cache_hash_bytes(key, &value->reg, sizeof(value->reg));
+      cache_hash_bytes(key, &value->disp, sizeof(value->disp));
+      return true;
+   case JIT_VALUE_INT64:
+      cache_hash_bytes(key, &value->int64, sizeof(value->int64));
+      return true;
+   case JIT_ADDR_ABS:
+      if (value->int64 != 0) {
+         // Absolute addresses change between runs with ASLR so number
+         // each distinct address in order of first use and relocate
+         uintptr_t n = (uintptr_t)ihash_get(key->abstab, value->int64);
+         if (n == 0) {
+            n = ++key->nabs;
+            ihash_put(key->abstab, value->int64, (void *)n);
+            cache_add_symbol(key, (void *)(intptr_t)value->int64,
+                             ABS_SYMBOL, n - 1);
+         }
+         else
+            cache_hash_bytes(key, &n, sizeof(n));
+      }
+      return true;
+   case JIT_VALUE_DOUBLE:
+      cache_hash_bytes(key, &value->dval, sizeof(value->dval));
+      return true;
+   case JIT_VALUE_LABEL:
+      cache_hash_bytes(key, &value->label, sizeof(value->label));
+      return true;
+   case JIT_VALUE_EXIT:
+      cache_hash_bytes(key, &value->exit, sizeof(value->exit));
+      return true;
+   case JIT_VALUE_VPOS:
+      cache_hash_bytes(key, &value->vpos, sizeof(value->vpos));
+      return true;
+   case JIT_ADDR_CPOOL:
+      cache_hash_bytes(key, &value->int64, sizeof(value->int64));
+      cache_add_symbol(key, f->cpool, CPOOL_SYMBOL, istr(f->name));
+      return true;
+   case JIT_VALUE_HANDLE:
+      {
+         jit_func_t *callee = jit_get_func(f->jit, value->handle);
+         cache_add_symbol(key, callee, FUNC_SYMBOL, istr(callee->name));
+
+         if (ir->op == MACRO_GETPRIV)
+            cache_add_symbol(key, jit_get_privdata_ptr(f->jit, callee),
+                             PRIV_SYMBOL, istr(callee->name));
+      }
+      return true;
+   case JIT_VALUE_LOCUS:
+      {
+         // Objects created during this run cannot be found again
+         if (!arena_frozen(object_arena(value->locus)))
+            return false;
+
+         ident_t module;
+         ptrdiff_t offset;
+         object_locus(value->locus, &module, &offset);
+
+         cache_add_symbol(key, value->locus, LOCUS_SYMBOL,
+                          istr(module), offset);
+      }
+      return true;
+   default:
+      return false;
+   }
+}
+
+static void cache_key_free(cache_key_t *key)
+{
+   shash_free(key->symbols);
+   key->symbols = NULL;
+
+   ihash_free(key->abstab);
+   key->abstab = NULL;
+}
+
+static bool cache_key_init(llvm_jit_state_t *state, jit_func_t *f,
+                           cache_key_t *key)
+{
+   key->hash    = state->seed;
+   key->symbols = shash_new(16);
+   key->abstab  = ihash_new(16);
+   key->nabs    = 0;
+
+   cache_hash_string(key, istr(f->name));
+
+   const unsigned header[] = {
+      f->framesz, f->nirs, f->nregs, f->nvars, f->cpoolsz
+   };
+   cache_hash_bytes(key, header, sizeof(header));
+   cache_hash_bytes(key, f->cpool, f->cpoolsz);
+
+   for (int i = 0; i < f->nirs; i++) {
+      jit_ir_t *ir = &(f->irbuf[i]);
+
+      const unsigned fields[] = {
+         ir->op, ir->size, ir->target, ir->cc, ir->result
+      };
+      cache_hash_bytes(key, fields, sizeof(fields));
+
+      if (!cache_hash_value(key, f, ir, &(ir->arg1))
+          || !cache_hash_value(key, f, ir, &(ir->arg2))) {
+         cache_key_free(key);
+         return false;
+      }
+   }
+
+   return true;
+}
+
+static char *cache_path(const char *dir, cache_key_t *key)
+{
+   return xasprintf("%s" DIR_SEP "%016"PRIx64, dir, key->hash);
+}
+
+static const char *cache_lib_dir(llvm_jit_state_t *state, jit_func_t *f)
+{
+   if (state->libdirs == NULL)
+      return NULL;
+
+   ident_t it = f->name;
+   ident_t lname = ident_walk_selected(&it);
+
+   SCOPED_LOCK(state->lock);
+
+   char *dir = hash_get(state->libdirs, lname);
+   if (dir == NULL) {
+      // Libraries other than the work library may have been installed
+      // with precompiled code for their packages
+      lib_t lib = lib_find(lname);
+      if (lib != NULL && lib != lib_work())
+         dir = xasprintf("%s" DIR_SEP CACHE_DIR, lib_path(lib));
+      else
+         dir = xstrdup("");
+
+      struct stat st;
+      if (*dir != '\0' && (stat(dir, &st) != 0 || !S_ISDIR(st.st_mode)))
+         *dir = '\0';
+
+      hash_put(state->libdirs, lname, dir);
+   }
+
+   return *dir != '\0' ? dir : NULL;
+}
+
+static bool cache_load(llvm_jit_state_t *state, const char *dir,
+                       jit_func_t *f, cache_key_t *key)
+{
+   const uint64_t start_us = get_timestamp_us();
+
+   char *path LOCAL = cache_path(dir, key);
+
+   FILE *fp = fopen(path, "rb");
+   if (fp == NULL)
+      return false;
+
+   const char *name = istr(f->name);
+   const size_t namelen = strlen(name);
+
+   struct stat st;
+   cache_header_t header;
+   char *buf LOCAL = NULL;
+
+   bool valid = fstat(fileno(fp), &st) == 0
+      && fread(&header, sizeof(header), 1, fp) == 1
+      && header.magic == CACHE_MAGIC
+      && header.hash == key->hash
+      && header.namelen == namelen
+      && sizeof(header) + namelen + header.size == st.st_size;
+
+   if (valid) {
+      buf = xmalloc(namelen + header.size);
+      valid = fread(buf, namelen + header.size, 1, fp) == 1
+         && memcmp(buf, name, namelen) == 0;
+   }
+
+   fclose(fp);
+
+   if (!valid)
+      return false;   // Will be replaced with a fresh object
+
+   code_blob_t *blob = code_blob_new(state->code, f->name, header.size);
+   if (blob == NULL)
+      return true;
+
+   blob->symbols = key->symbols;
+   code_load_object(blob, buf + namelen, header.size);
+   blob->symbols = NULL;   // Owned by the cache key
+
+   code_blob_finalise(blob, &(f->entry));
+
+   if (opt_get_int(OPT_JIT_LOG)) {
+      const uint64_t end_us = get_timestamp_us();
+      debugf("%s loaded from cache in %"PRIi64" us", istr(f->name),
+             end_us - start_us);
+   }
+
+   return true;
+}
+
+static void cache_store(llvm_jit_state_t *state, jit_func_t *f,
+                        cache_key_t *key, const void *data, size_t size)
+{
+   char *path LOCAL = cache_path(state->cachedir, key);
+   char *tmp LOCAL = xasprintf("%s.%d.%d", path, getpid(), thread_id());
+
+   const char *name = istr(f->name);
+
+   const cache_header_t header = {
+      .magic   = CACHE_MAGIC,
+      .namelen = strlen(name),
+      .hash    = key->hash,
+      .size    = size,
+   };
+
+   // Write to a temporary file first as other processes may be reading
+   // from the same cache concurrently
+   FILE *fp = fopen(tmp, "wb");
+   if (fp == NULL) {
+      warnf("cannot create %s: %s", tmp, last_os_error());
+      return;
+   }
+
+   const bool ok = fwrite(&header, sizeof(header), 1, fp) == 1
+      && fwrite(name, header.namelen, 1, fp) == 1
+      && fwrite(data, size, 1, fp) == 1;
+
+   if (fclose(fp) != 0 || !ok || rename(tmp, path) != 0) {
+      warnf("cannot write %s: %s", path, last_os_error());
+      remove(tmp);
+   }
+}
+
+static void cache_init(llvm_jit_state_t *state)
+{
+#ifdef HAVE_OBJECT_CACHE
+   cache_key_t key = { .hash = UINT64_C(0xcbf29ce484222325) };
+   cache_hash_string(&key, PACKAGE_STRING GIT_SHA_ONLY(" " GIT_SHA));
+   cache_hash_string(&key, LLVM_VERSION);
+
+   char *triple = LLVMGetDefaultTargetTriple();
+   cache_hash_string(&key, triple);
+   LLVMDisposeMessage(triple);
+
+   state->seed    = key.hash;
+   state->libdirs = hash_new(16);
+
+   if (opt_get_int(OPT_JIT_CACHE)) {
+      char *dir = xasprintf("%s" DIR_SEP CACHE_DIR, lib_path(lib_work()));
+      if (mkdir(dir, 0777) != 0 && errno != EEXIST) {
+         warnf("cannot create JIT cache directory %s: %s", dir,
+               last_os_error());
+         free(dir);
+      }
+      else
+         state->cachedir = dir;
+   }
+#else
+   if (opt_get_int(OPT_JIT_CACHE))
+      warnf("the JIT object cache is not supported on this platform");
+#endif
+}
+
 static void *jit_llvm_init(jit_t *jit)
 {
    llvm_native_setup();
@@ -3132,6 +3544,8 @@ static void *jit_llvm_init(jit_t *jit)
    llvm_jit_state_t *state = xcalloc(sizeof(llvm_jit_state_t));
    state->code = code_cache_new();
 
+   cache_init(state);
+
    return state;
 }
 
@@ -3149,12 +3563,23 @@ static void jit_llvm_cgen(jit_t *j, jit_handle_t handle, void *context)
 
    const uint64_t start_us = get_timestamp_us();
 
+   cache_key_t key = {};
+   const bool cacheable =
+      state->cachedir != NULL && cache_key_init(state, f, &key);
+
+   if (cacheable && cache_load(state, state->cachedir, f, &key)) {
+      cache_key_free(&key);
+      return;
+   }
+
    LLVMTargetMachineRef tm = llvm_target_machine(LLVMRelocStatic,
                                                  JIT_CODE_MODEL);
 
    llvm_obj_t obj = {
-      .context = LLVMContextCreate(),
-      .target  = tm,
+      .context     = LLVMContextCreate(),
+      .target      = tm,
+      .relocatable = cacheable,
+      .abstab      = key.abstab,
    };
 
    LOCAL_TEXT_BUF tb = tb_new();
@@ -3211,19 +3636,24 @@ static void jit_llvm_cgen(jit_t *j, jit_handle_t handle, void *context)
                                            &error, &buf))
      fatal("failed to generate native code: %s", error);
 
+   const size_t objsz = LLVMGetBufferSize(buf);
+
+   if (cacheable)
+      cache_store(state, f, &key, LLVMGetBufferStart(buf), objsz);
+
    if (jit_is_shutdown(f->jit))
       goto skip_load;
 
-   const size_t objsz = LLVMGetBufferSize(buf);
-
    code_blob_t *blob = code_blob_new(state->code, f->name, objsz);
    if (blob == NULL)
-      return;
+      goto skip_load;
 
    const uint8_t *base = blob->wptr;
    const void *entry_addr = blob->wptr;
 
+   blob->symbols = key.symbols;
    code_load_object(blob, LLVMGetBufferStart(buf), objsz);
+   blob->symbols = NULL;   // Owned by the cache key
 
    const size_t size = blob->wptr - base;
    code_blob_finalise(blob, &(f->entry));
@@ -3243,19 +3673,56 @@ static void jit_llvm_cgen(jit_t *j, jit_handle_t handle, void *context)
    LLVMDisposeBuilder(obj.builder);
    DWARF_ONLY(LLVMDisposeDIBuilder(obj.debuginfo));
    LLVMContextDispose(obj.context);
+   cache_key_free(&key);
    free(func.name);
 }
 
+static bool jit_llvm_load(jit_t *j, jit_handle_t handle, void *context)
+{
+   llvm_jit_state_t *state = context;
+
+   jit_func_t *f = jit_get_func(j, handle);
+
+   const char *libdir = cache_lib_dir(state, f);
+   if (libdir == NULL && state->cachedir == NULL)
+      return false;
+
+   cache_key_t key;
+   if (!cache_key_init(state, f, &key))
+      return false;
+
+   const bool found =
+      (libdir != NULL && cache_load(state, libdir, f, &key))
+      || (state->cachedir != NULL
+          && cache_load(state, state->cachedir, f, &key));
+
+   cache_key_free(&key);
+   return found;
+}
+
 static void jit_llvm_cleanup(void *context)
 {
    llvm_jit_state_t *state = context;
    code_cache_free(state->code);
+   free(state->cachedir);
+
+   if (state->libdirs != NULL) {
+      const void *key;
+      void *value;
+      for (hash_iter_t it = HASH_BEGIN;
+           hash_iter(state->libdirs, &it, &key, &value); )
+         free(value);
+
+      hash_free(state->libdirs);
+   }
+
    free(state);
 }
 
 static const jit_plugin_t jit_llvm = {
    .init    = jit_llvm_init,
    .cgen    = jit_llvm_cgen,
+   .load    = jit_llvm_load,
    .cleanup = jit_llvm_cleanup
 };
 
@@ -1336,7 +1336,8 @@ static void lscan_walk_cfg(jit_func_t *f, jit_cfg_t *cfg, int bi,
 
    jit_block_t *b = &(cfg->blocks[bi]);
 
-   for (size_t bit = -1; mask_iter(&b->livein, &bit);)
+   // The extra bit at the end of the liveness masks is for the flags
+   for (size_t bit = -1; mask_iter(&b->livein, &bit) && bit < f->nregs;)
       lscan_grow_range(bit, li, b->first);
 
    for (int i = b->first; i <= b->last; i++) {
@@ -1352,7 +1353,7 @@ static void lscan_walk_cfg(jit_func_t *f, jit_cfg_t *cfg, int bi,
          lscan_grow_range(ir->arg2.reg, li, i);
    }
 
-   for (size_t bit = -1; mask_iter(&b->liveout, &bit); )
+   for (size_t bit = -1; mask_iter(&b->liveout, &bit) && bit < f->nregs;)
       lscan_grow_range(bit, li, b->last);
 
    for (int i = 0; i < b->out.count; i++) {
@@ -177,6 +177,7 @@ typedef enum {
    JIT_EXIT_SCHED_INACTIVE,
    JIT_EXIT_GET_COUNTERS,
    JIT_EXIT_SCHED_ACTIVE,
+   JIT_EXIT_EDGE_TRIGGER,
 } jit_exit_t;
 
 typedef uint16_t jit_reg_t;
@@ -305,6 +306,8 @@ typedef struct {
    unsigned offset;
 } link_tab_t;
 
+typedef struct _jit_icode jit_icode_t;
+
 typedef struct _jit_func {
    jit_entry_fn_t  entry;    // Must be first
    func_state_t    state;
@@ -313,6 +316,7 @@ typedef struct _jit_func {
    link_tab_t     *linktab;
    mptr_t          privdata;
    jit_ir_t       *irbuf;
+   jit_icode_t    *icode;
    unsigned char  *cpool;
    unsigned        framesz;
    unsigned        nirs;
@@ -322,6 +326,8 @@ typedef struct _jit_func {
    jit_handle_t    handle;
    unsigned        hotness;
    jit_tier_t     *next_tier;
+   unsigned        heat;
+   jit_entry_fn_t  osr_entry;
    ffi_spec_t      spec;
    object_t       *object;
 } jit_func_t;
@@ -358,6 +364,7 @@ typedef struct {
    ihash_t      *labels;
    patch_list_t *patches;
    uint8_t      *veneers;
+   shash_t      *symbols;
    bool          overflow;
 } code_blob_t;
 
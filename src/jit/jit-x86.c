@@ -21,6 +21,7 @@
 #include "jit/jit-priv.h"
 #include "jit/jit.h"
 #include "rt/rt.h"
+#include "thread.h"
 
 #include <assert.h>
 #include <inttypes.h>
@@ -38,6 +39,7 @@ typedef enum {
    TLAB_STUB,
    FEXP_STUB,
    ROUND_STUB,
+   TIER_STUB,
 
    NUM_STUBS
 } jit_x86_stub_t;
@@ -49,7 +51,7 @@ typedef struct {
 } jit_x86_state_t;
 
 // Conservative guess at the number of bytes emitted per IR
-#define BYTES_PER_IR 16
+#define BYTES_PER_IR 64
 
 #define FRAME_FIXED_SIZE 80    // Size of fixed part of call frame
 #define ANCHOR_OFFSET    -24   // Offset of frame anchor from RBP
@@ -194,6 +196,7 @@ typedef enum {
 #define AND(dst, src, size) asm_and(blob, (dst), (src), (size))
 #define OR(dst, src, size) asm_or(blob, (dst), (src), (size))
 #define SHL(src, size) asm_shl(blob, (src), (size))
+#define SHR(src, size) asm_shr(blob, (src), (size))
 #define SAR(src, count, size) asm_sar(blob, (src), (count), (size))
 #define XOR(dst, src, size) asm_xor(blob, (dst), (src), (size))
 #define NEG(dst, size) asm_neg(blob, (dst), (size))
@@ -210,6 +213,10 @@ typedef enum {
    asm_cmovcc(blob, (dst), (src), (size), X86_CMP_GT)
 #define CMOVLT(dst, src, size)                          \
    asm_cmovcc(blob, (dst), (src), (size), X86_CMP_LT)
+#define CMOVA(dst, src, size)                           \
+   asm_cmovcc(blob, (dst), (src), (size), 0x7)
+#define CMOVC(dst, src, size)                           \
+   asm_cmovcc(blob, (dst), (src), (size), X86_CMP_C)
 #define LEA(dst, addr) asm_lea(blob, (dst), (addr))
 #define SETO(dst) asm_setcc(blob, (dst), X86_CMP_O)
 #define SETC(dst) asm_setcc(blob, (dst), X86_CMP_C)
@@ -434,8 +441,8 @@ static void asm_mov(code_blob_t *blob, x86_operand_t dst, x86_operand_t src,
       break;
 
    case MEM_REG:
-      x86_rex(&insn, size, src.reg, dst.addr.reg, 0);
       x86_override(&insn, size == __WORD);
+      x86_rex(&insn, size, src.reg, dst.addr.reg, 0);
       x86_opcode(&insn, size == __BYTE ? 0x88 : 0x89);
       if (is_imm8(dst.addr.off)) {
          x86_modrm(&insn, 1, src.reg, dst.addr.reg);
@@ -448,8 +455,8 @@ static void asm_mov(code_blob_t *blob, x86_operand_t dst, x86_operand_t src,
       break;
 
    case REG_MEM:
-      x86_rex(&insn, size, dst.reg, src.addr.reg, 0);
       x86_override(&insn, size == __WORD);
+      x86_rex(&insn, size, dst.reg, src.addr.reg, 0);
       x86_opcode(&insn, size == __BYTE ? 0x8a : 0x8b);
       if (is_imm8(src.addr.off)) {
          x86_modrm(&insn, 1, dst.reg, src.addr.reg);
@@ -558,6 +565,19 @@ static void asm_mov(code_blob_t *blob, x86_operand_t dst, x86_operand_t src,
          }
          x86_imm32(&insn, src.imm);
          break;
+      case __DWORD:
+         x86_rex(&insn, size, 0, dst.addr.reg, 0);
+         x86_opcode(&insn, 0xc7);
+         if (is_imm8(dst.addr.off)) {
+            x86_modrm(&insn, 1, 0, dst.addr.reg);
+            x86_imm8(&insn, dst.addr.off);
+         }
+         else {
+            x86_modrm(&insn, 2, 0, dst.addr.reg);
+            x86_imm32(&insn, dst.addr.off);
+         }
+         x86_imm32(&insn, src.imm);
+         break;
       default:
          fatal_trace("unhandled immediate size %d in asm_mov", size);
       }
@@ -577,22 +597,22 @@ static void asm_movsx(code_blob_t *blob, x86_operand_t dst, x86_operand_t src,
 
    switch (COMBINE(dst, src)) {
    case REG_REG:
-      x86_rex(&insn, dsize, src.reg, dst.reg, 0);
+      x86_rex(&insn, dsize, dst.reg, src.reg, 0);
       switch (ssize) {
-      case __BYTE:
-         x86_opcode_2(&insn, 0x0f, 0xbe);
-         x86_modrm(&insn, 3, src.reg, dst.reg);
-         break;
-      default:
-         fatal_trace("unhandled source size %d in asm_movsx", ssize);
+      case __QWORD: x86_opcode(&insn, 0x8b); break;
+      case __DWORD: x86_opcode(&insn, 0x63); break;
+      case __WORD: x86_opcode_2(&insn, 0x0f, 0xbf); break;
+      case __BYTE: x86_opcode_2(&insn, 0x0f, 0xbe); break;
       }
+      x86_modrm(&insn, 3, dst.reg, src.reg);
       break;
 
    case REG_MEM:
-      x86_rex(&insn, dsize, src.addr.reg, dst.reg, 0);
+      x86_rex(&insn, dsize, dst.reg, src.addr.reg, 0);
       switch (ssize) {
       case __QWORD: x86_opcode(&insn, 0x8b); break;
       case __DWORD: x86_opcode(&insn, 0x63); break;
+      case __WORD: x86_opcode_2(&insn, 0x0f, 0xbf); break;
       case __BYTE: x86_opcode_2(&insn, 0x0f, 0xbe); break;
       default:
          fatal_trace("unhandled source size %d in asm_movsx", ssize);
@@ -619,21 +639,38 @@ static void asm_movzx(code_blob_t *blob, x86_operand_t dst, x86_operand_t src,
 {
    x86_insn_t insn = {};
 
-   assert(COMBINE(dst, src) == REG_MEM);
-   x86_rex(&insn, ssize, dst.reg, src.addr.reg, 0);
-   switch (ssize) {
-   case __QWORD:
-   case __DWORD: x86_opcode(&insn, 0x8b); break;
-   case __WORD: x86_opcode_2(&insn, 0x0f, 0xb7); break;
-   case __BYTE: x86_opcode_2(&insn, 0x0f, 0xb6); break;
-   }
-   if (is_imm8(src.addr.off)) {
-      x86_modrm(&insn, 1, dst.reg, src.addr.reg);
-      x86_imm8(&insn, src.addr.off);
-   }
-   else {
-      x86_modrm(&insn, 2, dst.reg, src.addr.reg);
-      x86_imm32(&insn, src.addr.off);
+   switch (COMBINE(dst, src)) {
+   case REG_REG:
+      x86_rex(&insn, ssize == __QWORD ? ssize : __DWORD, dst.reg, src.reg, 0);
+      switch (ssize) {
+      case __QWORD:
+      case __DWORD: x86_opcode(&insn, 0x8b); break;
+      case __WORD: x86_opcode_2(&insn, 0x0f, 0xb7); break;
+      case __BYTE: x86_opcode_2(&insn, 0x0f, 0xb6); break;
+      }
+      x86_modrm(&insn, 3, dst.reg, src.reg);
+      break;
+
+   case REG_MEM:
+      x86_rex(&insn, ssize, dst.reg, src.addr.reg, 0);
+      switch (ssize) {
+      case __QWORD:
+      case __DWORD: x86_opcode(&insn, 0x8b); break;
+      case __WORD: x86_opcode_2(&insn, 0x0f, 0xb7); break;
+      case __BYTE: x86_opcode_2(&insn, 0x0f, 0xb6); break;
+      }
+      if (is_imm8(src.addr.off)) {
+         x86_modrm(&insn, 1, dst.reg, src.addr.reg);
+         x86_imm8(&insn, src.addr.off);
+      }
+      else {
+         x86_modrm(&insn, 2, dst.reg, src.addr.reg);
+         x86_imm32(&insn, src.addr.off);
+      }
+      break;
+
+   default:
+      fatal_trace("unhandled operand combination in asm_movzx");
    }
 
    x86_emit(blob, &insn);
@@ -712,6 +749,21 @@ static void asm_add(code_blob_t *blob, x86_operand_t dst, x86_operand_t src,
       }
       break;
 
+   case MEM_IMM:
+      assert(is_imm8(src.imm) && size != __BYTE);
+      x86_rex(&insn, size, 0, dst.addr.reg, 0);
+      x86_opcode(&insn, 0x83);
+      if (is_imm8(dst.addr.off)) {
+         x86_modrm(&insn, 1, 0, dst.addr.reg);
+         x86_imm8(&insn, dst.addr.off);
+      }
+      else {
+         x86_modrm(&insn, 2, 0, dst.addr.reg);
+         x86_imm32(&insn, dst.addr.off);
+      }
+      x86_imm8(&insn, src.imm);
+      break;
+
    default:
       fatal_trace("unhandled operand combination in asm_sub");
    }
@@ -752,6 +804,21 @@ static void asm_sub(code_blob_t *blob, x86_operand_t dst, x86_operand_t src,
       }
       break;
 
+   case MEM_IMM:
+      assert(is_imm8(src.imm) && size != __BYTE);
+      x86_rex(&insn, size, 0, dst.addr.reg, 0);
+      x86_opcode(&insn, 0x83);
+      if (is_imm8(dst.addr.off)) {
+         x86_modrm(&insn, 1, 5, dst.addr.reg);
+         x86_imm8(&insn, dst.addr.off);
+      }
+      else {
+         x86_modrm(&insn, 2, 5, dst.addr.reg);
+         x86_imm32(&insn, dst.addr.off);
+      }
+      x86_imm8(&insn, src.imm);
+      break;
+
    default:
       fatal_trace("unhandled operand combination in asm_sub");
    }
@@ -857,13 +924,25 @@ static void asm_shl(code_blob_t *blob, x86_operand_t src, x86_size_t size)
    x86_insn_t insn = {};
 
    assert(src.kind == X86_REG);
-   x86_rex(&insn, size, src.reg, 0, 0);
+   x86_rex(&insn, size, 0, src.reg, 0);
    x86_opcode(&insn, 0xd3);
    x86_modrm(&insn, 3, 4, src.reg);
 
    x86_emit(blob, &insn);
 }
 
+static void asm_shr(code_blob_t *blob, x86_operand_t src, x86_size_t size)
+{
+   x86_insn_t insn = {};
+
+   assert(src.kind == X86_REG);
+   x86_rex(&insn, size, 0, src.reg, 0);
+   x86_opcode(&insn, 0xd3);
+   x86_modrm(&insn, 3, 5, src.reg);
+
+   x86_emit(blob, &insn);
+}
+
 static void asm_sar(code_blob_t *blob, x86_operand_t src, x86_operand_t count,
                     x86_size_t size)
 {
@@ -872,13 +951,13 @@ static void asm_sar(code_blob_t *blob, x86_operand_t src, x86_operand_t count,
    switch (COMBINE(src, count)) {
    case REG_REG:
       assert(count.reg == __ECX.reg);
-      x86_rex(&insn,size, src.reg, 0, 0);
+      x86_rex(&insn, size, 0, src.reg, 0);
       x86_opcode(&insn, 0xd3);
       x86_modrm(&insn, 3, 7, src.reg);
       break;
 
    case REG_IMM:
-      x86_rex(&insn, size, src.reg, 0, 0);
+      x86_rex(&insn, size, 0, src.reg, 0);
       if (count.imm == 1) {
          x86_opcode(&insn, 0xd1);
          x86_modrm(&insn, 3, 7, src.reg);
@@ -955,8 +1034,22 @@ static void asm_cmp(code_blob_t *blob, x86_operand_t src1,
       }
       break;
 
+   case REG_IMM:
+      x86_rex(&insn, size, 0, src1.reg, 0);
+      if (is_imm8(src2.imm)) {
+         x86_opcode(&insn, 0x83);
+         x86_modrm(&insn, 3, 7, src1.reg);
+         x86_imm8(&insn, src2.imm);
+      }
+      else {
+         x86_opcode(&insn, 0x81);
+         x86_modrm(&insn, 3, 7, src1.reg);
+         x86_imm32(&insn, src2.imm);
+      }
+      break;
+
    default:
-      fatal_trace("unhandled operand combination in asm_test");
+      fatal_trace("unhandled operand combination in asm_cmp");
    }
 
    x86_emit(blob, &insn);
@@ -1227,15 +1320,15 @@ static void jit_x86_pop_call_clobbered(code_blob_t *blob)
 
 static x86_operand_t jit_x86_locals(code_blob_t *blob, ptrdiff_t off)
 {
-   const ptrdiff_t locals =
-      FRAME_FIXED_SIZE + blob->func->nregs*8 + blob->func->framesz;
+   const ptrdiff_t locals = FRAME_FIXED_SIZE + blob->func->framesz;
    return ADDR(__EBP, -locals + off);
 }
 
 static x86_operand_t jit_x86_spill_slot(code_blob_t *blob, unsigned slot)
 {
    assert(slot >= STACK_BASE);
-   const ptrdiff_t off = (slot - STACK_BASE) * sizeof(int64_t);
+   // Spill slots grow downwards from the bottom of the local variables
+   const ptrdiff_t off = (slot - STACK_BASE + 1) * sizeof(int64_t);
    return jit_x86_locals(blob, -off);
 }
 
@@ -1332,6 +1425,9 @@ static x86_operand_t jit_x86_get_addr(code_blob_t *blob, jit_value_t addr,
                                       const phys_slot_t *slots)
 {
    switch (addr.kind) {
+   case JIT_VALUE_REG:
+      jit_x86_get_reg(blob, tmp, addr.reg, slots);
+      return ADDR(tmp, 0);
    case JIT_ADDR_REG:
       jit_x86_get_reg(blob, tmp, addr.reg, slots);
       return ADDR(tmp, addr.disp);
@@ -1408,6 +1504,21 @@ static void jit_x86_sext(code_blob_t *blob, x86_operand_t reg, x86_size_t size)
    }
 }
 
+static void jit_x86_zext(code_blob_t *blob, x86_operand_t reg, x86_size_t size)
+{
+   switch (size) {
+   case __BYTE:
+   case __WORD:
+      MOVZX(reg, reg, __QWORD, size);
+      break;
+   case __DWORD:
+      MOV(reg, reg, __DWORD);   // Clears upper 32 bits
+      break;
+   default:
+      break;
+   }
+}
+
 static x86_size_t jit_x86_size(jit_ir_t *ir)
 {
    switch (ir->size) {
@@ -1418,6 +1529,30 @@ static x86_size_t jit_x86_size(jit_ir_t *ir)
    }
 }
 
+static x86_size_t jit_x86_arith_size(jit_ir_t *ir)
+{
+   // The size only matters for setting the overflow or carry flag
+   return ir->cc == JIT_CC_NONE ? __QWORD : jit_x86_size(ir);
+}
+
+static void jit_x86_extend(code_blob_t *blob, jit_ir_t *ir, x86_operand_t reg,
+                           x86_size_t size)
+{
+   // Unsigned operations produce a zero-extended result
+   if (ir->cc == JIT_CC_C)
+      jit_x86_zext(blob, reg, size);
+   else
+      jit_x86_sext(blob, reg, size);
+}
+
+static void jit_x86_sync_irpos(code_blob_t *blob, jit_ir_t *ir)
+{
+   // Keep the frame anchor up to date for stack traces
+   const ptrdiff_t off = offsetof(jit_anchor_t, irpos);
+   const int irpos = ir - blob->func->irbuf;
+   MOV(ADDR(__EBP, ANCHOR_OFFSET + off), IMM(irpos), __DWORD);
+}
+
 #ifdef DEBUG
 __attribute__((unused))
 static void jit_x86_debug_out(code_blob_t *blob, jit_x86_state_t *state,
@@ -1452,30 +1587,38 @@ static void jit_x86_send(code_blob_t *blob, jit_ir_t *ir,
 static void jit_x86_add(code_blob_t *blob, jit_ir_t *ir,
                         const phys_slot_t *slots)
 {
+   const x86_size_t size = jit_x86_arith_size(ir);
+
    jit_x86_get_copy(blob, __EAX, ir->arg1, slots);
    x86_operand_t rhs = jit_x86_get(blob, __ECX, ir->arg2, slots);
-
-   const x86_size_t size = jit_x86_size(ir);
+   if (rhs.kind == X86_IMM && size < __DWORD) {
+      MOV(__ECX, rhs, __QWORD);   // Avoid narrow immediate encodings
+      rhs = __ECX;
+   }
 
    ADD(__EAX, rhs, size);
 
    jit_x86_set_flags(blob, ir);
-   jit_x86_sext(blob, __EAX, size);
+   jit_x86_extend(blob, ir, __EAX, size);
    jit_x86_put(blob, ir->result, __EAX, slots);
 }
 
 static void jit_x86_sub(code_blob_t *blob, jit_ir_t *ir,
                         const phys_slot_t *slots)
 {
+   const x86_size_t size = jit_x86_arith_size(ir);
+
    jit_x86_get_copy(blob, __EAX, ir->arg1, slots);
    x86_operand_t rhs = jit_x86_get(blob, __ECX, ir->arg2, slots);
-
-   const x86_size_t size = jit_x86_size(ir);
+   if (rhs.kind == X86_IMM && size < __DWORD) {
+      MOV(__ECX, rhs, __QWORD);   // Avoid narrow immediate encodings
+      rhs = __ECX;
+   }
 
    SUB(__EAX, rhs, size);
 
    jit_x86_set_flags(blob, ir);
-   jit_x86_sext(blob, __EAX, size);
+   jit_x86_extend(blob, ir, __EAX, size);
    jit_x86_put(blob, ir->result, __EAX, slots);
 }
 
@@ -1485,56 +1628,62 @@ static void jit_x86_mul(code_blob_t *blob, jit_ir_t *ir,
    jit_x86_get_copy(blob, __EAX, ir->arg1, slots);
    jit_x86_get_copy(blob, __ECX, ir->arg2, slots);  // No immediate version
 
-   const x86_size_t size = jit_x86_size(ir);
+   const x86_size_t size = jit_x86_arith_size(ir);
 
-   if (ir->cc == JIT_CC_O)
-      IMUL(__EAX, __ECX, size);
-   else
+   if (size == __BYTE) {
+      // There is no two-operand byte multiply so compute the full
+      // product and check whether it fits in eight bits
+      if (ir->cc == JIT_CC_O) {
+         MOVSX(__EAX, __EAX, __DWORD, __BYTE);
+         MOVSX(__ECX, __ECX, __DWORD, __BYTE);
+         IMUL(__EAX, __ECX, __DWORD);
+         MOVSX(__EDX, __EAX, __DWORD, __BYTE);
+      }
+      else {
+         MOVZX(__EAX, __EAX, __DWORD, __BYTE);
+         MOVZX(__ECX, __ECX, __DWORD, __BYTE);
+         IMUL(__EAX, __ECX, __DWORD);
+         MOVZX(__EDX, __EAX, __DWORD, __BYTE);
+      }
+      CMP(__EAX, __EDX, __DWORD);
+      SETNZ(FLAGS_REG);
+   }
+   else if (ir->cc == JIT_CC_C) {
       MUL(__ECX, size);
+      SETC(FLAGS_REG);
+   }
+   else {
+      IMUL(__EAX, __ECX, size);
+      jit_x86_set_flags(blob, ir);
+   }
 
-   jit_x86_set_flags(blob, ir);
-   jit_x86_sext(blob, __EAX, size);
+   jit_x86_extend(blob, ir, __EAX, size);
    jit_x86_put(blob, ir->result, __EAX, slots);
 }
 
 static void jit_x86_rem(code_blob_t *blob, jit_ir_t *ir,
                         const phys_slot_t *slots)
 {
+   // Operands are already sign extended so the full width division
+   // gives the same result for all sizes
    jit_x86_get_copy(blob, __EAX, ir->arg1, slots);
-   x86_operand_t rhs = jit_x86_get(blob, __ECX, ir->arg2, slots);
-
-   const x86_size_t size = jit_x86_size(ir);
-
-   switch (size) {
-   case __WORD: CWD(); break;
-   case __DWORD: CDQ(); break;
-   default: CQO(); break;
-   }
+   jit_x86_get_copy(blob, __ECX, ir->arg2, slots);  // No immediate version
 
-   IDIV(rhs, size);
-   MOV(__EAX, __EDX, MAX(size, __DWORD));
+   CQO();
+   IDIV(__ECX, __QWORD);
 
-   jit_x86_sext(blob, __EAX, size);
-   jit_x86_put(blob, ir->result, __EAX, slots);
+   jit_x86_put(blob, ir->result, __EDX, slots);
 }
 
 static void jit_x86_div(code_blob_t *blob, jit_ir_t *ir,
                         const phys_slot_t *slots)
 {
    jit_x86_get_copy(blob, __EAX, ir->arg1, slots);
-   x86_operand_t rhs = jit_x86_get(blob, __ECX, ir->arg2, slots);
-
-   const x86_size_t size = jit_x86_size(ir);
-
-   switch (size) {
-   case __WORD: CWD(); break;
-   case __DWORD: CDQ(); break;
-   default: CQO(); break;
-   }
+   jit_x86_get_copy(blob, __ECX, ir->arg2, slots);  // No immediate version
 
-   IDIV(rhs, size);
+   CQO();
+   IDIV(__ECX, __QWORD);
 
-   jit_x86_sext(blob, __EAX, size);
    jit_x86_put(blob, ir->result, __EAX, slots);
 }
 
@@ -1551,10 +1700,10 @@ static void jit_x86_neg(code_blob_t *blob, jit_ir_t *ir,
 static void jit_x86_not(code_blob_t *blob, jit_ir_t *ir,
                         const phys_slot_t *slots)
 {
-   x86_operand_t src = jit_x86_get(blob, __ECX, ir->arg1, slots);
+   jit_x86_get_copy(blob, __ECX, ir->arg1, slots);
 
    XOR(__EAX, __EAX, __DWORD);
-   TEST(src, src, __BYTE);
+   TEST(__ECX, __ECX, __QWORD);
    SETZ(__EAX);
 
    jit_x86_put(blob, ir->result, __EAX, slots);
@@ -1575,9 +1724,9 @@ static void jit_x86_or(code_blob_t *blob, jit_ir_t *ir,
                        const phys_slot_t *slots)
 {
    jit_x86_get_copy(blob, __EAX, ir->arg1, slots);
-   x86_operand_t rhs = jit_x86_get(blob, __ECX, ir->arg2, slots);
+   jit_x86_get_copy(blob, __ECX, ir->arg2, slots);  // No immediate version
 
-   OR(__EAX, rhs, __QWORD);
+   OR(__EAX, __ECX, __QWORD);
 
    jit_x86_put(blob, ir->result, __EAX, slots);
 }
@@ -1586,9 +1735,9 @@ static void jit_x86_xor(code_blob_t *blob, jit_ir_t *ir,
                         const phys_slot_t *slots)
 {
    jit_x86_get_copy(blob, __EAX, ir->arg1, slots);
-   x86_operand_t rhs = jit_x86_get(blob, __ECX, ir->arg2, slots);
+   jit_x86_get_copy(blob, __ECX, ir->arg2, slots);  // No immediate version
 
-   XOR(__EAX, rhs, __QWORD);
+   XOR(__EAX, __ECX, __QWORD);
 
    jit_x86_put(blob, ir->result, __EAX, slots);
 }
@@ -1603,11 +1752,11 @@ static void jit_x86_mov(code_blob_t *blob, jit_ir_t *ir,
 static void jit_x86_clamp(code_blob_t *blob, jit_ir_t *ir,
                           const phys_slot_t *slots)
 {
-   x86_operand_t src = jit_x86_get(blob, __ECX, ir->arg1, slots);
+   jit_x86_get_copy(blob, __ECX, ir->arg1, slots);
 
    XOR(__EAX, __EAX, __DWORD);
-   TEST(src, src, __QWORD);
-   CMOVGT(__EAX, src, __QWORD);
+   TEST(__ECX, __ECX, __QWORD);
+   CMOVGT(__EAX, __ECX, __QWORD);
 
    jit_x86_put(blob, ir->result, __EAX, slots);
 }
@@ -1712,10 +1861,10 @@ static void jit_x86_csel(code_blob_t *blob, jit_ir_t *ir,
                          const phys_slot_t *slots)
 {
    jit_x86_get_copy(blob, __EAX, ir->arg1, slots);
-   x86_operand_t rhs = jit_x86_get(blob, __ECX, ir->arg2, slots);
+   jit_x86_get_copy(blob, __ECX, ir->arg2, slots);  // No immediate version
 
    TEST(FLAGS_REG, FLAGS_REG, __BYTE);
-   CMOVZ(__EAX, rhs, __QWORD);
+   CMOVZ(__EAX, __ECX, __QWORD);
 
    jit_x86_put(blob, ir->result, __EAX, slots);
 }
@@ -1725,6 +1874,8 @@ static void jit_x86_call(code_blob_t *blob, jit_x86_state_t *state,
 {
    jit_func_t *f = jit_get_func(state->jit, ir->arg1.handle);
 
+   jit_x86_sync_irpos(blob, ir);
+
    MOV(__EAX, PTR(f), __QWORD);
    CALL(PTR(state->stubs[CALL_STUB]));
 }
@@ -1737,6 +1888,26 @@ static void jit_x86_shl(code_blob_t *blob, jit_ir_t *ir,
 
    SHL(__EAX, __QWORD);
 
+   // The shift count is masked to six bits by the hardware
+   XOR(__EDX, __EDX, __DWORD);
+   CMP(__ECX, IMM(63), __QWORD);
+   CMOVA(__EAX, __EDX, __QWORD);
+
+   jit_x86_put(blob, ir->result, __EAX, slots);
+}
+
+static void jit_x86_shr(code_blob_t *blob, jit_ir_t *ir,
+                        const phys_slot_t *slots)
+{
+   jit_x86_get_copy(blob, __EAX, ir->arg1, slots);
+   jit_x86_get_copy(blob, __ECX, ir->arg2, slots);
+
+   SHR(__EAX, __QWORD);
+
+   XOR(__EDX, __EDX, __DWORD);
+   CMP(__ECX, IMM(63), __QWORD);
+   CMOVA(__EAX, __EDX, __QWORD);
+
    jit_x86_put(blob, ir->result, __EAX, slots);
 }
 
@@ -1746,6 +1917,11 @@ static void jit_x86_asr(code_blob_t *blob, jit_ir_t *ir,
    jit_x86_get_copy(blob, __EAX, ir->arg1, slots);
    jit_x86_get_copy(blob, __ECX, ir->arg2, slots);
 
+   // Shifting by 63 or more fills the result with the sign bit
+   MOV(__EDX, IMM(63), __DWORD);
+   CMP(__ECX, __EDX, __QWORD);
+   CMOVGT(__ECX, __EDX, __QWORD);
+
    SAR(__EAX, __ECX, __QWORD);
 
    jit_x86_put(blob, ir->result, __EAX, slots);
@@ -1843,6 +2019,16 @@ static void jit_x86_fcmp(code_blob_t *blob, jit_ir_t *ir,
    }
 }
 
+static void jit_x86_fccmp(code_blob_t *blob, jit_ir_t *ir,
+                          const phys_slot_t *slots)
+{
+   MOV(__EDX, FLAGS_REG, __DWORD);
+
+   jit_x86_fcmp(blob, ir, slots);
+
+   AND(FLAGS_REG, __EDX, __BYTE);
+}
+
 static void jit_x86_fcvtns(code_blob_t *blob, jit_x86_state_t *state,
                            jit_ir_t *ir, const phys_slot_t *slots)
 {
@@ -1871,6 +2057,8 @@ static void jit_x86_scvtf(code_blob_t *blob, jit_ir_t *ir,
 static void jit_x86_macro_exit(code_blob_t *blob, jit_x86_state_t *state,
                                jit_ir_t *ir)
 {
+   jit_x86_sync_irpos(blob, ir);
+
    MOV(__EAX, IMM(ir->arg1.exit), __DWORD);
    CALL(PTR(state->stubs[EXIT_STUB]));
 
@@ -1894,6 +2082,7 @@ static void jit_x86_macro_salloc(code_blob_t *blob, jit_ir_t *ir,
 static void jit_x86_macro_lalloc(code_blob_t *blob, jit_x86_state_t *state,
                                  jit_ir_t *ir, const phys_slot_t *slots)
 {
+   jit_x86_sync_irpos(blob, ir);
    jit_x86_get_copy(blob, __EAX, ir->arg1, slots);
 
    CALL(PTR(state->stubs[TLAB_STUB]));
@@ -1904,6 +2093,7 @@ static void jit_x86_macro_lalloc(code_blob_t *blob, jit_x86_state_t *state,
 static void jit_x86_macro_galloc(code_blob_t *blob, jit_x86_state_t *state,
                                  jit_ir_t *ir, const phys_slot_t *slots)
 {
+   jit_x86_sync_irpos(blob, ir);
    jit_x86_get_copy(blob, __EAX, ir->arg1, slots);
 
    CALL(PTR(state->stubs[ALLOC_STUB]));
@@ -2031,9 +2221,72 @@ static void jit_x86_macro_case(code_blob_t *blob, jit_ir_t *ir,
    code_blob_patch(blob, ir->arg2.label, jit_x86_patch);
 }
 
+static int64_t jit_x86_exp_overflow(int64_t x, int64_t y, int64_t mode,
+                                    int64_t *flags)
+{
+   const jit_size_t size = mode & 0xff;
+   const bool is_unsigned = (mode >> 8) == JIT_CC_C;
+
+   int overflow = 0, xo = 0;
+   int64_t result = 0;
+
+#define EXP_OVERFLOW(type) do {                                         \
+      type xt = x, yt = y, r = 1;                                       \
+      while (yt) {                                                      \
+         if (yt & 1)                                                    \
+            overflow |= xo || __builtin_mul_overflow(r, xt, &r);        \
+         yt >>= 1;                                                      \
+         xo |= __builtin_mul_overflow(xt, xt, &xt);                     \
+      }                                                                 \
+      result = r;                                                       \
+   } while (0)
+
+   switch (size) {
+   case JIT_SZ_8:
+      if (is_unsigned) EXP_OVERFLOW(uint8_t); else EXP_OVERFLOW(int8_t);
+      break;
+   case JIT_SZ_16:
+      if (is_unsigned) EXP_OVERFLOW(uint16_t); else EXP_OVERFLOW(int16_t);
+      break;
+   case JIT_SZ_32:
+      if (is_unsigned) EXP_OVERFLOW(uint32_t); else EXP_OVERFLOW(int32_t);
+      break;
+   default:
+      if (is_unsigned) EXP_OVERFLOW(uint64_t); else EXP_OVERFLOW(int64_t);
+      break;
+   }
+
+#undef EXP_OVERFLOW
+
+   *flags = overflow;
+   return result;
+}
+
 static void jit_x86_macro_exp(code_blob_t *blob, jit_ir_t *ir,
                               const phys_slot_t *slots)
 {
+   if (ir->cc != JIT_CC_NONE) {
+      // Checking for overflow at each step is rare enough that it is
+      // not worth generating inline
+      jit_x86_push_call_clobbered(blob);
+      SUB(__ESP, IMM(16), __QWORD);
+
+      jit_x86_get_copy(blob, CARG0_REG, ir->arg1, slots);
+      jit_x86_get_copy(blob, CARG1_REG, ir->arg2, slots);
+      MOV(CARG2_REG, IMM((ir->cc << 8) | ir->size), __DWORD);
+      MOV(CARG3_REG, __ESP, __QWORD);
+
+      MOV(__EAX, PTR(jit_x86_exp_overflow), __QWORD);
+      CALL(__EAX);
+
+      POP(FLAGS_REG);
+      ADD(__ESP, IMM(8), __QWORD);
+      jit_x86_pop_call_clobbered(blob);
+
+      jit_x86_put(blob, ir->result, __EAX, slots);
+      return;
+   }
+
    jit_x86_get_copy(blob, __EDI, ir->arg1, slots);
    jit_x86_get_copy(blob, __ECX, ir->arg2, slots);
 
@@ -2068,6 +2321,94 @@ static void jit_x86_macro_trim(code_blob_t *blob, jit_ir_t *ir)
    MOV(ADDR(TLAB_REG, offsetof(tlab_t, alloc)), __EAX, __DWORD);
 }
 
+static void jit_x86_macro_reexec(code_blob_t *blob, jit_ir_t *ir)
+{
+   // Tail call the new entry point with the caller's anchor
+   MOV(CARG0_REG, ADDR(__EBP, ANCHOR_OFFSET + 8), __QWORD);
+   MOV(CARG1_REG, ADDR(__EBP, ANCHOR_OFFSET), __QWORD);
+   MOV(CARG2_REG, ARGS_REG, __QWORD);
+   MOV(CARG3_REG, TLAB_REG, __QWORD);
+
+   MOV(__EAX, ADDR(CARG0_REG, offsetof(jit_func_t, entry)), __QWORD);
+   CALL(__EAX);
+
+   jit_x86_ret(blob, ir);
+}
+
+static void jit_x86_macro_sadd(code_blob_t *blob, jit_ir_t *ir,
+                               const phys_slot_t *slots)
+{
+   jit_x86_get_copy(blob, __EDX, ir->arg2, slots);
+   x86_operand_t addr = jit_x86_get_addr(blob, ir->arg1, __ECX, slots);
+
+   const x86_size_t size = jit_x86_size(ir);
+
+   if (size == __QWORD) {
+      MOV(__EAX, addr, __QWORD);
+      ADD(__EAX, __EDX, __QWORD);
+      MOV(__EDI, IMM(-1), __QWORD);
+      CMOVC(__EAX, __EDI, __QWORD);
+   }
+   else {
+      // Add at full width and clamp to the largest unsigned value
+      MOVZX(__EAX, addr, __QWORD, size);
+      ADD(__EAX, __EDX, __QWORD);
+      MOV(__EDI, IMM(UINT64_MAX >> (64 - size*8)), __QWORD);
+      CMP(__EAX, __EDI, __QWORD);
+      CMOVA(__EAX, __EDI, __QWORD);
+   }
+
+   MOV(addr, __EAX, size);
+}
+
+static void jit_x86_macro_pack(code_blob_t *blob, jit_ir_t *ir,
+                               const phys_slot_t *slots)
+{
+   jit_x86_push_call_clobbered(blob);
+
+   jit_x86_get_copy(blob, CARG0_REG, ir->arg1, slots);
+   jit_x86_get_copy(blob, CARG1_REG, ir->arg2, slots);
+   MOV(CARG2_REG, ARGS_REG, __QWORD);
+
+   MOV(__EAX, PTR(__nvc_pack), __QWORD);
+   CALL(__EAX);
+
+   jit_x86_pop_call_clobbered(blob);
+}
+
+static void jit_x86_macro_unpack(code_blob_t *blob, jit_ir_t *ir,
+                                 const phys_slot_t *slots)
+{
+   jit_x86_push_call_clobbered(blob);
+
+   jit_x86_get_copy(blob, CARG0_REG, ir->arg1, slots);
+   jit_x86_get_copy(blob, CARG1_REG, ir->arg2, slots);
+   MOV(CARG2_REG, ARGS_REG, __QWORD);
+
+   MOV(__EAX, PTR(__nvc_unpack), __QWORD);
+   CALL(__EAX);
+
+   jit_x86_pop_call_clobbered(blob);
+}
+
+static void jit_x86_macro_vec4op(code_blob_t *blob, jit_ir_t *ir,
+                                 const phys_slot_t *slots)
+{
+   jit_x86_sync_irpos(blob, ir);
+
+   jit_x86_push_call_clobbered(blob);
+
+   jit_x86_get_copy(blob, CARG0_REG, ir->arg1, slots);
+   LEA(CARG1_REG, ADDR(__EBP, ANCHOR_OFFSET));
+   MOV(CARG2_REG, ARGS_REG, __QWORD);
+   jit_x86_get_copy(blob, CARG3_REG, ir->arg2, slots);
+
+   MOV(__EAX, PTR(__nvc_vec4op), __QWORD);
+   CALL(__EAX);
+
+   jit_x86_pop_call_clobbered(blob);
+}
+
 static void jit_x86_op(code_blob_t *blob, jit_x86_state_t *state, jit_ir_t *ir,
                        const phys_slot_t *slots)
 {
@@ -2153,6 +2494,9 @@ static void jit_x86_op(code_blob_t *blob, jit_x86_state_t *state, jit_ir_t *ir,
    case J_SHL:
       jit_x86_shl(blob, ir, slots);
       break;
+   case J_SHR:
+      jit_x86_shr(blob, ir, slots);
+      break;
    case J_ASR:
       jit_x86_asr(blob, ir, slots);
       break;
@@ -2177,6 +2521,9 @@ static void jit_x86_op(code_blob_t *blob, jit_x86_state_t *state, jit_ir_t *ir,
    case J_FCMP:
       jit_x86_fcmp(blob, ir, slots);
       break;
+   case J_FCCMP:
+      jit_x86_fccmp(blob, ir, slots);
+      break;
    case J_FCVTNS:
       jit_x86_fcvtns(blob, state, ir, slots);
       break;
@@ -2225,12 +2572,193 @@ static void jit_x86_op(code_blob_t *blob, jit_x86_state_t *state, jit_ir_t *ir,
    case MACRO_TRIM:
       jit_x86_macro_trim(blob, ir);
       break;
+   case MACRO_REEXEC:
+      jit_x86_macro_reexec(blob, ir);
+      break;
+   case MACRO_SADD:
+      jit_x86_macro_sadd(blob, ir, slots);
+      break;
+   case MACRO_PACK:
+      jit_x86_macro_pack(blob, ir, slots);
+      break;
+   case MACRO_UNPACK:
+      jit_x86_macro_unpack(blob, ir, slots);
+      break;
+   case MACRO_VEC4OP:
+      jit_x86_macro_vec4op(blob, ir, slots);
+      break;
    default:
       jit_dump_with_mark(blob->func, ir - blob->func->irbuf);
       fatal_trace("unhandled opcode %s in x86 backend", jit_op_name(ir->op));
    }
 }
 
+static bool jit_x86_can_compile(jit_func_t *f)
+{
+   for (int i = 0; i < f->nirs; i++) {
+      const jit_ir_t *ir = &(f->irbuf[i]);
+      switch (ir->op) {
+      case MACRO_VEC2OP:
+         return false;
+      case J_CALL:
+         // The interpreter reports the missing definition
+         if (ir->arg1.handle == JIT_HANDLE_INVALID)
+            return false;
+         break;
+      default:
+         break;
+      }
+   }
+
+   return true;
+}
+
+static void jit_x86_prologue(code_blob_t *blob, jit_x86_state_t *state,
+                             size_t framesz, bool count)
+{
+   PUSH(__EBP);
+   MOV(__EBP, __ESP, __QWORD);
+
+   SUB(__ESP, IMM(framesz), __QWORD);
+
+   // Callee saves
+   MOV(ADDR(__EBP, -32), __EBX, __QWORD);
+#ifdef __MINGW32__
+   MOV(ADDR(__EBP, -40), __EDI, __QWORD);
+   MOV(ADDR(__EBP, -48), __ESI, __QWORD);
+#endif
+#if 0
+   // Not currently used
+   MOV(ADDR(__EBP, -56), __R12, __QWORD);
+   MOV(ADDR(__EBP, -64), __R13, __QWORD);
+   MOV(ADDR(__EBP, -72), __R14, __QWORD);
+   MOV(ADDR(__EBP, -80), __R15, __QWORD);
+#endif
+
+   XOR(FLAGS_REG, FLAGS_REG, __DWORD);
+
+   // Shuffle incoming arguments
+   MOV(ARGS_REG, CARG2_REG, __QWORD);
+   MOV(TLAB_REG, CARG3_REG, __QWORD);
+
+   // Build frame anchor
+   MOV(ADDR(__EBP, -24), CARG1_REG, __QWORD);
+   MOV(ADDR(__EBP, -16), CARG0_REG, __QWORD);
+   MOV(ADDR(__EBP, -8), FLAGS_REG, __DWORD);
+   MOV(__EAX, ADDR(TLAB_REG, offsetof(tlab_t, alloc)), __DWORD);
+   MOV(ADDR(__EBP, -4), __EAX, __DWORD);
+
+   STATIC_ASSERT(ANCHOR_OFFSET == -24);
+
+   if (count) {
+      // Count calls until the function is hot enough for the next tier
+      const int hotness_off = offsetof(jit_func_t, hotness);
+      const int heat_off = offsetof(jit_func_t, heat);
+      MOV(__EAX, ADDR(__EBP, -16), __QWORD);
+      MOV(__ECX, ADDR(__EAX, offsetof(jit_func_t, next_tier)), __QWORD);
+      TEST(__ECX, __ECX, __QWORD);
+      JZ(IMM((is_imm8(heat_off) ? 4 : 7) + (is_imm8(hotness_off) ? 4 : 7) + 7));
+      ADD(ADDR(__EAX, heat_off), IMM(1), __DWORD);
+      SUB(ADDR(__EAX, hotness_off), IMM(1), __DWORD);
+      JNZ(IMM(5));
+      CALL(PTR(state->stubs[TIER_STUB]));
+   }
+}
+
+static bool jit_x86_is_loop_header(jit_func_t *f, int pos)
+{
+   // Must match the back edges where the interpreter may transfer
+   // control to the OSR entry point
+   if (!f->irbuf[pos].target)
+      return false;
+
+   for (int i = pos; i < f->nirs; i++) {
+      const jit_ir_t *ir = &(f->irbuf[i]);
+      if (ir->op == J_JUMP && ir->arg1.label == pos)
+         return true;
+      else if (ir->op == MACRO_CASE && ir->arg2.label == pos)
+         return true;
+   }
+
+   return false;
+}
+
+static void jit_x86_osr_entry(code_blob_t *blob, jit_x86_state_t *state,
+                              size_t framesz, const phys_slot_t *slots)
+{
+   jit_func_t *f = blob->func;
+
+   // The interpreter passes its register file, the IR position of the
+   // loop header, the flags, and its TLAB watermark in the argument array
+   jit_x86_prologue(blob, state, framesz, false);
+
+   MOV(__EAX, ADDR(ARGS_REG, 0), __QWORD);
+   MOV(__ECX, ADDR(ARGS_REG, 8), __DWORD);
+   MOV(FLAGS_REG, ADDR(ARGS_REG, 16), __DWORD);
+   MOV(__EDX, ADDR(ARGS_REG, 24), __DWORD);
+   MOV(ADDR(__EBP, -4), __EDX, __DWORD);
+
+   jit_cfg_t *cfg = jit_get_cfg(f);
+
+   // Landing pads use labels after the last IR position
+   const jit_label_t padbase = f->nirs + 1;
+
+   for (int i = 0; i < cfg->nblocks; i++) {
+      if (!jit_x86_is_loop_header(f, cfg->blocks[i].first))
+         continue;
+
+      // The interpreter reports the position of the first instruction
+      // it executes which skips over any leading no-ops
+      int pos = cfg->blocks[i].first;
+      while (f->irbuf[pos].op == J_NOP || f->irbuf[pos].op == J_DEBUG)
+         pos++;
+
+      CMP(__ECX, IMM(pos), __DWORD);
+      JZ(PATCH(INT32_MAX));
+      code_blob_patch(blob, padbase + i, jit_x86_patch);
+   }
+
+   INT3();
+
+   for (int i = 0; i < cfg->nblocks; i++) {
+      jit_block_t *b = &(cfg->blocks[i]);
+      if (!jit_x86_is_loop_header(f, b->first))
+         continue;
+
+      code_blob_mark(blob, padbase + i);
+
+      // Only copy registers live into the loop as physical registers
+      // and spill slots may be shared between disjoint intervals
+      for (size_t bit = -1; mask_iter(&b->livein, &bit) && bit < f->nregs;) {
+         MOV(__EDX, ADDR(__EAX, bit * sizeof(jit_scalar_t)), __QWORD);
+         jit_x86_put(blob, bit, __EDX, slots);
+      }
+
+      JMP(PATCH(INT32_MAX));
+      code_blob_patch(blob, b->first, jit_x86_patch);
+   }
+
+   jit_free_cfg(cfg);
+}
+
+static bool jit_x86_can_osr(jit_func_t *f)
+{
+   // Pointers into the interpreter's local variable frame cannot be
+   // relocated so only functions without stack allocations are entered
+   if (f->framesz > 0)
+      return false;
+
+   for (int i = 0; i < f->nirs; i++) {
+      const jit_ir_t *ir = &(f->irbuf[i]);
+      if (ir->op == J_JUMP && ir->arg1.label <= i)
+         return true;
+      else if (ir->op == MACRO_CASE && ir->arg2.label <= i)
+         return true;
+   }
+
+   return false;
+}
+
 static void jit_x86_cgen(jit_t *j, jit_handle_t handle, void *context)
 {
    jit_x86_state_t *state = context;
@@ -2243,6 +2771,9 @@ static void jit_x86_cgen(jit_t *j, jit_handle_t handle, void *context)
       return;
 #endif
 
+   if (!jit_x86_can_compile(f))
+      return;
+
    code_blob_t *blob = code_blob_new(state->code, f->name, 0);
    if (blob == NULL)
       return;
@@ -2254,9 +2785,6 @@ static void jit_x86_cgen(jit_t *j, jit_handle_t handle, void *context)
    phys_slot_t *slots LOCAL = xmalloc_array(f->nregs, sizeof(phys_slot_t));
    const int spills = jit_do_lscan(f, slots, ~allowmask);
 
-   PUSH(__EBP);
-   MOV(__EBP, __ESP, __QWORD);
-
    // Frame layout
    //
    //       |-------------------|
@@ -2287,36 +2815,8 @@ static void jit_x86_cgen(jit_t *j, jit_handle_t handle, void *context)
    const size_t framebytes =
       f->framesz + spills * sizeof(int64_t) + FRAME_FIXED_SIZE;
    const size_t framesz = ALIGN_UP(framebytes, 16);
-   SUB(__ESP, IMM(framesz*2), __QWORD);
 
-   // Callee saves
-   MOV(ADDR(__EBP, -32), __EBX, __QWORD);
-#ifdef __MINGW32__
-   MOV(ADDR(__EBP, -40), __EDI, __QWORD);
-   MOV(ADDR(__EBP, -48), __ESI, __QWORD);
-#endif
-#if 0
-   // Not currently used
-   MOV(ADDR(__EBP, -56), __R12, __QWORD);
-   MOV(ADDR(__EBP, -64), __R13, __QWORD);
-   MOV(ADDR(__EBP, -72), __R14, __QWORD);
-   MOV(ADDR(__EBP, -80), __R15, __QWORD);
-#endif
-
-   XOR(FLAGS_REG, FLAGS_REG, __DWORD);
-
-   // Shuffle incoming arguments
-   MOV(ARGS_REG, CARG2_REG, __QWORD);
-   MOV(TLAB_REG, CARG3_REG, __QWORD);
-
-   // Build frame anchor
-   MOV(ADDR(__EBP, -24), CARG1_REG, __QWORD);
-   MOV(ADDR(__EBP, -16), CARG0_REG, __QWORD);
-   MOV(ADDR(__EBP, -8), FLAGS_REG, __DWORD);
-   MOV(__EAX, ADDR(TLAB_REG, offsetof(tlab_t, alloc)), __DWORD);
-   MOV(ADDR(__EBP, -4), __EAX, __DWORD);
-
-   STATIC_ASSERT(ANCHOR_OFFSET == -24);
+   jit_x86_prologue(blob, state, framesz, true);
 
    for (int i = 0; i < f->nirs; i++) {
       if (f->irbuf[i].target)
@@ -2342,7 +2842,26 @@ static void jit_x86_cgen(jit_t *j, jit_handle_t handle, void *context)
    LEAVE();
    RET();
 
-   code_blob_finalise(blob, &(f->entry));
+   uint8_t *osr = NULL;
+   if (jit_x86_can_osr(f)) {
+      code_blob_align(blob, 16);
+      osr = blob->wptr;
+      jit_x86_osr_entry(blob, state, framesz, slots);
+   }
+
+   jit_entry_fn_t entry = NULL;
+   code_blob_finalise(blob, &entry);
+
+   if (entry == NULL)
+      return;
+
+   // Interpreter activations looping in this function can now jump
+   // into the compiled code
+   if (osr != NULL)
+      store_release(&(f->osr_entry), (jit_entry_fn_t)osr);
+
+   // Only replace the interpreter as a later tier may have finished first
+   atomic_cas(&(f->entry), jit_interp, entry);
 }
 
 static void jit_x86_gen_exit_stub(jit_x86_state_t *state)
@@ -2355,7 +2874,7 @@ static void jit_x86_gen_exit_stub(jit_x86_state_t *state)
    jit_x86_push_call_clobbered(blob);
 
    // Exit number in EAX
-   MOV(CARG0_REG, __EAX, __DWORD);
+   MOV(CARG0_REG, __EAX, __QWORD);
    LEA(CARG1_REG, ADDR(__EBP, ANCHOR_OFFSET));
    MOV(CARG2_REG, ARGS_REG, __QWORD);
    MOV(CARG3_REG, TLAB_REG, __QWORD);
@@ -2406,7 +2925,7 @@ static void jit_x86_gen_alloc_stub(jit_x86_state_t *state)
    jit_x86_push_call_clobbered(blob);
 
    // Size in EAX
-   MOV(CARG0_REG, __EAX, __DWORD);
+   MOV(CARG0_REG, __EAX, __QWORD);
    LEA(CARG1_REG, ADDR(__EBP, ANCHOR_OFFSET));
 
    MOV(__EAX, PTR(__nvc_mspace_alloc), __QWORD);
@@ -2427,14 +2946,16 @@ static void jit_x86_gen_tlab_stub(jit_x86_state_t *state)
 
    // Fast path: allocate from TLAB
 
+   // Use 64-bit arithmetic as the requested size may not fit in 32 bits
    MOV(__ECX, ADDR(TLAB_REG, offsetof(tlab_t, alloc)), __DWORD);
    MOV(__EDI, __ECX, __DWORD);
-   ADD(__EDI, __EAX, __DWORD);
-   ADD(__EDI, IMM(RT_ALIGN_MASK), __DWORD);
-   AND(__EDI, IMM(~RT_ALIGN_MASK), __DWORD);
+   ADD(__EDI, __EAX, __QWORD);
+   ADD(__EDI, IMM(RT_ALIGN_MASK), __QWORD);
+   AND(__EDI, IMM(~RT_ALIGN_MASK), __QWORD);
 
-   CMP(ADDR(TLAB_REG, offsetof(tlab_t, limit)), __EDI, __DWORD);
-   JLT(IMM(12));
+   MOV(__EDX, ADDR(TLAB_REG, offsetof(tlab_t, limit)), __DWORD);
+   CMP(__EDX, __EDI, __QWORD);
+   JB(IMM(12));
 
    MOV(ADDR(TLAB_REG, offsetof(tlab_t, alloc)), __EDI, __DWORD);
    LEA(__EAX, ADDR(TLAB_REG, offsetof(tlab_t, data)));
@@ -2447,7 +2968,7 @@ static void jit_x86_gen_tlab_stub(jit_x86_state_t *state)
 
    jit_x86_push_call_clobbered(blob);
 
-   MOV(CARG0_REG, __EAX, __DWORD);
+   MOV(CARG0_REG, __EAX, __QWORD);
    LEA(CARG1_REG, ADDR(__EBP, ANCHOR_OFFSET));
 
    MOV(__EAX, PTR(__nvc_mspace_alloc), __QWORD);
@@ -2526,6 +3047,29 @@ static void jit_x86_gen_round_stub(jit_x86_state_t *state)
    code_blob_finalise(blob, &(state->stubs[ROUND_STUB]));
 }
 
+static void jit_x86_gen_tier_stub(jit_x86_state_t *state)
+{
+   ident_t name = ident_new("tier stub");
+   code_blob_t *blob = code_blob_new(state->code, name, 0);
+
+   SUB(__ESP, IMM(8), __QWORD);   // Ensure stack aligned
+
+   jit_x86_push_call_clobbered(blob);
+
+   // Function pointer in EAX
+   MOV(CARG0_REG, __EAX, __QWORD);
+
+   MOV(__EAX, PTR(jit_tier_up), __QWORD);
+   CALL(__EAX);
+
+   jit_x86_pop_call_clobbered(blob);
+
+   ADD(__ESP, IMM(8), __QWORD);
+   RET();
+
+   code_blob_finalise(blob, &(state->stubs[TIER_STUB]));
+}
+
 static void *jit_x86_init(jit_t *jit)
 {
    jit_x86_state_t *state = xcalloc(sizeof(jit_x86_state_t));
@@ -2537,6 +3081,7 @@ static void *jit_x86_init(jit_t *jit)
    jit_x86_gen_alloc_stub(state);
    jit_x86_gen_tlab_stub(state);
    jit_x86_gen_fexp_stub(state);
+   jit_x86_gen_tier_stub(state);
    DEBUG_ONLY(jit_x86_gen_debug_stub(state));
 
    if (!__builtin_cpu_supports("sse4.1"))
@@ -2561,9 +3106,9 @@ static const jit_plugin_t jit_x86 = {
 
 void jit_register_native_plugin(jit_t *j)
 {
-   const int threshold = opt_get_int(OPT_JIT_THRESHOLD);
+   const int threshold = opt_get_int(OPT_JIT_BASELINE);
    if (threshold > 0)
       jit_add_tier(j, threshold, &jit_x86);
    else if (threshold < 0)
-      warnf("invalid NVC_JIT_THRESOLD setting %d", threshold);
+      warnf("invalid NVC_JIT_BASELINE setting %d", threshold);
 }
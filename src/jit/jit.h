@@ -36,6 +36,7 @@ STATIC_ASSERT(sizeof(jit_scalar_t) == 8);
 typedef struct {
    void *(*init)(jit_t *);
    void (*cgen)(jit_t *, jit_handle_t, void *);
+   bool (*load)(jit_t *, jit_handle_t, void *);
    void (*cleanup)(void *);
 } jit_plugin_t;
 
@@ -64,6 +65,7 @@ mspace_t *jit_get_mspace(jit_t *j);
 bool jit_exit_status(jit_t *j, int *status);
 void jit_reset_exit_status(jit_t *j);
 void jit_add_tier(jit_t *j, int threshold, const jit_plugin_t *plugin);
+void jit_precompile(jit_t *j);
 ident_t jit_get_name(jit_t *j, jit_handle_t handle);
 object_t *jit_get_object(jit_t *j, jit_handle_t handle);
 void jit_register_native_plugin(jit_t *j);
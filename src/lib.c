@@ -41,13 +41,20 @@
 #include <fcntl.h>
 #include <sys/types.h>
 #include <sys/time.h>
+#include <utime.h>
 
 typedef struct _search_path search_path_t;
 typedef struct _lib_index   lib_index_t;
 typedef struct _lib_list    lib_list_t;
 typedef struct _lib_unit    lib_unit_t;
+typedef struct _lib_source  lib_source_t;
 
-#define INDEX_FILE_MAGIC 0x55225511
+#define INDEX_FILE_MAGIC   0x55225511
+#define SOURCES_FILE_MAGIC 0x55225512
+
+// Flags stored in the unit metadata record
+#define META_NO_COLLAPSE (1 << 0)
+#define META_AOT         (1 << 1)
 
 struct _lib_unit {
    object_t     *object;
@@ -66,6 +73,25 @@ struct _lib_index {
    lib_index_t *next;
 };
 
+typedef struct {
+   ident_t  name;
+   uint32_t checksum;
+} lib_dep_t;
+
+typedef struct {
+   ident_t       name;
+   uint32_t      checksum;
+   A(lib_dep_t)  deps;
+} lib_source_unit_t;
+
+// Design units analysed from each source file with the checksums of
+// their dependencies, used to skip unchanged files with --incremental
+struct _lib_source {
+   ident_t                  path;
+   uint64_t                 hash;
+   A(lib_source_unit_t)     units;
+};
+
 struct _lib {
    char         *path;
    ident_t       name;
@@ -76,6 +102,8 @@ struct _lib {
    off_t         index_size;
    int           lock_fd;
    bool          readonly;
+   hash_t       *sources;
+   hash_t       *owners;
 };
 
 struct _lib_list {
@@ -94,6 +122,7 @@ static lib_list_t    *loaded = NULL;
 static search_path_t *search_paths = NULL;
 
 static text_buf_t *lib_file_path(lib_t lib, const char *name);
+static void lib_free_sources(lib_t lib);
 
 static const char *standard_suffix(vhdl_standard_t std)
 {
@@ -225,6 +254,23 @@ static bool lib_name_cmp(const void *a, const void *b)
       return false;
 }
 
+static void lib_open_lock(lib_t lib)
+{
+   LOCAL_TEXT_BUF lock_path = lib_file_path(lib, "_NVC_LIB");
+
+   // Try to open the lock file read-write as this is required for
+   // exlusive locking on some NFS implementations
+   if ((lib->lock_fd = open(tb_get(lock_path), O_RDWR)) < 0
+       && (errno == EACCES || errno == EPERM || errno == EROFS)) {
+      // Try again in read-only mode
+      lib->lock_fd = open(tb_get(lock_path), O_RDONLY);
+      lib->readonly = true;
+   }
+
+   if (lib->lock_fd < 0)
+      fatal_errno("open: %s", tb_get(lock_path));
+}
+
 static lib_t lib_init(const char *name, const char *rpath, int lock_fd)
 {
    lib_t l = xcalloc(sizeof(struct _lib));
@@ -254,20 +300,7 @@ static lib_t lib_init(const char *name, const char *rpath, int lock_fd)
       debugf("library %s at %s", istr(l->name), l->path);
 
    if (l->lock_fd == -1 && rpath != NULL) {
-      LOCAL_TEXT_BUF lock_path = lib_file_path(l, "_NVC_LIB");
-
-      // Try to open the lock file read-write as this is required for
-      // exlusive locking on some NFS implementations
-      if ((l->lock_fd = open(tb_get(lock_path), O_RDWR)) < 0
-          && (errno == EACCES || errno == EPERM || errno == EROFS)) {
-         // Try again in read-only mode
-         l->lock_fd = open(tb_get(lock_path), O_RDONLY);
-         l->readonly = true;
-      }
-
-      if (l->lock_fd < 0)
-         fatal_errno("open: %s", tb_get(lock_path));
-
+      lib_open_lock(l);
       file_read_lock(l->lock_fd);
    }
 
@@ -743,10 +776,33 @@ void lib_free(lib_t lib)
    }
    ghash_free(lib->lookup);
 
+   lib_free_sources(lib);
+
    free(lib->path);
    free(lib);
 }
 
+void lib_reopen(lib_t lib)
+{
+   // A forked child shares the open file description with its parent
+   // and so also shares the lock: open the lock file again to get an
+   // independent lock
+   assert(lib->lock_fd != -1);
+   close(lib->lock_fd);
+   lib_open_lock(lib);
+
+   lib_free_sources(lib);   // Read again when next needed
+}
+
+void lib_refresh(lib_t lib)
+{
+   // Pick up units saved by another process
+   assert(lib->lock_fd != -1);
+   file_read_lock(lib->lock_fd);
+   lib_read_index(lib);
+   file_unlock(lib->lock_fd);
+}
+
 void lib_destroy(lib_t lib)
 {
    // This is convenience function for testing: remove all
@@ -855,7 +911,9 @@ static void lib_read_meta(fbuf_t *f, unit_meta_t *meta)
       read_raw(meta->cover_file, len + 1, f);
    }
 
-   meta->no_collapse = fbuf_get_uint(f);
+   const unsigned flags = fbuf_get_uint(f);
+   meta->no_collapse = !!(flags & META_NO_COLLAPSE);
+   meta->aot         = !!(flags & META_AOT);
 }
 
 static lib_unit_t *lib_read_unit(lib_t lib, ident_t id)
@@ -1067,6 +1125,10 @@ static void lib_save_unit(lib_t lib, lib_unit_t *unit)
    if (f == NULL)
       fatal("failed to create %s in library %s", tb_get(tb), istr(lib->name));
 
+   // Units are read on every elaboration and simulation so favour
+   // decompression speed over file size
+   fbuf_set_zip(f, FBUF_ZIP_LZ4);
+
    write_u8('T', f);
 
    ident_wr_ctx_t ident_ctx = ident_write_begin(f);
@@ -1076,7 +1138,8 @@ static void lib_save_unit(lib_t lib, lib_unit_t *unit)
 
    object_write(unit->object, f, ident_ctx, loc_ctx);
 
-   if (unit->meta.cover_file != NULL || unit->meta.no_collapse) {
+   if (unit->meta.cover_file != NULL || unit->meta.no_collapse
+       || unit->meta.aot) {
       write_u8('M', f);
 
       if (unit->meta.cover_file != NULL) {
@@ -1087,7 +1150,11 @@ static void lib_save_unit(lib_t lib, lib_unit_t *unit)
       else
          fbuf_put_uint(f, 0);
 
-      fbuf_put_uint(f, unit->meta.no_collapse);
+      unsigned flags = 0;
+      if (unit->meta.no_collapse) flags |= META_NO_COLLAPSE;
+      if (unit->meta.aot) flags |= META_AOT;
+
+      fbuf_put_uint(f, flags);
    }
 
    write_u8('\0', f);
@@ -1104,6 +1171,292 @@ static void lib_save_unit(lib_t lib, lib_unit_t *unit)
    unit->dirty = false;
 }
 
+static uint64_t lib_hash_source(const char *file)
+{
+   // 64-bit FNV-1a hash of the file contents, zero if it cannot be read
+   const int fd = open(file, O_RDONLY);
+   if (fd < 0)
+      return 0;
+
+   file_info_t info;
+   if (!get_handle_info(fd, &info)) {
+      close(fd);
+      return 0;
+   }
+
+   uint64_t hash = UINT64_C(14695981039346656037);
+
+   if (info.size > 0) {
+      const uint8_t *map = map_file(fd, info.size);
+      for (size_t i = 0; i < info.size; i++)
+         hash = (hash ^ map[i]) * UINT64_C(1099511628211);
+      unmap_file((void *)map, info.size);
+   }
+
+   close(fd);
+   return hash ?: 1;
+}
+
+static void lib_free_sources(lib_t lib)
+{
+   if (lib->sources == NULL)
+      return;
+
+   const void *key;
+   void *value;
+   for (hash_iter_t it = HASH_BEGIN; hash_iter(lib->sources, &it, &key, &value); ) {
+      lib_source_t *src = value;
+      for (int i = 0; i < src->units.count; i++)
+         ACLEAR(src->units.items[i].deps);
+      ACLEAR(src->units);
+      free(src);
+   }
+
+   hash_free(lib->sources);
+   hash_free(lib->owners);
+
+   lib->sources = NULL;
+   lib->owners = NULL;
+}
+
+static lib_source_t *lib_get_source(lib_t lib, ident_t path)
+{
+   lib_source_t *src = hash_get(lib->sources, path);
+   if (src == NULL) {
+      src = xcalloc(sizeof(lib_source_t));
+      src->path = path;
+      hash_put(lib->sources, path, src);
+   }
+
+   return src;
+}
+
+static void lib_read_sources(lib_t lib)
+{
+   lib_free_sources(lib);
+
+   lib->sources = hash_new(128);
+   lib->owners = hash_new(128);
+
+   fbuf_t *f = lib_fbuf_open(lib, "_sources", FBUF_IN, FBUF_CS_NONE);
+   if (f == NULL)
+      return;
+
+   if (read_u32(f) != SOURCES_FILE_MAGIC) {
+      fbuf_close(f, NULL);
+      return;
+   }
+
+   ident_rd_ctx_t ictx = ident_read_begin(f);
+
+   const int nsources = fbuf_get_uint(f);
+   for (int i = 0; i < nsources; i++) {
+      lib_source_t *src = lib_get_source(lib, ident_read(ictx));
+      src->hash = read_u64(f);
+
+      const int nunits = fbuf_get_uint(f);
+      for (int j = 0; j < nunits; j++) {
+         lib_source_unit_t su = {
+            .name     = ident_read(ictx),
+            .checksum = read_u32(f),
+         };
+
+         const int ndeps = fbuf_get_uint(f);
+         for (int k = 0; k < ndeps; k++) {
+            lib_dep_t dep = {
+               .name     = ident_read(ictx),
+               .checksum = read_u32(f),
+            };
+            APUSH(su.deps, dep);
+         }
+
+         APUSH(src->units, su);
+         hash_put(lib->owners, su.name, src);
+      }
+   }
+
+   ident_read_end(ictx);
+   fbuf_close(f, NULL);
+}
+
+static void lib_write_sources(lib_t lib)
+{
+   fbuf_t *f = lib_fbuf_open(lib, "_sources", FBUF_OUT, FBUF_CS_NONE);
+   if (f == NULL)
+      fatal_errno("failed to create library %s source database",
+                  istr(lib->name));
+
+   write_u32(SOURCES_FILE_MAGIC, f);
+
+   ident_wr_ctx_t ictx = ident_write_begin(f);
+
+   fbuf_put_uint(f, hash_members(lib->sources));
+
+   const void *key;
+   void *value;
+   for (hash_iter_t it = HASH_BEGIN; hash_iter(lib->sources, &it, &key, &value); ) {
+      lib_source_t *src = value;
+      ident_write(src->path, ictx);
+      write_u64(src->hash, f);
+
+      fbuf_put_uint(f, src->units.count);
+      for (int i = 0; i < src->units.count; i++) {
+         const lib_source_unit_t *su = &(src->units.items[i]);
+         ident_write(su->name, ictx);
+         write_u32(su->checksum, f);
+
+         fbuf_put_uint(f, su->deps.count);
+         for (int j = 0; j < su->deps.count; j++) {
+            ident_write(su->deps.items[j].name, ictx);
+            write_u32(su->deps.items[j].checksum, f);
+         }
+      }
+   }
+
+   ident_write_end(ictx);
+   fbuf_close(f, NULL);
+}
+
+static void lib_source_dep_cb(object_t *obj, void *ctx)
+{
+   lib_source_unit_t *su = ctx;
+
+   lib_dep_t dep = {
+      .name     = object_ident(obj),
+      .checksum = arena_checksum(object_arena(obj)),
+   };
+   APUSH(su->deps, dep);
+}
+
+static void lib_record_source(lib_t lib, lib_unit_t *lu, hash_t *touched)
+{
+   if (lu->kind == T_ELAB)
+      return;
+
+   ident_t path = ident_new(loc_abs_path(&lu->object->loc));
+   lib_source_t *src = lib_get_source(lib, path);
+
+   if (hash_get(touched, src) == NULL) {
+      const uint64_t hash = lib_hash_source(istr(path));
+      if (hash != src->hash) {
+         // Units from the previous version of the file are obsolete
+         for (int i = 0; i < src->units.count; i++) {
+            if (hash_get(lib->owners, src->units.items[i].name) == src)
+               hash_delete(lib->owners, src->units.items[i].name);
+            ACLEAR(src->units.items[i].deps);
+         }
+         ACLEAR(src->units);
+      }
+
+      src->hash = hash;
+      hash_put(touched, src, src);
+   }
+
+   lib_source_t *prev = hash_get(lib->owners, lu->name);
+   if (prev != NULL && prev != src)
+      prev->hash = 0;   // Unit redefined by another file
+
+   lib_source_unit_t *su = NULL;
+   for (int i = 0; i < src->units.count; i++) {
+      if (src->units.items[i].name == lu->name) {
+         su = &(src->units.items[i]);
+         ACLEAR(su->deps);
+         break;
+      }
+   }
+
+   if (su == NULL) {
+      APUSH(src->units, (lib_source_unit_t){ .name = lu->name });
+      su = &(src->units.items[src->units.count - 1]);
+   }
+
+   su->checksum = arena_checksum(object_arena(lu->object));
+   arena_walk_deps(object_arena(lu->object), lib_source_dep_cb, su);
+
+   hash_put(lib->owners, lu->name, src);
+}
+
+static bool lib_dep_changed(lib_t lib, const lib_dep_t *dep)
+{
+   lib_t dlib = lib_find(ident_until(dep->name, '.'));
+   if (dlib == NULL)
+      return true;
+
+   lib_unit_t *lu = ghash_get(dlib->lookup, dep->name);
+   if (lu != NULL && lu->dirty)
+      return true;   // Reanalysed earlier in this run
+   else if (dlib == lib) {
+      // Avoid loading units from the work library
+      lib_source_t *owner = hash_get(lib->owners, dep->name);
+      if (owner == NULL || owner->hash == 0)
+         return true;
+
+      for (int i = 0; i < owner->units.count; i++) {
+         if (owner->units.items[i].name == dep->name)
+            return owner->units.items[i].checksum != dep->checksum;
+      }
+
+      return true;
+   }
+   else if (lu == NULL && (lu = lib_get_aux(dlib, dep->name)) == NULL)
+      return true;
+   else
+      return arena_checksum(object_arena(lu->object)) != dep->checksum;
+}
+
+bool lib_reuse_source(lib_t lib, const char *file)
+{
+   if (lib->path == NULL)
+      return false;
+
+   if (lib->sources == NULL) {
+      file_read_lock(lib->lock_fd);
+      lib_read_sources(lib);
+      file_unlock(lib->lock_fd);
+   }
+
+   // Paths are recorded in absolute form so they match regardless of
+   // the working directory and --relative option
+   char *abspath LOCAL = realpath(file, NULL);
+   if (abspath == NULL)
+      return false;
+
+   lib_source_t *src = hash_get(lib->sources, ident_new(abspath));
+   if (src == NULL || src->hash == 0 || src->units.count == 0)
+      return false;
+   else if (lib_hash_source(abspath) != src->hash)
+      return false;
+
+   for (int i = 0; i < src->units.count; i++) {
+      const lib_source_unit_t *su = &(src->units.items[i]);
+      if (hash_get(lib->owners, su->name) != src)
+         return false;
+      else if (lib_find_in_index(lib, su->name) == NULL)
+         return false;
+
+      lib_unit_t *lu = ghash_get(lib->lookup, su->name);
+      if (lu != NULL && lu->dirty)
+         return false;
+
+      for (int j = 0; j < su->deps.count; j++) {
+         if (lib_dep_changed(lib, &(su->deps.items[j])))
+            return false;
+      }
+   }
+
+   // Update the unit timestamps so they are not reported as older than
+   // the source file
+   for (int i = 0; i < src->units.count; i++) {
+      LOCAL_TEXT_BUF tb = tb_new();
+      lib_encode_file_name(src->units.items[i].name, tb);
+
+      LOCAL_TEXT_BUF path = lib_file_path(lib, tb_get(tb));
+      utime(tb_get(path), NULL);
+   }
+
+   return true;
+}
+
 void lib_save(lib_t lib)
 {
    assert(lib != NULL);
@@ -1114,6 +1467,8 @@ void lib_save(lib_t lib)
 
    freeze_global_arena();
 
+   A(lib_unit_t *) saved = AINIT;
+
    for (lib_unit_t *lu = lib->units; lu; lu = lu->next) {
       if (lu->dirty) {
          if (lu->error)
@@ -1123,10 +1478,41 @@ void lib_save(lib_t lib)
             arena_walk_obsolete_deps(object_arena(lu->object),
                                      lib_obsolete_cb, lu);
             lib_save_unit(lib, lu);
+            APUSH(saved, lu);
          }
       }
    }
 
+   if (saved.count > 0 && opt_get_int(OPT_INCREMENTAL)) {
+      // Dependency checksums are only known once all units are saved,
+      // and merge with any updates from other processes while we hold
+      // the lock
+      lib_read_sources(lib);
+
+      hash_t *touched = hash_new(64);
+      for (int i = 0; i < saved.count; i++)
+         lib_record_source(lib, saved.items[i], touched);
+
+      if (hash_members(touched) > 0)
+         lib_write_sources(lib);
+
+      hash_free(touched);
+   }
+   else if (lib->path != NULL) {
+      // Any existing database is stale after saving analysed units
+      // without updating it
+      for (int i = 0; i < saved.count; i++) {
+         if (saved.items[i]->kind != T_ELAB) {
+            LOCAL_TEXT_BUF tb = lib_file_path(lib, "_sources");
+            remove(tb_get(tb));
+            lib_free_sources(lib);
+            break;
+         }
+      }
+   }
+
+   ACLEAR(saved);
+
    LOCAL_TEXT_BUF index_path = lib_file_path(lib, "_index");
    file_info_t info;
    if (get_file_info(tb_get(index_path), &info)) {
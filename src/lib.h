@@ -28,6 +28,7 @@
 typedef struct {
    char *cover_file;
    bool  no_collapse;
+   bool  aot;
 } unit_meta_t;
 
 lib_t lib_find(ident_t name);
@@ -43,6 +44,9 @@ void lib_realpath(lib_t lib, const char *name, char *buf, size_t buflen);
 void lib_destroy(lib_t lib);
 ident_t lib_name(lib_t lib);
 void lib_save(lib_t lib);
+void lib_reopen(lib_t lib);
+void lib_refresh(lib_t lib);
+bool lib_reuse_source(lib_t lib, const char *file);
 void lib_add_search_path(const char *path);
 void lib_add_map(const char *name, const char *path);
 void lib_print_search_paths(text_buf_t *tb);
@@ -10743,6 +10743,72 @@ static vcode_reg_t lower_trigger(lower_unit_t *lu, tree_t fcall, tree_t proc)
    return emit_function_trigger(tree_ident2(decl), args, nargs);
 }
 
+static vcode_reg_t lower_edge_trigger(lower_unit_t *lu, tree_t fcall,
+                                      tree_t proc)
+{
+   // Wrap the trigger for RISING_EDGE or FALLING_EDGE with a mask of
+   // the values the clock can take after that edge so events on the
+   // opposite edge are discarded without waking the process
+   tree_t decl = tree_ref(fcall);
+
+   uint64_t mask;
+   bool builtin = true;
+   switch (tree_subkind(decl)) {
+   case S_RISING_EDGE:
+      mask = 1 << 1;   // '1' or TRUE
+      break;
+   case S_FALLING_EDGE:
+      mask = 1 << 0;   // '0' or FALSE
+      break;
+   default:
+      builtin = false;
+      switch (is_well_known(tree_ident2(decl))) {
+      case W_IEEE_1164_RISING_EDGE:
+         mask = (1 << 3) | (1 << 7);   // '1' or 'H'
+         break;
+      case W_IEEE_1164_FALLING_EDGE:
+         mask = (1 << 2) | (1 << 6);   // '0' or 'L'
+         break;
+      default:
+         return VCODE_INVALID_REG;
+      }
+   }
+
+   if (tree_params(fcall) != 1)
+      return VCODE_INVALID_REG;
+
+   tree_t p0 = tree_param(fcall, 0);
+   if (tree_subkind(p0) != P_POS)
+      return VCODE_INVALID_REG;
+
+   tree_t clk = tree_value(p0);
+   if (tree_kind(clk) != T_REF || class_of(clk) != C_SIGNAL)
+      return VCODE_INVALID_REG;
+
+   vcode_reg_t inner_reg, nets_reg;
+   if (builtin) {
+      // The builtin is open coded so the inner trigger compares against
+      // the new value which is only correct if the process is not
+      // sensitive to anything else
+      tree_t w = tree_stmt(proc, 1);
+      if (tree_triggers(w) != 1 || !same_tree(tree_trigger(w, 0), clk))
+         return VCODE_INVALID_REG;
+
+      nets_reg = lower_lvalue(lu, clk);
+
+      const int64_t level = tree_subkind(decl) == S_RISING_EDGE;
+      vcode_reg_t level_reg = emit_const(lower_type(tree_type(clk)), level);
+      inner_reg = emit_cmp_trigger(nets_reg, level_reg);
+   }
+   else if ((inner_reg = lower_trigger(lu, fcall, proc)) == VCODE_INVALID_REG)
+      return VCODE_INVALID_REG;
+   else
+      nets_reg = lower_lvalue(lu, clk);
+
+   vcode_reg_t mask_reg = emit_const(vtype_offset(), mask);
+   return emit_edge_trigger(nets_reg, mask_reg, inner_reg);
+}
+
 static vcode_reg_t lower_process_trigger(lower_unit_t *lu, tree_t proc)
 {
    if (cover_enabled(lu->cover, COVER_MASK_BRANCH | COVER_MASK_EXPRESSION))
@@ -10772,6 +10838,12 @@ static vcode_reg_t lower_process_trigger(lower_unit_t *lu, tree_t proc)
       if (tree_kind(value) != T_FCALL)
          return VCODE_INVALID_REG;
 
+      if (nconds == 1) {
+         vcode_reg_t edge_reg = lower_edge_trigger(lu, value, proc);
+         if (edge_reg != VCODE_INVALID_REG)
+            return edge_reg;
+      }
+
       branches[i] = lower_trigger(lu, value, proc);
    }
 
@@ -16,24 +16,34 @@
 //
 
 #include "util.h"
+#include "array.h"
 #include "common.h"
 #include "diag.h"
 #include "hash.h"
 #include "ident.h"
 #include "lib.h"
+#include "mask.h"
 #include "option.h"
 #include "phase.h"
+#include "thread.h"
 
 #include <limits.h>
 #include <unistd.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 #include <ctype.h>
 #include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <unistd.h>
 
+#ifndef __MINGW32__
+#include <sys/wait.h>
+#endif
+
 typedef enum {
    MAKE_TREE,
    MAKE_LIB,
@@ -418,3 +428,343 @@ void make(tree_t *targets, int count, FILE *out)
    hash_free(rule_map);
    rule_map = NULL;
 }
+
+////////////////////////////////////////////////////////////////////////////////
+// Parallel analysis of source files
+
+#define MAX_TOKEN 128
+
+typedef A(int) index_list_t;
+
+typedef enum {
+   FILE_WAITING, FILE_RUNNING, FILE_DONE, FILE_FAILED
+} file_state_t;
+
+typedef struct {
+   const char   *path;
+   ident_list_t *provides;
+   ident_list_t *requires;
+   bool          barrier;
+   file_state_t  state;
+   int           pid;
+   index_list_t  deps;
+} source_file_t;
+
+static bool scan_token(const char **pp, const char *end, char *buf)
+{
+   const char *p = *pp;
+
+   for (;;) {
+      while (p < end && isspace_iso88591(*p))
+         p++;
+
+      if (p + 1 < end && p[0] == '-' && p[1] == '-') {
+         while (p < end && *p != '\n')
+            p++;
+      }
+      else if (p + 1 < end && p[0] == '/' && p[1] == '*') {
+         for (p += 2; p + 1 < end && !(p[0] == '*' && p[1] == '/'); p++)
+            ;
+         p += 2;
+      }
+      else if (p < end && (*p == '"' || *p == '\\')) {
+         const char delim = *p++;
+         while (p < end && *p != delim && *p != '\n')
+            p++;
+         p++;
+      }
+      else if (p + 2 < end && p[0] == '\'' && p[2] == '\'')
+         p += 3;   // Character literal
+      else
+         break;
+   }
+
+   if (p >= end) {
+      *pp = end;
+      return false;
+   }
+
+   int len = 0;
+   if (isalnum_iso88591(*p)) {
+      for (; p < end && (isalnum_iso88591(*p) || *p == '_'); p++) {
+         if (len < MAX_TOKEN - 1)
+            buf[len++] = toupper_iso88591(*p);
+      }
+   }
+   else
+      buf[len++] = *p++;
+
+   buf[len] = '\0';
+   *pp = p;
+   return true;
+}
+
+static void scan_source_file(source_file_t *sf, ident_t work_name)
+{
+   const size_t len = strlen(sf->path);
+   if (len < 4 || (strcasecmp(sf->path + len - 4, ".vhd")
+                   && (len < 5 || strcasecmp(sf->path + len - 5, ".vhdl")))) {
+      // Verilog and SDF files are analysed in command line order
+      sf->barrier = true;
+      return;
+   }
+
+   const int fd = open(sf->path, O_RDONLY);
+   if (fd < 0) {
+      sf->barrier = true;   // Report the error during analysis
+      return;
+   }
+
+   file_info_t info;
+   if (!get_handle_info(fd, &info) || info.size == 0) {
+      close(fd);
+      return;
+   }
+
+   const char *map = map_file(fd, info.size), *p = map;
+   const char *end = map + info.size;
+
+   // The last four tokens are enough to recognise the start of each
+   // design unit and selected names in the work library
+   char tokens[4][MAX_TOKEN] = {};
+   while (scan_token(&p, end, tokens[3])) {
+      if (strcmp(tokens[3], "IS") == 0) {
+         if (strcmp(tokens[0], "PACKAGE") == 0
+             && strcmp(tokens[1], "BODY") == 0)
+            ident_list_add(&sf->requires, ident_new(tokens[2]));
+         else if (strcmp(tokens[1], "ENTITY") == 0
+                  || strcmp(tokens[1], "PACKAGE") == 0
+                  || strcmp(tokens[1], "CONTEXT") == 0)
+            ident_list_add(&sf->provides, ident_new(tokens[2]));
+      }
+      else if (strcmp(tokens[2], "OF") == 0 && isalnum_iso88591(tokens[3][0])) {
+         if (strcmp(tokens[0], "ARCHITECTURE") == 0)
+            ident_list_add(&sf->requires, ident_new(tokens[3]));
+         else if (strcmp(tokens[0], "CONFIGURATION") == 0) {
+            ident_list_add(&sf->provides, ident_new(tokens[1]));
+            ident_list_add(&sf->requires, ident_new(tokens[3]));
+         }
+      }
+      else if (strcmp(tokens[2], ".") == 0 && isalnum_iso88591(tokens[3][0])) {
+         if (strcmp(tokens[1], "WORK") == 0
+             || ident_new(tokens[1]) == work_name)
+            ident_list_add(&sf->requires, ident_new(tokens[3]));
+      }
+
+      memmove(tokens[0], tokens[1], 3 * MAX_TOKEN);
+   }
+
+   unmap_file((void *)map, info.size);
+   close(fd);
+}
+
+static bool file_depends_on(source_file_t *files, int from, int to,
+                             bit_mask_t *visited)
+{
+   if (from == to)
+      return true;
+   else if (mask_test_and_set(visited, from))
+      return false;
+
+   const source_file_t *sf = &(files[from]);
+   for (int i = 0; i < sf->deps.count; i++) {
+      if (file_depends_on(files, sf->deps.items[i], to, visited))
+         return true;
+   }
+
+   return false;
+}
+
+static void add_later_deps(source_file_t *files, int nfiles, hash_t *first)
+{
+   // A unit used before any file that declares it waits for the first
+   // later file that declares it, unless that would create a cycle
+   LOCAL_BIT_MASK visited;
+   mask_init(&visited, nfiles);
+
+   for (int i = 0; i < nfiles; i++) {
+      source_file_t *sf = &(files[i]);
+      for (ident_list_t *it = sf->requires; it; it = it->next) {
+         const intptr_t j = (intptr_t)hash_get(first, it->ident) - 1;
+         if (j <= i)
+            continue;
+
+         mask_clearall(&visited);
+         if (!file_depends_on(files, j, i, &visited))
+            APUSH(sf->deps, j);
+      }
+   }
+}
+
+static void add_file_deps(source_file_t *files, int nfiles)
+{
+   // A file must wait for the last earlier file that defines a unit it
+   // uses, for any earlier file that uses a unit it redefines, and for
+   // any earlier file that cannot be scanned.  A file that uses a unit
+   // before it is first defined waits for that later file.
+   hash_t *providers = hash_new(256);
+   hash_t *first = hash_new(256);
+   hash_t *users = hash_new(256);
+   int barrier = -1;
+
+   for (int i = 0; i < nfiles; i++) {
+      source_file_t *sf = &(files[i]);
+
+      if (sf->barrier) {
+         for (int j = 0; j < i; j++)
+            APUSH(sf->deps, j);
+         barrier = i;
+         continue;
+      }
+      else if (barrier != -1)
+         APUSH(sf->deps, barrier);
+
+      for (ident_list_t *it = sf->requires; it; it = it->next) {
+         const intptr_t j = (intptr_t)hash_get(providers, it->ident);
+         if (j > 0)
+            APUSH(sf->deps, j - 1);
+      }
+
+      for (ident_list_t *it = sf->provides; it; it = it->next) {
+         // Earlier users only see the first declaration after it is
+         // analysed so there is nothing to wait for
+         const intptr_t j = (intptr_t)hash_get(providers, it->ident);
+         if (j > 0) {
+            APUSH(sf->deps, j - 1);
+
+            index_list_t *list = hash_get(users, it->ident);
+            for (int k = 0; list && k < list->count; k++)
+               APUSH(sf->deps, list->items[k]);
+         }
+
+         hash_put(providers, it->ident, (void *)(intptr_t)(i + 1));
+
+         if (hash_get(first, it->ident) == NULL)
+            hash_put(first, it->ident, (void *)(intptr_t)(i + 1));
+      }
+
+      for (ident_list_t *it = sf->requires; it; it = it->next) {
+         index_list_t *list = hash_get(users, it->ident);
+         if (list == NULL) {
+            list = xcalloc(sizeof(index_list_t));
+            hash_put(users, it->ident, list);
+         }
+         APUSH(*list, i);
+      }
+   }
+
+   add_later_deps(files, nfiles, first);
+
+   const void *key;
+   void *value;
+   for (hash_iter_t it = HASH_BEGIN; hash_iter(users, &it, &key, &value); ) {
+      index_list_t *list = value;
+      ACLEAR(*list);
+      free(list);
+   }
+
+   hash_free(users);
+   hash_free(providers);
+   hash_free(first);
+}
+
+int make_analyse(const char **paths, int nfiles, int jobs,
+                 make_analyse_fn_t fn, void *ctx)
+{
+#ifdef __MINGW32__
+   fatal("parallel analysis is not supported on this platform");
+#else
+   lib_t work = lib_work();
+
+   source_file_t *files = xcalloc_array(nfiles, sizeof(source_file_t));
+   for (int i = 0; i < nfiles; i++) {
+      files[i].path = paths[i];
+      scan_source_file(&(files[i]), lib_name(work));
+   }
+
+   add_file_deps(files, nfiles);
+
+   int running = 0, remaining = nfiles, status = EXIT_SUCCESS;
+
+   fflush(NULL);
+
+   while (remaining > 0) {
+      for (int i = 0; i < nfiles && running < jobs; i++) {
+         source_file_t *sf = &(files[i]);
+         if (sf->state != FILE_WAITING)
+            continue;
+
+         bool ready = true, failed = false;
+         for (int j = 0; j < sf->deps.count; j++) {
+            const file_state_t dep = files[sf->deps.items[j]].state;
+            ready &= (dep == FILE_DONE || dep == FILE_FAILED);
+            failed |= (dep == FILE_FAILED);
+         }
+
+         if (!ready)
+            continue;
+         else if (failed) {
+            // Do not report further errors for files that depend on
+            // one that failed
+            sf->state = FILE_FAILED;
+            remaining--;
+            i = -1;   // Dependents may now be skipped too
+            continue;
+         }
+
+         const pid_t pid = thread_fork();
+         if (pid < 0)
+            fatal_errno("fork");
+         else if (pid == 0) {
+            lib_reopen(work);
+            const int rc = (*fn)(sf->path, ctx);
+            fflush(NULL);
+            _exit(rc);
+         }
+
+         sf->state = FILE_RUNNING;
+         sf->pid = pid;
+         running++;
+      }
+
+      if (running == 0)
+         continue;
+
+      int wstatus;
+      const pid_t pid = waitpid(-1, &wstatus, 0);
+      if (pid < 0) {
+         if (errno == EINTR)
+            continue;
+         fatal_errno("waitpid");
+      }
+
+      for (int i = 0; i < nfiles; i++) {
+         source_file_t *sf = &(files[i]);
+         if (sf->state != FILE_RUNNING || sf->pid != pid)
+            continue;
+
+         if (WIFEXITED(wstatus) && WEXITSTATUS(wstatus) == EXIT_SUCCESS)
+            sf->state = FILE_DONE;
+         else {
+            sf->state = FILE_FAILED;
+            status = EXIT_FAILURE;
+         }
+
+         running--;
+         remaining--;
+         break;
+      }
+   }
+
+   for (int i = 0; i < nfiles; i++) {
+      ident_list_free(files[i].provides);
+      ident_list_free(files[i].requires);
+      ACLEAR(files[i].deps);
+   }
+   free(files);
+
+   lib_refresh(work);
+
+   return status;
+#endif
+}
@@ -153,6 +153,7 @@ const char *mir_op_string(mir_op_t op)
       [MIR_OP_OR_TRIGGER] = "or trigger",
       [MIR_OP_CMP_TRIGGER] = "cmp trigger",
       [MIR_OP_LEVEL_TRIGGER] = "level trigger",
+      [MIR_OP_EDGE_TRIGGER] = "edge trigger",
       [MIR_OP_INSTANCE_NAME] = "instance name",
       [MIR_OP_LAST_EVENT] = "last event",
       [MIR_OP_LAST_ACTIVE] = "last active",
@@ -1145,6 +1146,20 @@ void mir_annotate(mir_unit_t *mu, const mir_annotate_t *cb, void *ctx)
             }
             break;
 
+         case MIR_OP_EDGE_TRIGGER:
+            {
+               col += mir_dump_value(mu, result, cb, ctx);
+               col += printf(" := %s ", mir_op_string(n->op));
+               col += mir_dump_value(mu, n->args[0], cb, ctx);
+               col += printf(" mask ");
+               col += mir_dump_value(mu, n->args[1], cb, ctx);
+               col += printf(" && ");
+               col += mir_dump_value(mu, n->args[2], cb, ctx);
+               mir_dump_type(mu, col, n->type);
+               mir_dump_stamp(mu, n->type, n->stamp);
+            }
+            break;
+
          case MIR_OP_ASSERT:
             {
                printf("%s ", mir_op_string(n->op));
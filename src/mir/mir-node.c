@@ -2961,6 +2961,23 @@ mir_value_t mir_build_cmp_trigger(mir_unit_t *mu, mir_value_t left,
    return result;
 }
 
+mir_value_t mir_build_edge_trigger(mir_unit_t *mu, mir_value_t signal,
+                                   mir_value_t mask, mir_value_t inner)
+{
+   mir_type_t type = mir_trigger_type(mu);
+   mir_value_t result = mir_build_3(mu, MIR_OP_EDGE_TRIGGER, type,
+                                    MIR_NULL_STAMP, signal, mask, inner);
+
+   MIR_ASSERT(mir_is_signal(mu, signal),
+              "edge trigger signal argument must be signal");
+   MIR_ASSERT(mir_is_integral(mu, mask),
+              "edge trigger mask argument must be integer");
+   MIR_ASSERT(mir_is(mu, inner, MIR_TYPE_TRIGGER),
+              "edge trigger inner argument must be trigger");
+
+   return result;
+}
+
 mir_value_t mir_build_function_trigger(mir_unit_t *mu, ident_t name,
                                        const mir_value_t *args, unsigned nargs)
 {
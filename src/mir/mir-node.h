@@ -266,6 +266,7 @@ typedef enum {
    MIR_OP_GET_COUNTERS,
    MIR_OP_INSTANCE_INIT,
    MIR_OP_SCHED_ACTIVE,
+   MIR_OP_EDGE_TRIGGER,
 } mir_op_t;
 
 typedef enum {
@@ -711,6 +712,8 @@ mir_value_t mir_build_level_trigger(mir_unit_t *mu, mir_value_t signal,
                                     mir_value_t count);
 mir_value_t mir_build_cmp_trigger(mir_unit_t *mu, mir_value_t left,
                                   mir_value_t right);
+mir_value_t mir_build_edge_trigger(mir_unit_t *mu, mir_value_t signal,
+                                   mir_value_t mask, mir_value_t inner);
 mir_value_t mir_build_function_trigger(mir_unit_t *mu, ident_t name,
                                        const mir_value_t *args, unsigned nargs);
 mir_value_t mir_build_or_trigger(mir_unit_t *mu, mir_value_t left,
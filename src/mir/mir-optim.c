@@ -740,6 +740,7 @@ static void gvn_visit_block(mir_unit_t *mu, mir_block_t block,
       case MIR_OP_NULL:
       case MIR_OP_FUNCTION_TRIGGER:
       case MIR_OP_LEVEL_TRIGGER:
+      case MIR_OP_EDGE_TRIGGER:
       case MIR_OP_OR_TRIGGER:
       case MIR_OP_ARRAY_REF:
       case MIR_OP_TABLE_REF:
@@ -1185,6 +1185,15 @@ static void import_cmp_trigger(mir_unit_t *mu, mir_import_t *imp, int op)
    imp->map[vcode_get_result(op)] = mir_build_cmp_trigger(mu, left, right);
 }
 
+static void import_edge_trigger(mir_unit_t *mu, mir_import_t *imp, int op)
+{
+   mir_value_t signal = imp->map[vcode_get_arg(op, 0)];
+   mir_value_t mask = imp->map[vcode_get_arg(op, 1)];
+   mir_value_t inner = imp->map[vcode_get_arg(op, 2)];
+   imp->map[vcode_get_result(op)] =
+      mir_build_edge_trigger(mu, signal, mask, inner);
+}
+
 static void import_function_trigger(mir_unit_t *mu, mir_import_t *imp, int op)
 {
    const int nargs = vcode_count_args(op);
@@ -1674,6 +1683,9 @@ static void import_block(mir_unit_t *mu, mir_import_t *imp)
       case VCODE_OP_CMP_TRIGGER:
          import_cmp_trigger(mu, imp, i);
          break;
+      case VCODE_OP_EDGE_TRIGGER:
+         import_edge_trigger(mu, imp, i);
+         break;
       case VCODE_OP_FUNCTION_TRIGGER:
          import_function_trigger(mu, imp, i);
          break;
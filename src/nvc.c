@@ -28,7 +28,9 @@
 #include "phase.h"
 #include "printf.h"
 #include "rt/assert.h"
+#include "rt/fork.h"
 #include "rt/model.h"
+#include "rt/random.h"
 #include "rt/mspace.h"
 #include "rt/rt.h"
 #include "rt/wave.h"
@@ -73,6 +75,12 @@ typedef struct {
    lib_t            work;
 } cmd_state_t;
 
+typedef struct {
+   cmd_state_t  *state;
+   int           count;
+   const char  **variants;
+} fork_at_t;
+
 const char copy_string[] =
    "Copyright (C) 2011-2026  Nick Gasson\n"
    "This program comes with ABSOLUTELY NO WARRANTY. This is free software, "
@@ -84,6 +92,7 @@ const char version_string[] =
 
 static int process_command(int argc, char **argv, cmd_state_t *state);
 static int parse_int(const char *str);
+static size_t parse_size(const char *str);
 static jit_t *get_jit(cmd_state_t *state);
 
 static ident_t to_unit_name(const char *str)
@@ -105,7 +114,7 @@ static int scan_cmd(int start, int argc, char **argv)
       "-a", "-e", "-r", "-c", "--dump", "--make", "--syntax", "--list",
       "--init", "--install", "--print-deps", "--do", "-i",
       "--cover-export", "--preprocess", "--cover-merge",
-      "--cover-report",
+      "--cover-report", "--precompile",
    };
 
    for (int i = start; i < argc; i++) {
@@ -160,8 +169,9 @@ static bool parse_warn_option(char *optarg)
    }
 }
 
-static void do_file_list(const char *file, jit_t *jit, unit_registry_t *ur,
-                         mir_context_t *mc)
+typedef A(char *) file_list_t;
+
+static void do_file_list(const char *file, file_list_t *files)
 {
    FILE *f;
    if (strcmp(file, "-") == 0)
@@ -206,7 +216,7 @@ static void do_file_list(const char *file, jit_t *jit, unit_registry_t *ur,
             tb_append(tb, *p++);
       }
 
-      analyse_file(tb_get(tb), jit, ur, mc);
+      APUSH(*files, xstrdup(tb_get(tb)));
    }
 
    free(line);
@@ -226,6 +236,39 @@ static void werror_diag_cb(diag_t *d, void *ctx)
    diag_level(d, &level);
 }
 
+typedef struct {
+   jit_t       *jit;
+   cmd_state_t *state;
+} analyse_ctx_t;
+
+static bool skip_unchanged_file(const char *file, cmd_state_t *state)
+{
+   // Must be checked after analysing all earlier files as the design
+   // units this file depends on may have changed
+   if (!lib_reuse_source(state->work, file))
+      return false;
+
+   if (opt_get_verbose(OPT_LIB_VERBOSE, NULL))
+      debugf("skipping unchanged file %s", file);
+
+   return true;
+}
+
+static int analyse_one_file(const char *file, void *context)
+{
+   // Analyse a single file in a subprocess and save the results
+   analyse_ctx_t *ctx = context;
+   if (opt_get_int(OPT_INCREMENTAL) && skip_unchanged_file(file, ctx->state))
+      return EXIT_SUCCESS;
+
+   analyse_file(file, ctx->jit, ctx->state->registry, ctx->state->mir);
+
+   if (error_count() == 0)
+      lib_save(ctx->state->work);
+
+   return error_count() > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
 static int analyse(int argc, char **argv, cmd_state_t *state)
 {
    static struct option long_options[] = {
@@ -244,13 +287,15 @@ static int analyse(int argc, char **argv, cmd_state_t *state)
       { "keywords",        required_argument, 0, 'k' },
       { "relative",        required_argument, 0, 'r' },
       { "warn",            required_argument, 0, 'W' },
+      { "jobs",            required_argument, 0, 'j' },
+      { "incremental",     no_argument,       0, 'n' },
       { 0, 0, 0, 0 }
    };
 
    const int next_cmd = scan_cmd(2, argc, argv);
-   int c, index = 0, error_limit = 20;
+   int c, index = 0, error_limit = 20, jobs = 1;
    const char *file_list = NULL;
-   const char *spec = ":D:f:I:W:";
+   const char *spec = ":D:f:I:W:j:";
    bool no_save = false, werror = false;
 
    while ((c = getopt_long(next_cmd, argv, spec, long_options, &index)) != -1) {
@@ -318,11 +363,24 @@ static int analyse(int argc, char **argv, cmd_state_t *state)
       case 'W':
          werror = parse_warn_option(optarg);
          break;
+      case 'j':
+         if ((jobs = parse_int(optarg)) < 1)
+            fatal("invalid number of jobs %s", optarg);
+         break;
+      case 'n':
+         opt_set_int(OPT_INCREMENTAL, 1);
+         break;
       default:
          should_not_reach_here();
       }
    }
 
+   if (jobs > 1 && no_save) {
+      warnf("$bold$--no-save$$ is not supported with parallel analysis, "
+            "ignoring $bold$--jobs$$");
+      jobs = 1;
+   }
+
    set_error_limit(error_limit);
 
    if (werror)
@@ -339,18 +397,39 @@ static int analyse(int argc, char **argv, cmd_state_t *state)
    if (state->vhpi != NULL)
       vhpi_run_callbacks(vhpiCbStartOfAnalysis);
 
+   file_list_t files = AINIT;
+
    if (file_list != NULL)
-      do_file_list(file_list, jit, state->registry, state->mir);
+      do_file_list(file_list, &files);
    else if (optind == next_cmd)
       fatal("missing file name");
 
    for (int i = optind; i < next_cmd; i++) {
       if (argv[i][0] == '@')
-         do_file_list(argv[i] + 1, jit, state->registry, state->mir);
+         do_file_list(argv[i] + 1, &files);
       else
-         analyse_file(argv[i], jit, state->registry, state->mir);
+         APUSH(files, xstrdup(argv[i]));
    }
 
+   int status = EXIT_SUCCESS;
+   if (jobs > 1 && files.count > 1) {
+      analyse_ctx_t ctx = { jit, state };
+      status = make_analyse((const char **)files.items, files.count, jobs,
+                            analyse_one_file, &ctx);
+      no_save = true;   // Each file was saved by its subprocess
+   }
+   else {
+      for (int i = 0; i < files.count; i++) {
+         if (!opt_get_int(OPT_INCREMENTAL)
+             || !skip_unchanged_file(files.items[i], state))
+            analyse_file(files.items[i], jit, state->registry, state->mir);
+      }
+   }
+
+   for (int i = 0; i < files.count; i++)
+      free(files.items[i]);
+   ACLEAR(files);
+
    if (state->vhpi != NULL)
       vhpi_run_callbacks(vhpiCbEndOfAnalysis);
 
@@ -360,7 +439,7 @@ static int analyse(int argc, char **argv, cmd_state_t *state)
    jit_free(jit);
    set_error_limit(0);
 
-   if (error_count() > 0)
+   if (error_count() > 0 || status != EXIT_SUCCESS)
       return EXIT_FAILURE;
 
    if (!no_save)
@@ -469,6 +548,33 @@ static int parse_optimise_level(const char *str)
    return level;
 }
 
+static void reset_jit(cmd_state_t *state)
+{
+   if (state->model != NULL) {
+      model_free(state->model);
+      state->model = NULL;
+   }
+
+   if (state->jit != NULL) {
+      jit_free(state->jit);
+      state->jit = NULL;
+   }
+
+   if (state->registry != NULL) {
+      unit_registry_free(state->registry);
+      state->registry = NULL;
+   }
+
+   if (state->mir != NULL) {
+      mir_context_free(state->mir);
+      state->mir = NULL;
+   }
+
+   state->mir = mir_context_new();
+   state->registry = unit_registry_new(state->mir);
+   state->jit = get_jit(state);
+}
+
 static int elaborate(int argc, char **argv, cmd_state_t *state)
 {
    static struct option long_options[] = {
@@ -484,6 +590,7 @@ static int elaborate(int argc, char **argv, cmd_state_t *state)
       { "no-collapse",     no_argument,       0, 'C' },
       { "stats",           no_argument,       0, 'S' },
       { "trace",           no_argument,       0, 't' },
+      { "aot",             no_argument,       0, 'A' },
       { 0, 0, 0, 0 }
    };
 
@@ -546,6 +653,10 @@ static int elaborate(int argc, char **argv, cmd_state_t *state)
       case 'S':
          opt_set_int(OPT_ELAB_STATS, 1);
          break;
+      case 'A':
+         opt_set_int(OPT_JIT_CACHE, 1);
+         meta.aot = true;
+         break;
       case 0:
          // Set a flag
          break;
@@ -587,29 +698,7 @@ static int elaborate(int argc, char **argv, cmd_state_t *state)
       analyse_file(sdf_args, NULL, NULL, NULL);
    }
 
-   if (state->model != NULL) {
-      model_free(state->model);
-      state->model = NULL;
-   }
-
-   if (state->jit != NULL) {
-      jit_free(state->jit);
-      state->jit = NULL;
-   }
-
-   if (state->registry != NULL) {
-      unit_registry_free(state->registry);
-      state->registry = NULL;
-   }
-
-   if (state->mir != NULL) {
-      mir_context_free(state->mir);
-      state->mir = NULL;
-   }
-
-   state->mir = mir_context_new();
-   state->registry = unit_registry_new(state->mir);
-   state->jit = get_jit(state);
+   reset_jit(state);
    state->model = model_new(state->jit, state->cover);
 
    if (state->vhpi == NULL)
@@ -640,6 +729,11 @@ static int elaborate(int argc, char **argv, cmd_state_t *state)
       progress("saving library");
    }
 
+   if (meta.aot) {
+      model_precompile(state->model);
+      progress("generating native code");
+   }
+
    if (state->cover != NULL) {
       fbuf_t *f = fbuf_open(meta.cover_file, FBUF_OUT, FBUF_CS_NONE);
       if (f == NULL)
@@ -755,9 +849,12 @@ static jit_t *get_jit(cmd_state_t *state)
 {
    jit_t *jit = jit_new(state->registry, state->mir);
 
-#if defined HAVE_LLVM && 1
+#ifdef HAVE_LLVM
    jit_register_llvm_plugin(jit);
-#elif defined ARCH_X86_64 && 0
+#endif
+#ifdef ARCH_X86_64
+   // Tiers are added to the front of the list so the quick baseline
+   // compiler must be registered after LLVM
    jit_register_native_plugin(jit);
 #endif
 
@@ -831,6 +928,65 @@ static void enable_ieee_warnings_cb(rt_model_t *m, void *ctx)
    *ptr = 0;
 }
 
+static char *next_fork_item(char **pos)
+{
+   // Items are separated by commas except inside a string or character
+   // literal such as /s="a,b"
+   char *start = *pos, *p = start, quote = '\0';
+   if (*start == '\0')
+      return NULL;
+
+   for (; *p != '\0'; p++) {
+      if (quote != '\0') {
+         if (*p == quote)
+            quote = '\0';
+      }
+      else if (*p == '"' || *p == '\'')
+         quote = *p;
+      else if (*p == ',')
+         break;
+   }
+
+   if (*p == ',')
+      *p++ = '\0';
+
+   *pos = p;
+   return start;
+}
+
+static void fork_at_cb(rt_model_t *m, void *ctx)
+{
+   fork_at_t *fa = ctx;
+
+   // Only returns in the child processes
+   const int index = fork_children(fa->count);
+
+   char *copy LOCAL = xstrdup(fa->variants[index]);
+   char **plusargs LOCAL = xmalloc_array(strlen(copy) + 1, sizeof(char *));
+   int nplusargs = 0;
+
+   char *pos = copy;
+   for (char *tok; (tok = next_fork_item(&pos)); ) {
+      char *eq = strchr(tok, '=');
+      if (tok[0] == '\0')
+         continue;
+      else if (tok[0] == '+')
+         plusargs[nplusargs++] = tok;
+      else if (strncmp(tok, "seed=", 5) == 0)
+         set_random_seed(parse_int(tok + 5));
+      else if (tok[0] == '/' && eq != NULL) {
+         *eq = '\0';
+         fork_deposit(fa->state->model, tok, eq + 1);
+      }
+      else
+         fatal("invalid item '%s' in fork variant %s", tok,
+               fa->variants[index]);
+   }
+
+   if (nplusargs > 0)
+      vhpi_set_plusargs(fa->state->vhpi, nplusargs, plusargs);
+}
+
 static int run_cmd(int argc, char **argv, cmd_state_t *state)
 {
    static struct option long_options[] = {
@@ -851,14 +1007,29 @@ static int run_cmd(int argc, char **argv, cmd_state_t *state)
       { "vhpi-trace",    no_argument,       0, 'T' },
       { "gtkw",          optional_argument, 0, 'g' },
       { "shuffle",       no_argument,       0, 'H' },
+      { "threads",       required_argument, 0, 'j' },
+      { "jit-cache",     no_argument,       0, 'C' },
+      { "levelise",      no_argument,       0, 'L' },
+      { "fuse-processes", no_argument,      0, 'F' },
+      { "fork-at",       required_argument, 0, 'Y' },
+      { "fork",          required_argument, 0, 'y' },
+      { "wave-async",    no_argument,       0, 'W' },
+      { "wave-start",    required_argument, 0, 'b' },
+      { "wave-stop",     required_argument, 0, 'E' },
+      { "wave-history",  required_argument, 0, 'Q' },
       { 0, 0, 0, 0 }
    };
 
    wave_format_t wave_fmt = WAVE_FORMAT_FST;
    uint64_t      stop_time = TIME_HIGH;
+   uint64_t      fork_time = TIME_HIGH;
+   uint64_t      wave_start = 0;
+   uint64_t      wave_stop = TIME_HIGH;
+   size_t        wave_history = 0;
    const char   *wave_fname = NULL;
    const char   *gtkw_fname = NULL;
    const char   *pli_plugins = NULL;
+   fork_at_t     fork_at = { .state = state };
 
    static bool have_run = false;
    if (have_run)
@@ -958,11 +1129,64 @@ static int run_cmd(int argc, char **argv, cmd_state_t *state)
                "as non-deterministic behaviour");
          opt_set_int(OPT_SHUFFLE_PROCS, 1);
          break;
+      case 'j':
+         {
+            const int nthreads = parse_int(optarg);
+            if (nthreads < 1 || nthreads > MAX_THREADS)
+               fatal("thread count must be between 1 and %d", MAX_THREADS);
+
+            opt_set_int(OPT_RT_THREADS, nthreads);
+         }
+         break;
+      case 'C':
+         opt_set_int(OPT_JIT_CACHE, 1);
+         break;
+      case 'L':
+         opt_set_int(OPT_LEVELISE, 1);
+         break;
+      case 'F':
+         opt_set_int(OPT_FUSE_PROCS, 1);
+         break;
+      case 'Y':
+         fork_time = parse_time(optarg);
+         break;
+      case 'W':
+         opt_set_int(OPT_WAVE_ASYNC, 1);
+         break;
+      case 'b':
+         wave_start = parse_time(optarg);
+         break;
+      case 'E':
+         wave_stop = parse_time(optarg);
+         break;
+      case 'Q':
+         wave_history = parse_size(optarg);
+         break;
+      case 'y':
+         fork_at.variants = xrealloc_array(fork_at.variants,
+                                           fork_at.count + 1,
+                                           sizeof(const char *));
+         fork_at.variants[fork_at.count++] = optarg;
+         break;
       default:
          should_not_reach_here();
       }
    }
 
+   if (fork_time != TIME_HIGH) {
+      if (fork_at.count == 0)
+         fatal("$bold$--fork-at$$ requires at least one $bold$--fork$$ "
+               "variant");
+      else if (wave_fname != NULL)
+         fatal("$bold$--wave$$ cannot be combined with $bold$--fork-at$$");
+      else if (opt_get_int(OPT_RT_THREADS) > 1)
+         fatal("$bold$--threads$$ cannot be combined with "
+               "$bold$--fork-at$$");
+   }
+   else if (fork_at.count > 0)
+      warnf("$bold$--fork$$ option has no effect without "
+            "$bold$--fork-at$$");
+
    // Shuffle the arguments to put all the plusargs first
    qsort(argv + optind, next_cmd - optind, sizeof(char *), plusarg_cmp);
 
@@ -987,6 +1211,9 @@ static int run_cmd(int argc, char **argv, cmd_state_t *state)
 
    opt_set_int(OPT_NO_COLLAPSE, meta->no_collapse);
 
+   if (meta->aot)
+      opt_set_int(OPT_JIT_CACHE, 1);
+
    wave_dumper_t *dumper = NULL;
    if (wave_fname != NULL) {
       const char *name_map[] = { "FST", "VCD" };
@@ -1006,9 +1233,29 @@ static int run_cmd(int argc, char **argv, cmd_state_t *state)
 
       wave_include_file(argv[optind]);
       dumper = wave_dumper_new(wave_fname, gtkw_fname, top, wave_fmt);
+
+      if (wave_start > 0 || wave_stop != TIME_HIGH) {
+         if (wave_stop <= wave_start)
+            fatal("$bold$--wave-stop$$ time must be after "
+                  "$bold$--wave-start$$ time");
+
+         wave_dumper_set_window(dumper, wave_start, wave_stop);
+      }
+
+      if (wave_history > 0)
+         wave_dumper_set_history(dumper, wave_history);
    }
    else if (gtkw_fname != NULL)
       warnf("$bold$--gtkw$$ option has no effect without $bold$--wave$$");
+   else if (opt_get_int(OPT_WAVE_ASYNC))
+      warnf("$bold$--wave-async$$ option has no effect without "
+            "$bold$--wave$$");
+   else if (wave_start > 0 || wave_stop != TIME_HIGH)
+      warnf("$bold$--wave-start$$ and $bold$--wave-stop$$ options have no "
+            "effect without $bold$--wave$$");
+   else if (wave_history > 0)
+      warnf("$bold$--wave-history$$ option has no effect without "
+            "$bold$--wave$$");
 
    if (opt_get_size(OPT_HEAP_SIZE) < 0x100000)
       warnf("recommended heap size is at least 1M");
@@ -1061,6 +1308,9 @@ static int run_cmd(int argc, char **argv, cmd_state_t *state)
       model_set_phase_cb(state->model, END_TIME_STEP,
                          enable_ieee_warnings_cb, state);
 
+   if (fork_time != TIME_HIGH)
+      model_set_timeout_cb(state->model, fork_time, fork_at_cb, &fork_at);
+
    model_run(state->model, stop_time);
 
    set_ctrl_c_handler(NULL, NULL);
@@ -1082,6 +1332,8 @@ static int run_cmd(int argc, char **argv, cmd_state_t *state)
    model_free(state->model);
    state->model = NULL;
 
+   free(fork_at.variants);
+
    argc -= next_cmd - 1;
    argv += next_cmd - 1;
 
@@ -1268,6 +1520,84 @@ static int init_cmd(int argc, char **argv, cmd_state_t *state)
    return argc > 1 ? process_command(argc, argv, state) : EXIT_SUCCESS;
 }
 
+static void precompile_decls(jit_t *jit, tree_t container)
+{
+   const int ndecls = tree_decls(container);
+   for (int i = 0; i < ndecls; i++) {
+      tree_t d = tree_decl(container, i);
+      switch (tree_kind(d)) {
+      case T_FUNC_BODY:
+      case T_PROC_BODY:
+         if (!is_uninstantiated_subprogram(d))
+            (void)jit_lazy_compile(jit, tree_ident2(d));
+         break;
+      default:
+         break;
+      }
+   }
+}
+
+static void precompile_walk_fn(lib_t lib, ident_t ident, int kind,
+                               void *context)
+{
+   jit_t *jit = context;
+
+   if (kind != T_PACKAGE && kind != T_PACK_INST)
+      return;
+
+   tree_t pack = lib_get(lib, ident);
+   if (pack == NULL || is_uninstantiated_package(pack))
+      return;
+
+   (void)jit_lazy_compile(jit, ident);
+
+   if (kind == T_PACK_INST)
+      precompile_decls(jit, pack);
+   else if (package_needs_body(pack)) {
+      tree_t body = body_of(pack);
+      if (body != NULL)
+         precompile_decls(jit, body);
+   }
+}
+
+static int precompile_cmd(int argc, char **argv, cmd_state_t *state)
+{
+   static struct option long_options[] = {
+      { 0, 0, 0, 0 }
+   };
+
+   const int next_cmd = scan_cmd(2, argc, argv);
+   int c, index = 0;
+   const char *spec = ":";
+   while ((c = getopt_long(next_cmd, argv, spec, long_options, &index)) != -1) {
+      switch (c) {
+      case 0:
+         // Set a flag
+         break;
+      case '?':
+         bad_option("precompile", argv);
+      case ':':
+         missing_argument("precompile", argv);
+      }
+   }
+
+   if (next_cmd != optind)
+      fatal("$bold$--precompile$$ command takes no positional arguments");
+
+   // Native code is saved in the JIT cache directory inside the library
+   opt_set_int(OPT_JIT_CACHE, 1);
+
+   reset_jit(state);
+
+   lib_walk_index(state->work, precompile_walk_fn, state->jit);
+   jit_precompile(state->jit);
+
+   argc -= next_cmd - 1;
+   argv += next_cmd - 1;
+
+   return argc > 1 ? process_command(argc, argv, state) : EXIT_SUCCESS;
+}
+
 static void list_packages(void)
 {
    LOCAL_TEXT_BUF tb = tb_new();
@@ -2149,7 +2479,7 @@ static void usage(void)
       struct {
          const char *args;
          const char *usage;
-      } options[16];
+      } options[24];
    } groups[] = {
       { "Commands",
         {
@@ -2170,6 +2500,8 @@ static void usage(void)
            { "--init", "Initialise work library directory" },
            { "--install PKG", "Install third-party packages" },
            { "--list", "Print all units in the library" },
+           { "--precompile",
+             "Generate native code for all packages in the library" },
            { "--preprocess FILE...",
              "Expand FILEs with Verilog preprocessor" },
            { "--print-deps [UNIT]...",
@@ -2208,6 +2540,10 @@ static void usage(void)
            { "--error-limit=NUM", "Stop after NUM errors" },
            { "-f, --files=LIST", "Read files to analyse from LIST" },
            { "-I DIR", "Add DIR to list of Verilog include directories" },
+           { "--incremental",
+             "Skip files that have not changed since last analysis" },
+           { "-j, --jobs=N",
+             "Analyse up to N files in parallel, saving each that succeeds" },
            { "--keywords=VERSION",
              "Use keywords from specified Verilog version" },
            { "--no-save", "Do not save analysed design units" },
@@ -2223,6 +2559,8 @@ static void usage(void)
       },
       { "Elaboration options",
         {
+           { "--aot", "Generate native code for the whole design ahead of "
+             "time" },
            { "--cover[={statement,branch,expression,toggle,...}]",
              "Enable code coverage collection" },
            { "--cover-file=FILE",
@@ -2247,15 +2585,32 @@ static void usage(void)
              "Exclude signals matching GLOB from waveform dump" },
            { "--exit-severity={note,warning,error,failure}",
              "Exit after an assertion failure of this severity" },
+           { "--fork=VARIANT",
+             "Continue in a child with these plusargs, seed, and deposits" },
+           { "--fork-at=T",
+             "Fork a child process for each variant at simulation time T" },
            { "--format={fst,vcd}", "Waveform dump format" },
+           { "--fuse-processes",
+             "Wake processes with the same sensitivity list as one batch" },
            { "--include=GLOB",
              "Include signals matching GLOB in waveform dump" },
+           { "--jit-cache",
+             "Reuse native code compiled by earlier runs of the same design" },
+           { "--levelise",
+             "Evaluate combinational processes without extra delta cycles" },
            { "--shuffle", "Run processes in random order" },
            { "--stats", "Print time and memory usage at end of run" },
            { "--stop-delta=N", "Stop after N delta cycles (default 10000)" },
            { "--stop-time=T", "Stop after simulation time T (e.g. 5ns)" },
+           { "--threads=N", "Execute processes in parallel on N threads" },
            { "--trace", "Trace simulation events" },
            { "-w, --wave[=FILE]", "Write waveform dump to FILE" },
+           { "--wave-async",
+             "Compress waveform data on a background thread" },
+           { "--wave-history=SIZE",
+             "Keep SIZE bytes of waveform data in memory until an error" },
+           { "--wave-start=T", "Start waveform dump at simulation time T" },
+           { "--wave-stop=T", "Stop waveform dump at simulation time T" },
         }
       },
       { "Coverage report options",
@@ -2451,6 +2806,7 @@ static int process_command(int argc, char **argv, cmd_state_t *state)
       { "cover-merge",  no_argument, 0, 'M' },
       { "cover-report", no_argument, 0, 'p' },
       { "preprocess",   no_argument, 0, 'R' },
+      { "precompile",   no_argument, 0, 'C' },
       { 0, 0, 0, 0 }
    };
 
@@ -2494,6 +2850,8 @@ static int process_command(int argc, char **argv, cmd_state_t *state)
       return cover_report_cmd(argc, argv, state);
    case 'R':
       return preprocess_cmd(argc, argv, state);
+   case 'C':
+      return precompile_cmd(argc, argv, state);
    default:
       fatal("missing command, try $bold$%s --help$$ for usage", PACKAGE);
       return EXIT_FAILURE;
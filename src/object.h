@@ -244,6 +244,7 @@ size_t object_arena_default_size(void);
 
 object_t *arena_root(object_arena_t *arena);
 void arena_set_checksum(object_arena_t *arena, uint32_t checksum);
+uint32_t arena_checksum(object_arena_t *arena);
 bool arena_frozen(object_arena_t *arena);
 uint32_t arena_flags(object_arena_t *arena);
 void arena_set_flags(object_arena_t *arena, uint32_t flags);
@@ -186,4 +186,12 @@ void set_default_options(void)
    opt_set_int(OPT_ELAB_STATS, 0);
    opt_set_str(OPT_RELATIVE_PATH, NULL);
    opt_set_int(OPT_EXCL_VERBOSE, get_int_env("NVC_EXCL_VERBOSE", 0));
+   opt_set_int(OPT_RT_THREADS, 1);
+   opt_set_int(OPT_JIT_CACHE, get_int_env("NVC_JIT_CACHE", 0));
+   opt_set_int(OPT_JIT_BASELINE, get_int_env("NVC_JIT_BASELINE", 0));
+   opt_set_int(OPT_LEVELISE, 0);
+   opt_set_int(OPT_FUSE_PROCS, 0);
+   opt_set_int(OPT_WAVE_ASYNC, 0);
+   opt_set_str(OPT_COMPRESSION, getenv("NVC_COMPRESS"));
+   opt_set_int(OPT_INCREMENTAL, 0);
 }
@@ -81,6 +81,14 @@ typedef enum {
    OPT_RELATIVE_PATH,
    OPT_RA_VERBOSE,
    OPT_EXCL_VERBOSE,
+   OPT_RT_THREADS,
+   OPT_JIT_CACHE,
+   OPT_JIT_BASELINE,
+   OPT_LEVELISE,
+   OPT_FUSE_PROCS,
+   OPT_WAVE_ASYNC,
+   OPT_COMPRESSION,
+   OPT_INCREMENTAL,
 
    OPT_LAST_NAME
 } opt_name_t;
@@ -58,6 +58,11 @@ void vhdl_dump(tree_t t, int indent);
 // Generate a makefile for the givein unit
 void make(tree_t *targets, int count, FILE *out);
 
+// Analyse source files in parallel subprocesses respecting dependencies
+typedef int (*make_analyse_fn_t)(const char *, void *);
+int make_analyse(const char **paths, int nfiles, int jobs,
+                 make_analyse_fn_t fn, void *ctx);
+
 // Read the next unit from the input file
 tree_t parse(void);
 
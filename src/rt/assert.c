@@ -509,6 +509,18 @@ void clear_vhdl_assert(void)
       counts[i] = 0;
 }
 
+void get_vhdl_assert_counts(unsigned saved[SEVERITY_FAILURE + 1])
+{
+   for (int i = SEVERITY_NOTE; i <= SEVERITY_FAILURE; i++)
+      saved[i] = counts[i];
+}
+
+void set_vhdl_assert_counts(const unsigned saved[SEVERITY_FAILURE + 1])
+{
+   for (int i = SEVERITY_NOTE; i <= SEVERITY_FAILURE; i++)
+      counts[i] = saved[i];
+}
+
 void set_vhdl_assert_enable(vhdl_severity_t severity, bool enable)
 {
    assert(severity <= SEVERITY_FAILURE);
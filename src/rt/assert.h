@@ -33,6 +33,8 @@ void set_status_severity(vhdl_severity_t severity);
 
 int64_t get_vhdl_assert_count(vhdl_severity_t severity);
 void clear_vhdl_assert(void);
+void get_vhdl_assert_counts(unsigned saved[SEVERITY_FAILURE + 1]);
+void set_vhdl_assert_counts(const unsigned saved[SEVERITY_FAILURE + 1]);
 void set_vhdl_assert_enable(vhdl_severity_t severity, bool enable);
 bool get_vhdl_assert_enable(vhdl_severity_t severity);
 int get_vhdl_assert_exit_status(void);
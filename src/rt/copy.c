@@ -18,6 +18,7 @@
 #include "util.h"
 #include "copy.h"
 
+#include <assert.h>
 #include <string.h>
 
 #ifdef ARCH_X86_64
@@ -103,3 +104,90 @@ bool _cmp_bytes(const void *a, const void *b, size_t size)
 
    return memcmp(a, b, size) == 0;
 }
+
+#if defined HAVE_AVX512BW && defined HAVE_AVX512VBMI
+__attribute__((target("avx512bw,avx512vbmi")))
+static void fold_bytes_avx512(uint8_t *acc, const uint8_t *src,
+                              const int8_t table[16][16], size_t len)
+{
+   // The whole 256 entry table fits in four registers: each VPERMI2B
+   // looks up the low seven bits of (a << 4 | b) in one half and the
+   // top bit selects which half to take
+
+   const __m512i t0 = _mm512_loadu_si512(table[0]);
+   const __m512i t1 = _mm512_loadu_si512(table[4]);
+   const __m512i t2 = _mm512_loadu_si512(table[8]);
+   const __m512i t3 = _mm512_loadu_si512(table[12]);
+
+   for (size_t pos = 0; pos < len; pos += 64) {
+      const __mmask64 mask = len - pos >= 64
+         ? ~UINT64_C(0) : (UINT64_C(1) << (len - pos)) - 1;
+
+      __m512i a   = _mm512_maskz_loadu_epi8(mask, acc + pos);
+      __m512i b   = _mm512_maskz_loadu_epi8(mask, src + pos);
+      __m512i idx = _mm512_or_si512(_mm512_slli_epi16(a, 4), b);
+      __m512i lo  = _mm512_permutex2var_epi8(t0, idx, t1);
+      __m512i hi  = _mm512_permutex2var_epi8(t2, idx, t3);
+      __m512i out = _mm512_mask_blend_epi8(_mm512_movepi8_mask(idx), lo, hi);
+      _mm512_mask_storeu_epi8(acc + pos, mask, out);
+   }
+}
+#endif
+
+#ifdef HAVE_AVX2
+__attribute__((target("avx2")))
+static size_t fold_bytes_avx2(uint8_t *acc, const uint8_t *src,
+                              const int8_t table[16][16], int nrows,
+                              size_t len)
+{
+   // Look up the right operand in every row of the table with PSHUFB
+   // and blend in the row selected by the left operand
+
+   size_t pos = 0;
+   for (; pos + 32 <= len; pos += 32) {
+      __m256i a   = _mm256_loadu_si256((const __m256i *)(acc + pos));
+      __m256i b   = _mm256_loadu_si256((const __m256i *)(src + pos));
+      __m256i out = _mm256_setzero_si256();
+
+      for (int row = 0; row < nrows; row++) {
+         __m128i r128 = _mm_loadu_si128((const __m128i *)table[row]);
+         __m256i tbl  = _mm256_broadcastsi128_si256(r128);
+         __m256i sel  = _mm256_cmpeq_epi8(a, _mm256_set1_epi8(row));
+         out = _mm256_blendv_epi8(out, _mm256_shuffle_epi8(tbl, b), sel);
+      }
+
+      _mm256_storeu_si256((__m256i *)(acc + pos), out);
+   }
+
+   return pos;
+}
+#endif
+
+void fold_bytes(void *acc, const void *src, const int8_t table[16][16],
+                int nrows, size_t len)
+{
+   // Replace each byte A in ACC with TABLE[A][B] where B is the
+   // corresponding byte in SRC: all values must be less than NROWS
+
+   assert(nrows <= 16);
+
+   size_t pos = 0;
+
+#if defined HAVE_AVX512BW && defined HAVE_AVX512VBMI && !ASAN_ENABLED
+   if (len >= 16 && __builtin_cpu_supports("avx512vbmi")
+       && __builtin_cpu_supports("avx512bw")) {
+      fold_bytes_avx512(acc, src, table, len);
+      return;
+   }
+#endif
+
+#if defined HAVE_AVX2 && !ASAN_ENABLED
+   if (len >= 32 && __builtin_cpu_supports("avx2"))
+      pos = fold_bytes_avx2(acc, src, table, nrows, len);
+#endif
+
+   uint8_t *restrict a = acc;
+   const uint8_t *restrict b = src;
+   for (; pos < len; pos++)
+      a[pos] = table[a[pos]][b[pos]];
+}
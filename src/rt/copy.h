@@ -45,4 +45,7 @@ static inline bool cmp_bytes(const void *a, const void *b, size_t size)
       return _cmp_bytes(a, b, size);
 }
 
+void fold_bytes(void *acc, const void *src, const int8_t table[16][16],
+                int nrows, size_t len);
+
 #endif   // _RT_COPY_H
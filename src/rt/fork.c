@@ -0,0 +1,137 @@
+//
+//  Copyright (C) 2026  Nick Gasson
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "util.h"
+#include "common.h"
+#include "ident.h"
+#include "rt/fork.h"
+#include "rt/model.h"
+#include "rt/structs.h"
+#include "thread.h"
+#include "tree.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#ifndef __MINGW32__
+#include <sys/wait.h>
+#endif
+
+int fork_children(int count)
+{
+#ifdef __MINGW32__
+   fatal("fork is not supported on this platform");
+#else
+   // Children run at most one per processor and the parent never
+   // returns: it exits with the highest status of any child
+   const int maxjobs = nvc_nprocs();
+   int running = 0, next = 0, status = 0;
+
+   fflush(NULL);
+
+   while (next < count || running > 0) {
+      if (next < count && running < maxjobs) {
+         const pid_t pid = thread_fork();
+         if (pid < 0)
+            fatal_errno("fork");
+         else if (pid == 0)
+            return next;
+
+         next++, running++;
+         continue;
+      }
+
+      int wstatus;
+      if (waitpid(-1, &wstatus, 0) < 0) {
+         if (errno == EINTR)
+            continue;
+         fatal_errno("waitpid");
+      }
+
+      running--;
+
+      if (WIFEXITED(wstatus))
+         status = MAX(status, WEXITSTATUS(wstatus));
+      else if (WIFSIGNALED(wstatus))
+         status = MAX(status, 128 + WTERMSIG(wstatus));
+   }
+
+   _exit(status);
+#endif
+}
+
+static rt_signal_t *fork_find_signal(rt_model_t *m, const char *path)
+{
+   // Signal paths have the same form as in the shell, relative to the
+   // top-level instance
+   rt_scope_t *scope = root_scope(m);
+   if (*path != '/' || scope->children.count == 0)
+      return NULL;
+
+   scope = scope->children.items[0];
+
+   char *copy LOCAL = xstrdup(path + 1);
+   char *saveptr = NULL;
+   char *name = strtok_r(copy, "/", &saveptr);
+   if (name == NULL)
+      return NULL;
+
+   for (char *next; (next = strtok_r(NULL, "/", &saveptr)); name = next) {
+      ident_t id = ident_new(name);
+      rt_scope_t *child = NULL;
+      for (int i = 0; i < scope->children.count; i++) {
+         rt_scope_t *s = scope->children.items[i];
+         if (ident_casecmp(tree_ident(s->where), id)) {
+            child = s;
+            break;
+         }
+      }
+
+      if ((scope = child) == NULL)
+         return NULL;
+   }
+
+   ident_t id = ident_new(name);
+
+   for (int i = 0; i < scope->signals.count; i++) {
+      rt_signal_t *s = scope->signals.items[i];
+      if (ident_casecmp(tree_ident(s->where), id))
+         return s;
+   }
+
+   for (int i = 0; i < scope->aliases.count; i++) {
+      rt_alias_t *a = scope->aliases.items[i];
+      if (ident_casecmp(tree_ident(a->where), id))
+         return a->signal;
+   }
+
+   return NULL;
+}
+
+void fork_deposit(rt_model_t *m, const char *path, const char *value)
+{
+   rt_signal_t *s = fork_find_signal(m, path);
+   if (s == NULL)
+      fatal("cannot find signal %s", path);
+
+   LOCAL_TEXT_BUF err = tb_new();
+   if (!set_signal_value(m, s, path, value, SET_DEPOSIT, err))
+      fatal("%s", tb_get(err));
+}
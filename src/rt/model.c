@@ -33,6 +33,7 @@
 #include "rt/model.h"
 #include "rt/random.h"
 #include "rt/structs.h"
+#include "rt/wheel.h"
 #include "thread.h"
 #include "tree.h"
 #include "type.h"
@@ -62,6 +63,10 @@ typedef enum {
 #define MEMBLOCK_ALIGN   64
 #define MEMBLOCK_PAGE_SZ 0x800000
 #define TRIGGER_TAB_SIZE 64
+#define NEXUS_CHUNK_BITS 14
+#define NEXUS_CHUNK_SIZE (1 << NEXUS_CHUNK_BITS)
+#define NEXUS_CHUNK_MASK (NEXUS_CHUNK_SIZE - 1)
+#define NEXUS_MAX_CHUNKS 16384
 
 #if ASAN_ENABLED
 #define MEMBLOCK_REDZONE 16
@@ -78,6 +83,16 @@ typedef struct _memblock {
 
 STATIC_ASSERT(sizeof(memblock_t) <= MEMBLOCK_ALIGN);
 
+// Per-nexus state that changes every cycle is kept in dense parallel
+// arrays so that sweeps over many nexuses stream through memory rather
+// than touching a separate cache line for each rt_nexus_t
+typedef struct {
+   uint64_t      last_event[NEXUS_CHUNK_SIZE];
+   delta_cycle_t event_delta[NEXUS_CHUNK_SIZE];
+   delta_cycle_t active_delta[NEXUS_CHUNK_SIZE];
+   void         *pending[NEXUS_CHUNK_SIZE];
+} nexus_chunk_t;
+
 typedef struct {
    waveform_t    *free_waveforms;
    tlab_t        *tlab;
@@ -98,6 +113,23 @@ typedef struct {
    unsigned      max;
 } deferq_t;
 
+typedef struct {
+   uint64_t  when;
+   void     *event;
+} batch_event_t;
+
+typedef struct {
+   const defer_task_t *tasks;
+   unsigned            count;
+   deferq_t            procq;
+   deferq_t            driverq;
+   deferq_t            postponedq;
+   deferq_t            nonblockq;
+   deferq_t            reschedq;
+   A(batch_event_t)    events;
+   signal_list_t       eventsigs;
+} __attribute__((aligned(64))) model_batch_t;
+
 typedef struct _rt_model {
    tree_t             top;
    hash_t            *scopes;
@@ -106,6 +138,8 @@ typedef struct _rt_model {
    jit_t             *jit;
    rt_nexus_t        *nexuses;
    rt_nexus_t       **nexus_tail;
+   nexus_chunk_t    **nexus_chunks;
+   unsigned           n_nexus_ids;
    delta_cycle_t      stop_delta;
    int                iteration;
    uint64_t           now;
@@ -115,7 +149,7 @@ typedef struct _rt_model {
    bool               force_stop;
    bool               blocking_update;
    unsigned           n_signals;
-   heap_t            *eventq_heap;
+   wheel_t           *eventq;
    ihash_t           *res_memo;
    rt_watch_t        *watches;
    deferq_t           procq;
@@ -130,16 +164,26 @@ typedef struct _rt_model {
    deferq_t           reschedq;
    heap_t            *driving_heap;
    heap_t            *effective_heap;
+   heap_t            *level_heap;
+   bool               levelise;
+   bool               levelising;
    rt_callback_t     *phase_cbs[END_OF_SIMULATION + 1];
    cover_data_t      *cover;
    nvc_rusage_t       ready_rusage;
    nvc_lock_t         memlock;
    memblock_t        *memblocks;
    model_thread_t    *threads[MAX_THREADS];
+   waveform_t        *spare_waveforms;
    signal_list_t      eventsigs;
    bool               shuffle;
    bool               liveness;
    rt_trigger_t      *triggertab[TRIGGER_TAB_SIZE];
+   workq_t           *workq;
+   bool               parallel;
+   nvc_lock_t         lock;
+   int                nbatches;
+   model_batch_t     *batches;
+   deferq_t           serialq;
 } rt_model_t;
 
 #define FMT_VALUES_SZ   128
@@ -148,6 +192,12 @@ typedef struct _rt_model {
 #define WAVEFORM_CHUNK  256
 #define PENDING_MIN     4
 #define MAX_RANK        UINT8_MAX
+#define PARALLEL_CHUNK  8
+#define MAX_HELD_LOCKS  64
+
+#define NEXUS_HOT(m, n, field)                          \
+   ((m)->nexus_chunks[(n)->id >> NEXUS_CHUNK_BITS]      \
+    ->field[(n)->id & NEXUS_CHUNK_MASK])
 
 #define TRACE(...) do {                                 \
       if (unlikely(__trace_on))                         \
@@ -158,10 +208,28 @@ typedef struct _rt_model {
    rt_model_t *__save __attribute__((unused, cleanup(__model_exit)));   \
    __model_entry(m, &__save);                                           \
 
+// Serialise access to shared model state while processes are executing
+// on worker threads: this is a no-op outside the parallel phase
+#define MODEL_LOCK(m)                                                   \
+   __attribute__((cleanup(__model_unlock), unused))                     \
+   rt_model_t *UNIQUE(__lock) = __model_lock(m)
+
+// Lock an individual signal or the allocator during the parallel phase:
+// the model lock must be acquired first if more than one signal lock is
+// needed and never while holding a signal lock
+#define PARALLEL_LOCK(m, lock)                                          \
+   __attribute__((cleanup(__parallel_unlock), unused))                  \
+   nvc_lock_t *UNIQUE(__lock) = __parallel_lock((m), &(lock))
+
 static __thread rt_model_t *__model = NULL;
+static __thread model_batch_t *__batch = NULL;
+static __thread int __lock_depth = 0;
+static __thread nvc_lock_t *__held_locks[MAX_HELD_LOCKS];
+static __thread int __n_held_locks = 0;
 
 static bool __trace_on = false;
 
+static void *static_alloc(rt_model_t *m, size_t size);
 static void *source_value(rt_nexus_t *nexus, rt_source_t *src);
 static void free_value(rt_nexus_t *n, rt_value_t v);
 static rt_nexus_t *clone_nexus(rt_model_t *m, rt_nexus_t *old, int offset);
@@ -315,6 +383,56 @@ static void __model_exit(rt_model_t **save)
       diag_remove_hint_fn(model_diag_cb, m);
 }
 
+static rt_model_t *__model_lock(rt_model_t *m)
+{
+   if (likely(!m->parallel))
+      return NULL;
+   else if (__lock_depth++ == 0)
+      nvc_lock(&m->lock);
+
+   return m;
+}
+
+static void __model_unlock(rt_model_t **pm)
+{
+   if (*pm != NULL && --__lock_depth == 0)
+      nvc_unlock(&(*pm)->lock);
+}
+
+static nvc_lock_t *__parallel_lock(rt_model_t *m, nvc_lock_t *lock)
+{
+   if (likely(!m->parallel))
+      return NULL;
+   else if (__n_held_locks == MAX_HELD_LOCKS)
+      fatal_trace("too many signal locks held");
+
+   nvc_lock(lock);
+   return (__held_locks[__n_held_locks++] = lock);
+}
+
+static void __parallel_unlock(nvc_lock_t **plock)
+{
+   if (*plock != NULL) {
+      assert(__n_held_locks > 0);
+      assert(__held_locks[__n_held_locks - 1] == *plock);
+      __n_held_locks--;
+      nvc_unlock(*plock);
+   }
+}
+
+static void model_unlock_all(rt_model_t *m)
+{
+   // A fatal error inside a runtime call will unwind the stack without
+   // running the cleanup handlers
+   while (unlikely(__n_held_locks > 0))
+      nvc_unlock(__held_locks[--__n_held_locks]);
+
+   if (unlikely(__lock_depth > 0)) {
+      __lock_depth = 0;
+      nvc_unlock(&m->lock);
+   }
+}
+
 static char *fmt_values_r(const void *values, size_t len, char *buf, size_t max)
 {
    char *p = buf;
@@ -340,13 +458,13 @@ static const char *fmt_nexus(rt_nexus_t *n, const void *values)
 
 static const char *fmt_values(const void *values, uint32_t len)
 {
-   static char buf[FMT_VALUES_SZ*2 + 2];
+   static __thread char buf[FMT_VALUES_SZ*2 + 2];
    return fmt_values_r(values, len, buf, sizeof(buf));
 }
 
 static const char *fmt_jit_value(jit_scalar_t value, bool scalar, uint32_t len)
 {
-   static char buf[FMT_VALUES_SZ*2 + 2];
+   static __thread char buf[FMT_VALUES_SZ*2 + 2];
    if (scalar) {
       checked_sprintf(buf, sizeof(buf), "%"PRIx64, value.integer);
       return buf;
@@ -355,19 +473,27 @@ static const char *fmt_jit_value(jit_scalar_t value, bool scalar, uint32_t len)
       return fmt_values_r(value.pointer, len, buf, sizeof(buf));
 }
 
-static model_thread_t *model_thread(rt_model_t *m)
+__attribute__((cold, noinline))
+static model_thread_t *model_thread_new(rt_model_t *m)
 {
-#if RT_MULTITHREADED
-   const int my_id = thread_id();
+   // Worker threads executing processes in parallel
+   assert(m->parallel);
 
-   if (unlikely(m->threads[my_id] == NULL))
-      return (m->threads[my_id] = xcalloc(sizeof(model_thread_t)));
+   MODEL_LOCK(m);
 
-   return m->threads[my_id];
-#else
-   assert(thread_id() == 0);
-   return m->threads[0];
-#endif
+   model_thread_t *thread = static_alloc(m, sizeof(model_thread_t));
+   thread->tlab = tlab_acquire(m->mspace);
+
+   return (m->threads[thread_id()] = thread);
+}
+
+static inline model_thread_t *model_thread(rt_model_t *m)
+{
+   model_thread_t *thread = m->threads[thread_id()];
+   if (unlikely(thread == NULL))
+      return model_thread_new(m);
+
+   return thread;
 }
 
 __attribute__((cold, noinline))
@@ -439,11 +565,59 @@ static void deferq_run(rt_model_t *m, deferq_t *dq)
    }
 }
 
+static void deferq_concat(deferq_t *to, deferq_t *from)
+{
+   while (to->count + from->count > to->max)
+      deferq_grow(to);
+
+   memcpy(to->tasks + to->count, from->tasks,
+          from->count * sizeof(defer_task_t));
+   to->count += from->count;
+   from->count = 0;
+}
+
+__attribute__((cold, noinline))
+static deferq_t *batch_deferq(rt_model_t *m, model_batch_t *b, deferq_t *dq)
+{
+   if (dq == &m->procq)
+      return &b->procq;
+   else if (dq == &m->driverq)
+      return &b->driverq;
+   else if (dq == &m->postponedq)
+      return &b->postponedq;
+   else if (dq == &m->nonblockq)
+      return &b->nonblockq;
+   else if (dq == &m->reschedq)
+      return &b->reschedq;
+   else
+      return dq;
+}
+
+static inline deferq_t *local_deferq(rt_model_t *m, deferq_t *dq)
+{
+   // Work scheduled by processes executing on a worker thread is
+   // deferred until all threads reach the barrier
+   model_batch_t *b = __batch;
+   if (likely(b == NULL))
+      return dq;
+   else
+      return batch_deferq(m, b, dq);
+}
+
+static void eventq_insert(rt_model_t *m, uint64_t when, void *event)
+{
+   model_batch_t *b = __batch;
+   if (likely(b == NULL))
+      wheel_insert(m->eventq, when, event);
+   else
+      APUSH(b->events, ((batch_event_t){ when, event }));
+}
+
 static void *static_alloc(rt_model_t *m, size_t size)
 {
    const int total_bytes = ALIGN_UP(size + MEMBLOCK_REDZONE, MEMBLOCK_ALIGN);
 
-   RT_LOCK(m->memlock);
+   PARALLEL_LOCK(m, m->memlock);
 
    memblock_t *mb = m->memblocks;
 
@@ -488,13 +662,15 @@ rt_model_t *model_new(jit_t *jit, cover_data_t *cover)
    m->mspace      = jit_get_mspace(jit);
    m->jit         = jit;
    m->nexus_tail  = &(m->nexuses);
+   m->nexus_chunks = xcalloc_array(NEXUS_MAX_CHUNKS, sizeof(nexus_chunk_t *));
    m->iteration   = -1;
-   m->eventq_heap = heap_new(512);
+   m->eventq      = wheel_new();
    m->res_memo    = ihash_new(128);
    m->cover       = cover;
 
    m->driving_heap   = heap_new(64);
    m->effective_heap = heap_new(64);
+   m->level_heap     = heap_new(64);
 
    m->can_create_delta = true;
    m->next_is_delta    = true;
@@ -544,10 +720,17 @@ static void free_waveform(rt_model_t *m, waveform_t *w)
    thread->free_waveforms = w;
 }
 
+static inline bool nexus_event(rt_model_t *m, rt_nexus_t *n)
+{
+   return NEXUS_HOT(m, n, event_delta) == m->iteration
+      && NEXUS_HOT(m, n, last_event) == m->now;
+}
+
 static void cleanup_nexus(rt_model_t *m, rt_nexus_t *n)
 {
-   if (n->pending != NULL && pointer_tag(n->pending) == 0)
-      free(n->pending);
+   void *pending = NEXUS_HOT(m, n, pending);
+   if (pending != NULL && pointer_tag(pending) == 0)
+      free(pending);
 }
 
 static void cleanup_signal(rt_model_t *m, rt_signal_t *s)
@@ -610,8 +793,8 @@ void model_free(rt_model_t *m)
             m->ready_rusage.ms, ru.ms, ru.user, ru.sys, ru.rss, mem / 1024);
    }
 
-   while (heap_size(m->eventq_heap) > 0) {
-      void *e = heap_extract_min(m->eventq_heap);
+   while (wheel_size(m->eventq) > 0) {
+      void *e = wheel_extract_min(m->eventq);
       if (pointer_tag(e) == EVENT_TIMEOUT)
          free(untag_pointer(e, rt_callback_t));
    }
@@ -635,6 +818,23 @@ void model_free(rt_model_t *m)
    free(m->reschedq.tasks);
    free(m->driverq.tasks);
    free(m->next_driverq.tasks);
+   free(m->serialq.tasks);
+
+   for (int i = 0; i < m->nbatches; i++) {
+      model_batch_t *b = &(m->batches[i]);
+      free(b->procq.tasks);
+      free(b->driverq.tasks);
+      free(b->postponedq.tasks);
+      free(b->nonblockq.tasks);
+      free(b->reschedq.tasks);
+      ACLEAR(b->events);
+      ACLEAR(b->eventsigs);
+   }
+
+   free(m->batches);
+
+   if (m->workq != NULL)
+      workq_free(m->workq);
 
    for (rt_watch_t *it = m->watches, *tmp; it; it = tmp) {
       tmp = it->chain_all;
@@ -653,9 +853,14 @@ void model_free(rt_model_t *m)
       nvc_munmap(mb, mb->limit + MEMBLOCK_ALIGN);
    }
 
+   for (int i = 0; i < NEXUS_MAX_CHUNKS && m->nexus_chunks[i]; i++)
+      free(m->nexus_chunks[i]);
+   free(m->nexus_chunks);
+
    heap_free(m->effective_heap);
    heap_free(m->driving_heap);
-   heap_free(m->eventq_heap);
+   heap_free(m->level_heap);
+   wheel_free(m->eventq);
    hash_free(m->scopes);
    ihash_free(m->res_memo);
    ACLEAR(m->eventsigs);
@@ -698,12 +903,19 @@ rt_proc_t *find_proc(rt_scope_t *scope, tree_t proc)
    return NULL;
 }
 
-rt_watch_t *find_watch(rt_nexus_t *n, sig_event_fn_t fn)
+void *nexus_pending(rt_model_t *m, rt_nexus_t *n)
+{
+   return NEXUS_HOT(m, n, pending);
+}
+
+rt_watch_t *find_watch(rt_model_t *m, rt_nexus_t *n, sig_event_fn_t fn)
 {
-   if (n->pending == NULL)
+   void *pending = NEXUS_HOT(m, n, pending);
+
+   if (pending == NULL)
       return NULL;
-   else if (pointer_tag(n->pending) == 1) {
-      rt_wakeable_t *obj = untag_pointer(n->pending, rt_wakeable_t);
+   else if (pointer_tag(pending) == 1) {
+      rt_wakeable_t *obj = untag_pointer(pending, rt_wakeable_t);
       if (obj->kind == W_WATCH) {
          rt_watch_t *w = container_of(obj, rt_watch_t, wakeable);
          if (w->fn == fn)
@@ -713,7 +925,7 @@ rt_watch_t *find_watch(rt_nexus_t *n, sig_event_fn_t fn)
       return NULL;
    }
    else {
-      rt_pending_t *p = untag_pointer(n->pending, rt_pending_t);
+      rt_pending_t *p = untag_pointer(pending, rt_pending_t);
 
       for (int i = 0; i < p->count; i++) {
          rt_wakeable_t *obj = untag_pointer(p->wake[i], rt_wakeable_t);
@@ -778,7 +990,7 @@ rt_scope_t *create_scope(rt_model_t *m, tree_t block, rt_scope_t *parent)
       if (jit_fastcall(m->jit, handle, &result, context, p2, &tlab))
          *mptr_get(s->privdata) = result.pointer;
       else
-         m->force_stop = true;
+         relaxed_store(&m->force_stop, true);
 
       assert(thread->active_scope == s);
       thread->active_scope = NULL;
@@ -858,15 +1070,15 @@ static void deltaq_insert_proc(rt_model_t *m, uint64_t delta, rt_proc_t *proc)
 {
    if (delta == 0) {
       set_pending(&proc->wakeable);
-      deferq_do(&m->procq, async_run_process, proc);
-      m->next_is_delta = true;
+      deferq_do(local_deferq(m, &m->procq), async_run_process, proc);
+      relaxed_store(&m->next_is_delta, true);
    }
    else {
       assert(!proc->wakeable.delayed);
       proc->wakeable.delayed = true;
 
       void *e = tag_pointer(proc, EVENT_PROCESS);
-      heap_insert(m->eventq_heap, m->now + delta, e);
+      eventq_insert(m, m->now + delta, e);
    }
 }
 
@@ -874,19 +1086,19 @@ static void deltaq_insert_driver(rt_model_t *m, uint64_t delta,
                                  rt_source_t *source)
 {
    if (delta == 0) {
-      deferq_do(&m->driverq, async_update_driver, source);
-      m->next_is_delta = true;
+      deferq_do(local_deferq(m, &m->driverq), async_update_driver, source);
+      relaxed_store(&m->next_is_delta, true);
    }
    else {
       void *e = tag_pointer(source, EVENT_DRIVER);
-      heap_insert(m->eventq_heap, m->now + delta, e);
+      eventq_insert(m, m->now + delta, e);
    }
 }
 
 static void deltaq_insert_pseudo_source(rt_model_t *m, rt_source_t *src)
 {
-   deferq_do(&m->driverq, async_pseudo_source, src);
-   m->next_is_delta = true;
+   deferq_do(local_deferq(m, &m->driverq), async_pseudo_source, src);
+   relaxed_store(&m->next_is_delta, true);
 }
 
 static void reset_process(rt_model_t *m, rt_proc_t *proc)
@@ -910,7 +1122,7 @@ static void reset_process(rt_model_t *m, rt_proc_t *proc)
    if (jit_call_closure(m->jit, &proc->closure, &result, state, &tlab))
       *mptr_get(proc->privdata) = result.pointer;
    else
-      m->force_stop = true;
+      relaxed_store(&m->force_stop, true);
 
    thread->active_obj = NULL;
    thread->active_scope = NULL;
@@ -943,7 +1155,7 @@ static void reset_property(rt_model_t *m, rt_prop_t *prop)
                      results, ARRAY_LEN(results), &tlab))
       *mptr_get(prop->privdata) = results[0].pointer;
    else
-      m->force_stop = true;
+      relaxed_store(&m->force_stop, true);
 
    TRACE("needs %"PRIi64" state bits", results[1].integer);
 
@@ -964,8 +1176,11 @@ static void run_process(rt_model_t *m, rt_proc_t *proc)
 
    rt_wakeable_t *obj = &(proc->wakeable);
 
-   if (obj->trigger != NULL && !run_trigger(m, obj->trigger))
-      return;   // Filtered
+   if (obj->trigger != NULL) {
+      MODEL_LOCK(m);   // Triggers are shared between processes
+      if (!run_trigger(m, obj->trigger))
+         return;   // Filtered
+   }
 
    model_thread_t *thread = model_thread(m);
    assert(thread->tlab != NULL);
@@ -983,7 +1198,7 @@ static void run_process(rt_model_t *m, rt_proc_t *proc)
 
    if (!jit_call_closure(m->jit, &proc->closure, &result, state,
                          proc->tlab ?: thread->tlab))
-      m->force_stop = true;
+      relaxed_store(&m->force_stop, true);
 
    if (proc->tlab != NULL && result.pointer == NULL) {
       tlab_release(proc->tlab);
@@ -1014,6 +1229,58 @@ static void reset_scope(rt_model_t *m, rt_scope_t *s)
       reset_property(m, s->properties.items[i]);
 }
 
+static bool memo_try_fold(rt_model_t *m, res_memo_t *memo, int8_t *args,
+                          int nargs)
+{
+   jit_scalar_t result;
+   if (!jit_try_call(m->jit, memo->closure.handle, &result,
+                     memo->closure.args[0], args, nargs))
+      return false;
+
+   int8_t expect = memo->tab2[args[0]][args[1]];
+   for (int i = 2; i < nargs; i++)
+      expect = memo->tab2[expect][args[i]];
+
+   return result.integer == expect;
+}
+
+static bool memo_can_fold(rt_model_t *m, res_memo_t *memo)
+{
+   // Check whether resolving three or four values is the same as
+   // resolving the first two and then resolving that with each of the
+   // others in turn, in which case any number of sources can be
+   // resolved with the two value table as for std_logic
+
+   // A resolution function that rejects more than two sources must
+   // not change the exit status
+   unsigned counts[SEVERITY_FAILURE + 1];
+   get_vhdl_assert_counts(counts);
+
+   const int nlits = memo->nlits;
+
+   bool fold = true;
+   for (int i = 0; i < nlits && fold; i++) {
+      for (int j = 0; j < nlits && fold; j++) {
+         for (int k = 0; k < nlits && fold; k++) {
+            int8_t args3[3] = { i, j, k };
+            fold = memo_try_fold(m, memo, args3, 3);
+
+            for (int l = 0; l < nlits && fold; l++) {
+               int8_t args4[4] = { i, j, k, l };
+               fold = memo_try_fold(m, memo, args4, 4);
+            }
+         }
+      }
+   }
+
+   fold = fold && model_exit_status(m) == 0;
+
+   jit_reset_exit_status(m->jit);
+   set_vhdl_assert_counts(counts);
+
+   return fold;
+}
+
 static res_memo_t *memo_resolution_fn(rt_model_t *m, rt_signal_t *signal,
                                       ffi_closure_t *closure, int32_t nlits,
                                       res_flags_t flags)
@@ -1026,6 +1293,7 @@ static res_memo_t *memo_resolution_fn(rt_model_t *m, rt_signal_t *signal,
 
    memo = static_alloc(m, sizeof(res_memo_t));
    memo->flags = flags;
+   memo->nlits = nlits;
 
    assert(closure->nargs == 1);
    ffi_copy_closure(&memo->closure, closure);
@@ -1071,6 +1339,8 @@ static res_memo_t *memo_resolution_fn(rt_model_t *m, rt_signal_t *signal,
       memo->flags |= R_MEMO;
       if (identity)
          memo->flags |= R_IDENT;
+      if (memo_can_fold(m, memo))
+         memo->flags |= R_FOLD;
    }
 
    TRACE("memoised resolution function %pi for type %pT",
@@ -1397,6 +1667,20 @@ static waveform_t *alloc_waveform(rt_model_t *m)
 {
    model_thread_t *thread = model_thread(m);
 
+   if (thread->free_waveforms == NULL && m->parallel) {
+      // The main thread may also be running a batch so only take from
+      // the list it set aside before starting the workers
+      PARALLEL_LOCK(m, m->memlock);
+      thread->free_waveforms = m->spare_waveforms;
+      m->spare_waveforms = NULL;
+   }
+   else if (thread->free_waveforms == NULL && thread != m->threads[0]) {
+      // Waveforms are mostly released by the main thread during the
+      // driver update phase so take over its free list
+      thread->free_waveforms = m->threads[0]->free_waveforms;
+      m->threads[0]->free_waveforms = NULL;
+   }
+
    if (thread->free_waveforms == NULL) {
       // Ensure waveforms are always within one cache line
       STATIC_ASSERT(sizeof(waveform_t) <= 32);
@@ -1463,7 +1747,7 @@ static void clone_source(rt_model_t *m, rt_nexus_t *nexus,
          if (old->u.port.input->width == offset)
             new->u.port.input = old->u.port.input->chain;  // Cycle breaking
          else {
-            RT_LOCK(old->u.port.input->signal->lock);
+            PARALLEL_LOCK(m, old->u.port.input->signal->lock);
             rt_nexus_t *n = clone_nexus(m, old->u.port.input, offset);
             new->u.port.input = n;
          }
@@ -1487,7 +1771,8 @@ static void clone_source(rt_model_t *m, rt_nexus_t *nexus,
          if ((nexus->flags & NET_F_FAST_DRIVER) && old->fastqueued) {
             rt_nexus_t *n0 = &(nexus->signal->nexus);
             if (!n0->sources.sigqueued)
-               deferq_do(&m->driverq, async_fast_driver, new);
+               deferq_do(local_deferq(m, &m->driverq), async_fast_driver,
+                         new);
             new->fastqueued = 1;
          }
 
@@ -1525,38 +1810,60 @@ static void clone_source(rt_model_t *m, rt_nexus_t *nexus,
    }
 }
 
+static uint32_t alloc_nexus_id(rt_model_t *m)
+{
+   PARALLEL_LOCK(m, m->memlock);
+
+   const uint32_t id = m->n_nexus_ids++;
+   if ((id & NEXUS_CHUNK_MASK) == 0) {
+      // Chunks are never moved once allocated so other threads can
+      // keep using their nexuses while new ones are created
+      if ((id >> NEXUS_CHUNK_BITS) >= NEXUS_MAX_CHUNKS)
+         fatal("design has more than %u signal sub-elements",
+               NEXUS_MAX_CHUNKS * NEXUS_CHUNK_SIZE);
+
+      m->nexus_chunks[id >> NEXUS_CHUNK_BITS] = xmalloc(sizeof(nexus_chunk_t));
+   }
+
+   return id;
+}
+
 static rt_nexus_t *clone_nexus(rt_model_t *m, rt_nexus_t *old, int offset)
 {
    assert(offset < old->width);
 
    rt_signal_t *signal = old->signal;
    MULTITHREADED_ONLY(assert_lock_held(&signal->lock));
+   assert(!m->parallel || __lock_depth > 0);
    signal->n_nexus++;
 
    if (signal->n_nexus == 2 && (old->flags & NET_F_FAST_DRIVER))
       signal->shared.flags |= NET_F_FAST_DRIVER;
 
    rt_nexus_t *new = static_alloc(m, sizeof(rt_nexus_t));
-   new->width        = old->width - offset;
-   new->size         = old->size;
-   new->signal       = signal;
-   new->offset       = old->offset + offset * old->size;
-   new->chain        = old->chain;
-   new->flags        = old->flags;
-   new->active_delta = old->active_delta;
-   new->event_delta  = old->event_delta;
-   new->last_event   = old->last_event;
-   new->rank         = old->rank;
+   new->width  = old->width - offset;
+   new->size   = old->size;
+   new->signal = signal;
+   new->offset = old->offset + offset * old->size;
+   new->chain  = old->chain;
+   new->flags  = old->flags;
+   new->rank   = old->rank;
+   new->id     = alloc_nexus_id(m);
+
+   NEXUS_HOT(m, new, active_delta) = NEXUS_HOT(m, old, active_delta);
+   NEXUS_HOT(m, new, event_delta)  = NEXUS_HOT(m, old, event_delta);
+   NEXUS_HOT(m, new, last_event)   = NEXUS_HOT(m, old, last_event);
 
    old->chain = new;
    old->width = offset;
 
-   if (old->pending == NULL)
-      new->pending = NULL;
-   else if (pointer_tag(old->pending) == 1)
-      new->pending = old->pending;
+   void *old_pending = NEXUS_HOT(m, old, pending);
+   if (old_pending == NULL)
+      NEXUS_HOT(m, new, pending) = NULL;
+   else if (pointer_tag(old_pending) == 1)
+      NEXUS_HOT(m, new, pending) = old_pending;
    else {
-      rt_pending_t *old_p = untag_pointer(old->pending, rt_pending_t);
+      rt_pending_t *old_p = untag_pointer(old_pending, rt_pending_t);
       rt_pending_t *new_p = xmalloc_flex(sizeof(rt_pending_t), old_p->count,
                                          sizeof(rt_wakeable_t *));
 
@@ -1565,7 +1872,7 @@ static rt_nexus_t *clone_nexus(rt_model_t *m, rt_nexus_t *old, int offset)
       for (int i = 0; i < old_p->count; i++)
          new_p->wake[i] = old_p->wake[i];
 
-      new->pending = tag_pointer(new_p, 0);
+      NEXUS_HOT(m, new, pending) = tag_pointer(new_p, 0);
    }
 
    if (new->chain == NULL)
@@ -1584,7 +1891,7 @@ static rt_nexus_t *clone_nexus(rt_model_t *m, rt_nexus_t *old, int offset)
             if (old_o->u.port.output->width == offset)
                out_n = old_o->u.port.output->chain;   // Cycle breaking
             else {
-               RT_LOCK(old_o->u.port.output->signal->lock);
+               PARALLEL_LOCK(m, old_o->u.port.output->signal->lock);
                out_n = clone_nexus(m, old_o->u.port.output, offset);
             }
 
@@ -1625,11 +1932,37 @@ static rt_nexus_t *clone_nexus(rt_model_t *m, rt_nexus_t *old, int offset)
    return new;
 }
 
+static bool split_needs_clone(rt_signal_t *s, int offset, int count)
+{
+   for (rt_nexus_t *it = lookup_index(s, &offset); count > 0; it = it->chain) {
+      if (offset >= it->width)
+         offset -= it->width;
+      else if (offset > 0 || it->width > count)
+         return true;
+      else
+         count -= it->width;
+   }
+
+   return false;
+}
+
 static rt_nexus_t *split_nexus_slow(rt_model_t *m, rt_signal_t *s,
                                     int offset, int count)
 {
    assert(offset + count <= s->shared.size / s->nexus.size);
 
+   if (m->parallel && __lock_depth == 0
+       && split_needs_clone(s, offset, count)) {
+      // Cloning a nexus also locks the signals connected to it through
+      // ports so drop the signal lock and reacquire it after the model
+      // lock to keep the lock order consistent
+      nvc_unlock(&s->lock);
+      MODEL_LOCK(m);
+      nvc_lock(&s->lock);
+
+      return split_nexus_slow(m, s, offset, count);
+   }
+
    rt_nexus_t *result = NULL;
    for (rt_nexus_t *it = lookup_index(s, &offset); count > 0; it = it->chain) {
       if (offset >= it->width) {
@@ -1685,16 +2018,18 @@ static void setup_signal(rt_model_t *m, rt_signal_t *s, tree_t where,
 
    APUSH(parent->signals, s);
 
-   s->nexus.width        = count;
-   s->nexus.size         = size;
-   s->nexus.n_sources    = 0;
-   s->nexus.offset       = 0;
-   s->nexus.flags        = flags | NET_F_FAST_DRIVER | NET_F_HAS_INITIAL;
-   s->nexus.signal       = s;
-   s->nexus.pending      = NULL;
-   s->nexus.active_delta = DELTA_CYCLE_MAX;
-   s->nexus.event_delta  = DELTA_CYCLE_MAX;
-   s->nexus.last_event   = TIME_HIGH;
+   s->nexus.width     = count;
+   s->nexus.size      = size;
+   s->nexus.n_sources = 0;
+   s->nexus.offset    = 0;
+   s->nexus.flags     = flags | NET_F_FAST_DRIVER | NET_F_HAS_INITIAL;
+   s->nexus.signal    = s;
+   s->nexus.id        = alloc_nexus_id(m);
+
+   NEXUS_HOT(m, &(s->nexus), pending)      = NULL;
+   NEXUS_HOT(m, &(s->nexus), active_delta) = DELTA_CYCLE_MAX;
+   NEXUS_HOT(m, &(s->nexus), event_delta)  = DELTA_CYCLE_MAX;
+   NEXUS_HOT(m, &(s->nexus), last_event)   = TIME_HIGH;
 
    *m->nexus_tail = &(s->nexus);
    m->nexus_tail = &(s->nexus.chain);
@@ -1840,8 +2175,30 @@ static void call_resolution(rt_model_t *m, rt_nexus_t *n, res_memo_t *r,
            s1 = s1->chain_input)
          ;
 
-      for (int j = 0; j < n->width; j++)
-         ((int8_t *)resolved)[j] = r->tab2[(int)p0[j]][(int)p1[j]];
+      memcpy(resolved, p0, n->width);
+      fold_bytes(resolved, p1, r->tab2, r->nlits, n->width);
+
+      put_driving(m, n, resolved);
+      tlab_trim(thread->tlab, mark);
+   }
+   else if ((r->flags & R_FOLD) && nonnull > 2) {
+      // Resolution function is a left fold over the two value table so
+      // combine each source in turn with the running result
+
+      model_thread_t *thread = model_thread(m);
+      assert(thread->tlab != NULL);
+      assert(n->size == 1);
+
+      const uint32_t mark = tlab_mark(thread->tlab);
+
+      void *resolved = tlab_alloc(thread->tlab, n->width);
+      memcpy(resolved, source_value(n, s0), n->width);
+
+      for (rt_source_t *s = s0->chain_input; s; s = s->chain_input) {
+         const void *p = source_value(n, s);
+         if (p != NULL)
+            fold_bytes(resolved, p, r->tab2, r->nlits, n->width);
+      }
 
       put_driving(m, n, resolved);
       tlab_trim(thread->tlab, mark);
@@ -1872,7 +2229,7 @@ static void call_resolution(rt_model_t *m, rt_nexus_t *n, res_memo_t *r,
          put_driving(m, n, result.pointer + n->signal->offset
                      + n->offset - rscope->offset);
       else
-         m->force_stop = true;
+         relaxed_store(&m->force_stop, true);
 
       tlab_trim(thread->tlab, mark);
    }
@@ -1898,7 +2255,7 @@ static void call_resolution(rt_model_t *m, rt_nexus_t *n, res_memo_t *r,
             jit_scalar_t result;                                        \
             if (!jit_try_call(m->jit, r->closure.handle, &result,       \
                               r->closure.args[0], vals, nonnull))       \
-               m->force_stop = true;                                    \
+               relaxed_store(&m->force_stop, true);                     \
             p[j] = result.integer;                                      \
          } while (0)
 
@@ -2103,7 +2460,7 @@ static void dump_one_signal(rt_model_t *m, rt_scope_t *scope, rt_signal_t *s,
               nth == 0 ? tb_get(tb) : "+",
               n->width, n->size, n->n_sources, n_outputs, n->rank);
 
-      if (n->event_delta == m->iteration && n->last_event == m->now)
+      if (nexus_event(m, n))
          fprintf(stderr, "%s -> ", fmt_nexus(n, nexus_last_value(n)));
 
       fputs(fmt_nexus(n, nexus_effective(n)), stderr);
@@ -2218,6 +2575,177 @@ static void check_undriven_std_logic(rt_nexus_t *n)
    n->signal->shared.flags &= ~SIG_F_STD_LOGIC;
 }
 
+static void parallel_safe_cb(tree_t t, void *context)
+{
+   bool *safe = context;
+
+   switch (tree_kind(t)) {
+   case T_PCALL:
+   case T_PROT_PCALL:
+   case T_PROT_FCALL:
+      *safe = false;
+      break;
+   case T_ASSERT:
+   case T_REPORT:
+      // The order of diagnostics and the assertion counts must not
+      // depend on thread scheduling
+      *safe = false;
+      break;
+   case T_FCALL:
+      if (tree_has_ref(t) && (tree_flags(tree_ref(t)) & TREE_F_IMPURE))
+         *safe = false;
+      break;
+   case T_REF:
+      if (tree_has_ref(t)) {
+         tree_t decl = tree_ref(t);
+         switch (tree_kind(decl)) {
+         case T_VAR_DECL:
+            if (tree_flags(decl) & TREE_F_SHARED)
+               *safe = false;
+            break;
+         case T_FILE_DECL:
+            *safe = false;
+            break;
+         default:
+            break;
+         }
+      }
+      break;
+   default:
+      break;
+   }
+}
+
+static bool is_parallel_safe(tree_t proc)
+{
+   // A process can execute concurrently with other processes if it only
+   // communicates through signals: pure functions cannot access shared
+   // variables or files but procedures and impure functions may
+   bool safe = !(tree_flags(proc) & TREE_F_POSTPONED);
+   tree_visit(proc, parallel_safe_cb, &safe);
+   return safe;
+}
+
+typedef struct {
+   tree_t wait;
+   bool   comb;
+} comb_check_t;
+
+static bool is_sensitive_to(tree_t wait, tree_t decl)
+{
+   const int ntriggers = tree_triggers(wait);
+   for (int i = 0; i < ntriggers; i++) {
+      tree_t ref = name_to_ref(tree_trigger(wait, i));
+      if (ref != NULL && tree_has_ref(ref) && tree_ref(ref) == decl)
+         return true;
+   }
+
+   return false;
+}
+
+static void combinational_cb(tree_t t, void *context)
+{
+   comb_check_t *cc = context;
+
+   switch (tree_kind(t)) {
+   case T_WAIT:
+      if (t != cc->wait)
+         cc->comb = false;
+      break;
+   case T_WAVEFORM:
+      if (tree_has_delay(t))
+         cc->comb = false;
+      break;
+   case T_PCALL:
+   case T_PROT_PCALL:
+      if (!tree_has_ref(t) || !(tree_flags(tree_ref(t)) & TREE_F_NEVER_WAITS))
+         cc->comb = false;
+      break;
+   case T_FORCE:
+   case T_RELEASE:
+   case T_EXTERNAL_NAME:
+      cc->comb = false;
+      break;
+   case T_ATTR_REF:
+      // An edge or event test means the process is clocked and must
+      // sample its inputs before any signal updates in this cycle
+      switch (tree_subkind(t)) {
+      case ATTR_EVENT:
+      case ATTR_ACTIVE:
+      case ATTR_LAST_EVENT:
+      case ATTR_LAST_ACTIVE:
+      case ATTR_LAST_VALUE:
+      case ATTR_STABLE:
+      case ATTR_QUIET:
+      case ATTR_DELAYED:
+      case ATTR_TRANSACTION:
+         cc->comb = false;
+         break;
+      default:
+         break;
+      }
+      break;
+   case T_FCALL:
+   case T_PROT_FCALL:
+      // Functions such as rising_edge with a signal parameter can
+      // test for events on the actual
+      if (!tree_has_ref(t))
+         cc->comb = false;
+      else {
+         tree_t decl = tree_ref(t);
+         const int nports = tree_ports(decl);
+         for (int i = 0; i < nports; i++) {
+            if (tree_class(tree_port(decl, i)) == C_SIGNAL)
+               cc->comb = false;
+         }
+      }
+      break;
+   default:
+      break;
+   }
+}
+
+static void combinational_read_cb(tree_t expr, void *context)
+{
+   comb_check_t *cc = context;
+
+   tree_t ref = name_to_ref(expr);
+   if (ref == NULL || !tree_has_ref(ref))
+      cc->comb = false;
+   else if (!is_sensitive_to(cc->wait, tree_ref(ref)))
+      cc->comb = false;
+}
+
+static bool is_combinational(tree_t proc)
+{
+   // A process can be evaluated in the signal update phase if it only
+   // waits on a static sensitivity list containing every signal it
+   // references and its signal assignments have no delay
+   if (tree_flags(proc) & TREE_F_POSTPONED)
+      return false;
+
+   const int nstmts = tree_stmts(proc);
+   if (nstmts < 2)
+      return false;
+
+   tree_t wait = tree_stmt(proc, nstmts - 1);
+   if (tree_kind(wait) != T_WAIT || !(tree_flags(wait) & TREE_F_STATIC_WAIT))
+      return false;
+   else if (tree_has_value(wait) || tree_has_delay(wait))
+      return false;
+
+   comb_check_t cc = { wait, true };
+   for (int i = 0; i < nstmts - 1 && cc.comb; i++)
+      tree_visit(tree_stmt(proc, i), combinational_cb, &cc);
+
+   // Only check the read set once there are no other wait statements
+   // as these are not allowed in the body of an all-sensitised process
+   for (int i = 0; i < nstmts - 1 && cc.comb; i++)
+      build_wait(tree_stmt(proc, i), combinational_read_cb, &cc);
+
+   return cc.comb;
+}
+
 static void create_processes(rt_model_t *m, rt_scope_t *s)
 {
    for (int i = 0; i < s->children.count; i++) {
@@ -2246,55 +2774,430 @@ static void create_processes(rt_model_t *m, rt_scope_t *s)
             ident_t name = tree_ident(t);
             ident_t sym = ident_prefix(sym_prefix, name, '.');
 
-            rt_proc_t *p = xcalloc(sizeof(rt_proc_t));
-            p->where     = t;
-            p->name      = ident_prefix(path, ident_downcase(name), ':');
-            p->scope     = s;
-            p->privdata  = mptr_new(m->mspace, "process privdata");
+            rt_proc_t *p = xcalloc(sizeof(rt_proc_t));
+            p->where     = t;
+            p->name      = ident_prefix(path, ident_downcase(name), ':');
+            p->scope     = s;
+            p->privdata  = mptr_new(m->mspace, "process privdata");
+
+            p->closure.handle = jit_lazy_compile(m->jit, sym);
+            p->closure.nargs = 1;
+            p->closure.args[0].pointer = NULL;
+
+            p->wakeable.kind      = W_PROC;
+            p->wakeable.pending   = false;
+            p->wakeable.delayed   = false;
+            p->wakeable.postponed = !!(tree_flags(t) & TREE_F_POSTPONED);
+            p->wakeable.parallel  = m->workq != NULL && is_parallel_safe(t);
+            p->wakeable.levelised = m->levelise && is_combinational(t);
+
+            APUSH(s->procs, p);
+         }
+         break;
+
+      case T_PSL_DIRECT:
+         {
+            psl_node_t psl = tree_psl(t);
+
+            const psl_kind_t kind = psl_kind(psl);
+            if (kind != P_ASSERT && kind != P_COVER)
+               continue;
+
+            ident_t name = tree_ident(t);
+            ident_t sym = ident_prefix(sym_prefix, name, '.');
+
+            rt_prop_t *p = xcalloc(sizeof(rt_prop_t));
+            p->where    = tree_psl(t);
+            p->handle   = jit_lazy_compile(m->jit, sym);
+            p->scope    = s;
+            p->name     = sym;
+            p->privdata = mptr_new(m->mspace, "property privdata");
+
+            p->wakeable.kind    = W_PROPERTY;
+            p->wakeable.pending = false;
+            p->wakeable.delayed = false;
+
+            APUSH(s->properties, p);
+         }
+         break;
+
+      default:
+         break;
+      }
+   }
+}
+
+static void precompile_scope(rt_model_t *m, rt_scope_t *s)
+{
+   for (int i = 0; i < s->children.count; i++) {
+      if (s->children.items[i]->kind == SCOPE_INSTANCE)
+         precompile_scope(m, s->children.items[i]);
+   }
+
+   if (s->kind != SCOPE_INSTANCE)
+      return;
+
+   tree_t hier = tree_decl(s->where, 0);
+   assert(tree_kind(hier) == T_HIER);
+
+   ident_t sym_prefix = tree_ident2(hier);
+
+   // Processes are not created until reset so register placeholders
+   // for them here using the same names as create_processes
+   const int nstmts = tree_stmts(s->where);
+   for (int i = 0; i < nstmts; i++) {
+      tree_t t = tree_stmt(s->where, i);
+      switch (tree_kind(t)) {
+      case T_PSL_DIRECT:
+         {
+            const psl_kind_t kind = psl_kind(tree_psl(t));
+            if (kind != P_ASSERT && kind != P_COVER)
+               continue;
+         }
+         // Fall-through
+      case T_PROCESS:
+         {
+            ident_t sym = ident_prefix(sym_prefix, tree_ident(t), '.');
+            (void)jit_lazy_compile(m->jit, sym);
+         }
+         break;
+      default:
+         break;
+      }
+   }
+}
+
+void model_precompile(rt_model_t *m)
+{
+   MODEL_ENTRY(m);
+
+   precompile_scope(m, m->root);
+   jit_precompile(m->jit);
+}
+
+typedef struct {
+   uint32_t from;
+   uint32_t to;
+} level_edge_t;
+
+typedef A(level_edge_t) level_edge_list_t;
+
+static void collect_levelised(rt_scope_t *s, proc_list_t *procs)
+{
+   for (int i = 0; i < s->children.count; i++)
+      collect_levelised(s->children.items[i], procs);
+
+   for (int i = 0; i < s->procs.count; i++) {
+      rt_proc_t *p = s->procs.items[i];
+      if (p->wakeable.levelised) {
+         p->level = procs->count;
+         APUSH(*procs, p);
+      }
+   }
+}
+
+static void add_level_edges(rt_nexus_t *n, rt_proc_t *reader, int depth,
+                            level_edge_list_t *edges)
+{
+   if (n->n_sources == 0 || depth > MAX_RANK)
+      return;
+
+   for (rt_source_t *s = &(n->sources); s; s = s->chain_input) {
+      switch (s->tag) {
+      case SOURCE_DRIVER:
+         {
+            rt_proc_t *p = s->u.driver.proc;
+            if (p != NULL && p->wakeable.levelised && p != reader)
+               APUSH(*edges, ((level_edge_t){ p->level, reader->level }));
+         }
+         break;
+      case SOURCE_PORT:
+         add_level_edges(s->u.port.input, reader, depth + 1, edges);
+         break;
+      default:
+         break;
+      }
+   }
+}
+
+static void add_nexus_readers(rt_nexus_t *n, rt_wakeable_t *obj,
+                              level_edge_list_t *edges)
+{
+   if (obj != NULL && obj->kind == W_PROC && obj->levelised)
+      add_level_edges(n, container_of(obj, rt_proc_t, wakeable), 0, edges);
+}
+
+static void levelise_processes(rt_model_t *m)
+{
+   // Assign each combinational process a level one greater than the
+   // highest level of any combinational process driving a signal in
+   // its sensitivity list so that running them in level order
+   // evaluates each at most once per cycle
+
+   proc_list_t procs = AINIT;
+   collect_levelised(m->root, &procs);
+
+   if (procs.count == 0)
+      return;
+
+   level_edge_list_t edges = AINIT;
+   for (rt_nexus_t *n = m->nexuses; n != NULL; n = n->chain) {
+      void *pending = NEXUS_HOT(m, n, pending);
+      if (pending == NULL)
+         continue;
+      else if (pointer_tag(pending) == 1)
+         add_nexus_readers(n, untag_pointer(pending, rt_wakeable_t), &edges);
+      else {
+         rt_pending_t *p = untag_pointer(pending, rt_pending_t);
+         for (int i = 0; i < p->count; i++) {
+            rt_wakeable_t *obj = untag_pointer(p->wake[i], rt_wakeable_t);
+            add_nexus_readers(n, obj, &edges);
+         }
+      }
+   }
+
+   const unsigned nprocs = procs.count;
+   unsigned *indegree = xcalloc_array(nprocs, sizeof(unsigned));
+   unsigned *first = xcalloc_array(nprocs + 1, sizeof(unsigned));
+   unsigned *succ = xmalloc_array(MAX(edges.count, 1), sizeof(unsigned));
+   unsigned *queue = xmalloc_array(nprocs, sizeof(unsigned));
+   uint32_t *level = xcalloc_array(nprocs, sizeof(uint32_t));
+
+   for (int i = 0; i < edges.count; i++) {
+      first[edges.items[i].from + 1]++;
+      indegree[edges.items[i].to]++;
+   }
+
+   for (unsigned i = 0; i < nprocs; i++)
+      first[i + 1] += first[i];
+
+   // Use the queue as the insertion cursor for each successor list
+   memcpy(queue, first, nprocs * sizeof(unsigned));
+   for (int i = 0; i < edges.count; i++)
+      succ[queue[edges.items[i].from]++] = edges.items[i].to;
+
+   unsigned head = 0, tail = 0, maxlevel = 0;
+   for (unsigned i = 0; i < nprocs; i++) {
+      if (indegree[i] == 0)
+         queue[tail++] = i;
+   }
+
+   while (head < tail) {
+      const unsigned u = queue[head++];
+      maxlevel = MAX(maxlevel, level[u]);
+
+      for (unsigned j = first[u]; j < first[u + 1]; j++) {
+         const unsigned v = succ[j];
+         level[v] = MAX(level[v], level[u] + 1);
+         if (--indegree[v] == 0)
+            queue[tail++] = v;
+      }
+   }
+
+   // Processes in a combinational loop are never ready so run them
+   // after everything else: they can still only run once per cycle
+   for (unsigned i = 0; i < nprocs; i++) {
+      procs.items[i]->level = indegree[i] > 0 ? maxlevel + 1 : level[i];
+      procs.items[i]->level_epoch = UINT32_MAX;
+   }
+
+   TRACE("levelised %u combinational processes with %u levels%s",
+         nprocs, maxlevel + 1, tail < nprocs ? " and loops" : "");
+
+   free(indegree);
+   free(first);
+   free(succ);
+   free(queue);
+   free(level);
+   ACLEAR(edges);
+   ACLEAR(procs);
+}
+
+typedef A(rt_nexus_t *) nexus_list_t;
+
+typedef struct {
+   rt_proc_t    *proc;
+   unsigned      order;
+   nexus_list_t  nexus;
+} fuse_info_t;
+
+static bool can_fuse_process(rt_proc_t *p)
+{
+   if (p->wakeable.postponed || p->wakeable.reschedule)
+      return false;
+   else if (p->wakeable.levelised)
+      return false;
+   else if (p->wakeable.trigger != NULL
+            && p->wakeable.trigger->kind == EDGE_TRIGGER)
+      return false;   // Not on the pending list of the clock nexus
+   else if (tree_kind(p->where) != T_PROCESS)
+      return false;
+
+   // Processes with a static wait only register for events during reset
+   const int nstmts = tree_stmts(p->where);
+   if (nstmts == 0)
+      return false;
+
+   tree_t wait = tree_stmt(p->where, nstmts - 1);
+   return tree_kind(wait) == T_WAIT && (tree_flags(wait) & TREE_F_STATIC_WAIT);
+}
+
+static void collect_fusable(rt_scope_t *s, proc_list_t *procs)
+{
+   for (int i = 0; i < s->children.count; i++)
+      collect_fusable(s->children.items[i], procs);
+
+   for (int i = 0; i < s->procs.count; i++) {
+      rt_proc_t *p = s->procs.items[i];
+      if (can_fuse_process(p))
+         APUSH(*procs, p);
+   }
+}
+
+static int compare_sensitivity(const fuse_info_t *a, const fuse_info_t *b)
+{
+   if (a->nexus.count != b->nexus.count)
+      return a->nexus.count < b->nexus.count ? -1 : 1;
+
+   for (int i = 0; i < a->nexus.count; i++) {
+      const uintptr_t na = (uintptr_t)a->nexus.items[i];
+      const uintptr_t nb = (uintptr_t)b->nexus.items[i];
+      if (na != nb)
+         return na < nb ? -1 : 1;
+   }
+
+   return 0;
+}
+
+static int fuse_info_cmp(const void *a, const void *b)
+{
+   const fuse_info_t *fa = a, *fb = b;
+
+   const int cmp = compare_sensitivity(fa, fb);
+   if (cmp != 0)
+      return cmp;
+
+   return (int)fa->order - (int)fb->order;
+}
+
+static void replace_group_members(rt_model_t *m, rt_nexus_t *n,
+                                  ihash_t *groups, rt_group_t *g)
+{
+   // Replace the first member of the group in the pending list with the
+   // group itself and remove the others
+   void *pending = NEXUS_HOT(m, n, pending);
+   assert(pointer_tag(pending) == 0);
+
+   rt_pending_t *p = untag_pointer(pending, rt_pending_t);
+
+   bool placed = false;
+   unsigned wptr = 0;
+   for (int i = 0; i < p->count; i++) {
+      rt_wakeable_t *obj = p->wake[i];
+      if (obj != NULL && ihash_get(groups, (uintptr_t)obj) == g) {
+         if (placed)
+            continue;
+
+         obj = &(g->wakeable);
+         placed = true;
+      }
+
+      p->wake[wptr++] = obj;
+   }
+
+   assert(placed);
+   p->count = wptr;
+}
+
+static void fuse_processes(rt_model_t *m)
+{
+   // A process with a static sensitivity list is only ever woken by
+   // events on the same set of nexuses so processes with identical sets
+   // can share one entry in each pending list and run from one task
 
-            p->closure.handle = jit_lazy_compile(m->jit, sym);
-            p->closure.nargs = 1;
-            p->closure.args[0].pointer = NULL;
+   proc_list_t procs = AINIT;
+   collect_fusable(m->root, &procs);
 
-            p->wakeable.kind      = W_PROC;
-            p->wakeable.pending   = false;
-            p->wakeable.delayed   = false;
-            p->wakeable.postponed = !!(tree_flags(t) & TREE_F_POSTPONED);
+   if (procs.count < 2) {
+      ACLEAR(procs);
+      return;
+   }
 
-            APUSH(s->procs, p);
-         }
-         break;
+   const unsigned nprocs = procs.count;
+   fuse_info_t *info = xcalloc_array(nprocs, sizeof(fuse_info_t));
+   ihash_t *map = ihash_new(nprocs * 2);
 
-      case T_PSL_DIRECT:
-         {
-            psl_node_t psl = tree_psl(t);
+   for (unsigned i = 0; i < nprocs; i++) {
+      info[i].proc = procs.items[i];
+      info[i].order = i;
+      ihash_put(map, (uintptr_t)&(procs.items[i]->wakeable), &(info[i]));
+   }
 
-            const psl_kind_t kind = psl_kind(psl);
-            if (kind != P_ASSERT && kind != P_COVER)
+   for (rt_nexus_t *n = m->nexuses; n != NULL; n = n->chain) {
+      void *pending = NEXUS_HOT(m, n, pending);
+      if (pending == NULL)
+         continue;
+      else if (pointer_tag(pending) == 1) {
+         rt_wakeable_t *obj = untag_pointer(pending, rt_wakeable_t);
+         fuse_info_t *fi = ihash_get(map, (uintptr_t)obj);
+         if (fi != NULL)
+            APUSH(fi->nexus, n);
+      }
+      else {
+         rt_pending_t *p = untag_pointer(pending, rt_pending_t);
+         for (int i = 0; i < p->count; i++) {
+            if (p->wake[i] == NULL)
                continue;
 
-            ident_t name = tree_ident(t);
-            ident_t sym = ident_prefix(sym_prefix, name, '.');
+            fuse_info_t *fi = ihash_get(map, (uintptr_t)p->wake[i]);
+            if (fi != NULL)
+               APUSH(fi->nexus, n);
+         }
+      }
+   }
 
-            rt_prop_t *p = xcalloc(sizeof(rt_prop_t));
-            p->where    = tree_psl(t);
-            p->handle   = jit_lazy_compile(m->jit, sym);
-            p->scope    = s;
-            p->name     = sym;
-            p->privdata = mptr_new(m->mspace, "property privdata");
+   qsort(info, nprocs, sizeof(fuse_info_t), fuse_info_cmp);
 
-            p->wakeable.kind    = W_PROPERTY;
-            p->wakeable.pending = false;
-            p->wakeable.delayed = false;
+   ihash_t *groups = ihash_new(nprocs * 2);
+   unsigned ngroups = 0, nfused = 0;
 
-            APUSH(s->properties, p);
-         }
-         break;
+   for (unsigned i = 0, j; i < nprocs; i = j) {
+      for (j = i + 1; j < nprocs; j++) {
+         if (compare_sensitivity(&(info[i]), &(info[j])) != 0)
+            break;
+      }
 
-      default:
-         break;
+      const unsigned count = j - i;
+      if (count < 2 || info[i].nexus.count == 0)
+         continue;
+
+      rt_group_t *g = static_alloc(m, sizeof(rt_group_t)
+                                   + count * sizeof(rt_proc_t *));
+      memset(&(g->wakeable), '\0', sizeof(rt_wakeable_t));
+      g->wakeable.kind = W_GROUP;
+      g->count = count;
+
+      for (unsigned k = 0; k < count; k++) {
+         g->procs[k] = info[i + k].proc;
+         ihash_put(groups, (uintptr_t)&(g->procs[k]->wakeable), g);
       }
+
+      for (int k = 0; k < info[i].nexus.count; k++)
+         replace_group_members(m, info[i].nexus.items[k], groups, g);
+
+      ngroups++;
+      nfused += count;
    }
+
+   TRACE("fused %u processes into %u groups", nfused, ngroups);
+
+   for (unsigned i = 0; i < nprocs; i++)
+      ACLEAR(info[i].nexus);
+
+   free(info);
+   ihash_free(map);
+   ihash_free(groups);
+   ACLEAR(procs);
 }
 
 void model_reset(rt_model_t *m)
@@ -2304,9 +3207,23 @@ void model_reset(rt_model_t *m)
    // Re-read options as these may have changed
    m->stop_delta = opt_get_int(OPT_STOP_DELTA);
    m->shuffle    = opt_get_int(OPT_SHUFFLE_PROCS);
+   m->levelise   = opt_get_int(OPT_LEVELISE);
 
    __trace_on = opt_get_int(OPT_RT_TRACE);
 
+   const int nthreads = opt_get_int(OPT_RT_THREADS);
+   if (nthreads > 1 && m->cover != NULL)
+      warnf("processes will not be executed in parallel as coverage "
+            "collection is enabled");
+   else if (nthreads > 1 && m->shuffle)
+      warnf("processes will not be executed in parallel with the "
+            "$bold$--shuffle$$ option");
+   else if (nthreads > 1) {
+      m->workq    = workq_new(m);
+      m->nbatches = MIN(nthreads, MAX_THREADS);
+      m->batches  = xcalloc_array(m->nbatches, sizeof(model_batch_t));
+   }
+
    create_processes(m, m->root);
 
    nvc_rusage(&m->ready_rusage);
@@ -2318,6 +3235,12 @@ void model_reset(rt_model_t *m)
    if (m->force_stop)
       return;   // Error in intialisation
 
+   if (m->levelise)
+      levelise_processes(m);
+
+   if (opt_get_int(OPT_FUSE_PROCS) && m->workq == NULL && !m->shuffle)
+      fuse_processes(m);
+
 #if TRACE_SIGNALS > 0
    if (__trace_on)
       dump_signals(m, m->root);
@@ -2405,7 +3328,7 @@ static void update_property(rt_model_t *m, rt_prop_t *prop)
 
       if (!jit_vfastcall(m->jit, prop->handle, args, ARRAY_LEN(args),
                          NULL, 0, thread->tlab))
-         m->force_stop = true;
+         relaxed_store(&m->force_stop, true);
    }
 
    tlab_reset(thread->tlab);   // No allocations can be live past here
@@ -2556,26 +3479,27 @@ static void sched_driver(rt_model_t *m, rt_nexus_t *n, uint64_t after,
       rt_source_t *d0 = &(signal->nexus.sources);
 
       if (d->fastqueued)
-         assert(m->next_is_delta);
+         assert(relaxed_load(&m->next_is_delta));
       else if ((signal->shared.flags & NET_F_FAST_DRIVER) && d0->sigqueued) {
-         assert(m->next_is_delta);
+         assert(relaxed_load(&m->next_is_delta));
          d->fastqueued = 1;
       }
-      else if (!will_observe_active(n, value, w)) {
-         m->next_is_delta = true;
-         d->was_active = (n->active_delta == m->iteration);
-         n->active_delta = m->iteration + 1;
+      else if (!m->levelising && !will_observe_active(n, value, w)) {
+         relaxed_store(&m->next_is_delta, true);
+         d->was_active = (NEXUS_HOT(m, n, active_delta) == m->iteration);
+         NEXUS_HOT(m, n, active_delta) = m->iteration + 1;
          return;
       }
       else if (signal->shared.flags & NET_F_FAST_DRIVER) {
-         deferq_do(&m->driverq, async_fast_all_drivers, signal);
-         m->next_is_delta = true;
+         deferq_do(local_deferq(m, &m->driverq), async_fast_all_drivers,
+                   signal);
+         relaxed_store(&m->next_is_delta, true);
          d0->sigqueued = 1;
          d->fastqueued = 1;
       }
       else {
-         deferq_do(&m->driverq, async_fast_driver, d);
-         m->next_is_delta = true;
+         deferq_do(local_deferq(m, &m->driverq), async_fast_driver, d);
+         relaxed_store(&m->next_is_delta, true);
          d->fastqueued = 1;
       }
 
@@ -2663,6 +3587,17 @@ static void async_run_process(rt_model_t *m, void *arg)
    run_process(m, proc);
 }
 
+static void async_run_group(rt_model_t *m, void *arg)
+{
+   rt_group_t *g = arg;
+
+   assert(g->wakeable.pending);
+   g->wakeable.pending = false;
+
+   for (unsigned i = 0; i < g->count; i++)
+      run_process(m, g->procs[i]);
+}
+
 static void async_update_property(rt_model_t *m, void *arg)
 {
    rt_prop_t *prop = arg;
@@ -2673,7 +3608,7 @@ static void async_update_property(rt_model_t *m, void *arg)
    update_property(m, prop);
 }
 
-static bool heap_delete_proc_cb(uint64_t key, void *value, void *search)
+static bool eventq_delete_proc_cb(uint64_t key, void *value, void *search)
 {
    if (pointer_tag(value) != EVENT_PROCESS)
       return false;
@@ -2681,6 +3616,33 @@ static bool heap_delete_proc_cb(uint64_t key, void *value, void *search)
    return untag_pointer(value, rt_proc_t) == search;
 }
 
+static void eventq_delete_proc(rt_model_t *m, rt_proc_t *proc)
+{
+   void *e = tag_pointer(proc, EVENT_PROCESS);
+
+   // May have been scheduled by a process running in another batch
+   for (int i = 0; m->parallel && i < m->nbatches; i++) {
+      model_batch_t *b = &(m->batches[i]);
+      for (int j = 0; j < b->events.count; j++) {
+         if (b->events.items[j].event == e) {
+            b->events.items[j].event = NULL;
+            return;
+         }
+      }
+   }
+
+   wheel_delete(m->eventq, eventq_delete_proc_cb, proc);
+}
+
+static inline bool edge_matches(rt_trigger_t *t)
+{
+   // The mask is a superset of the new values for which the inner
+   // trigger can be true so it only needs to check the low six bits
+   rt_signal_t *s = t->args[0].pointer;
+   const uint8_t value = s->shared.data[t->args[1].integer];
+   return (t->args[2].integer >> (value & 63)) & 1;
+}
+
 static bool run_trigger(rt_model_t *m, rt_trigger_t *t)
 {
    if (t->epoch == m->trigger_epoch)
@@ -2692,7 +3654,7 @@ static bool run_trigger(rt_model_t *m, rt_trigger_t *t)
          tlab_t tlab = jit_null_tlab(m->jit);
          if (!jit_vfastcall(m->jit, t->handle, t->args, t->nargs,
                             &t->result, 1, &tlab))
-            m->force_stop = true;
+            relaxed_store(&m->force_stop, true);
 
          TRACE("run trigger %p %pi ==> %"PRIi64, t,
                jit_get_name(m->jit, t->handle), t->result.integer);
@@ -2736,7 +3698,7 @@ static bool run_trigger(rt_model_t *m, rt_trigger_t *t)
 
          rt_nexus_t *n = split_nexus(m, s, offset, count);
          for (; count > 0; n = n->chain) {
-            if (n->last_event == m->now && n->event_delta == m->iteration) {
+            if (nexus_event(m, n)) {
                t->result.integer = 1;
                break;
             }
@@ -2749,6 +3711,15 @@ static bool run_trigger(rt_model_t *m, rt_trigger_t *t)
                offset, t->result.integer);
       }
       break;
+
+   case EDGE_TRIGGER:
+      {
+         rt_trigger_t *inner = t->args[3].pointer;
+         t->result.integer = edge_matches(t) && run_trigger(m, inner);
+
+         TRACE("edge trigger %p ==> %"PRIi64, t, t->result.integer);
+      }
+      break;
    }
 
    t->epoch = m->trigger_epoch;
@@ -2760,13 +3731,20 @@ static void procq_do(rt_model_t *m, rt_wakeable_t *obj, defer_fn_t fn,
                      void *arg)
 {
    if (obj->postponed)
-      deferq_do(&m->postponedq, fn, arg);
+      deferq_do(local_deferq(m, &m->postponedq), fn, arg);
    else if (obj->reschedule)
-      deferq_do(&m->reschedq, fn, arg);
-   else {
-      deferq_do(&m->procq, fn, arg);
+      deferq_do(local_deferq(m, &m->reschedq), fn, arg);
+   else if (obj->levelised && __batch == NULL
+            && ((rt_proc_t *)arg)->level_epoch != (uint32_t)m->trigger_epoch) {
+      rt_proc_t *proc = arg;
+      heap_insert(m->level_heap, proc->level, proc);
       m->next_is_delta |= m->blocking_update;
    }
+   else {
+      deferq_do(local_deferq(m, &m->procq), fn, arg);
+      if (m->blocking_update)
+         relaxed_store(&m->next_is_delta, true);
+   }
 
    set_pending(obj);
 }
@@ -2786,7 +3764,7 @@ static void wakeup_one(rt_model_t *m, rt_wakeable_t *obj)
          if (proc->wakeable.delayed) {
             // This process was already scheduled to run at a later
             // time so we need to delete it from the simulation queue
-            heap_delete(m->eventq_heap, heap_delete_proc_cb, proc);
+            eventq_delete_proc(m, proc);
             proc->wakeable.delayed = false;
          }
 
@@ -2794,6 +3772,15 @@ static void wakeup_one(rt_model_t *m, rt_wakeable_t *obj)
       }
       break;
 
+   case W_GROUP:
+      {
+         rt_group_t *g = container_of(obj, rt_group_t, wakeable);
+         TRACE("wakeup group of %u processes starting with %s",
+               g->count, istr(g->procs[0]->name));
+         procq_do(m, obj, async_run_group, g);
+      }
+      break;
+
    case W_PROPERTY:
       {
          rt_prop_t *prop = container_of(obj, rt_prop_t, wakeable);
@@ -2828,6 +3815,9 @@ static void wakeup_one(rt_model_t *m, rt_wakeable_t *obj)
          rt_trigger_t *t = container_of(obj, rt_trigger_t, wakeable);
          TRACE("wakeup trigger %p", t);
 
+         if (t->kind == EDGE_TRIGGER && !edge_matches(t))
+            break;   // Wrong edge so nothing waiting can be woken
+
          if (!m->blocking_update) {
             deferq_do(&m->triggerq, async_run_trigger, t);
             set_pending(obj);
@@ -2856,13 +3846,13 @@ static void wakeup_all(rt_model_t *m, void **pending)
 
 static void notify_event(rt_model_t *m, rt_nexus_t *n)
 {
-   n->last_event = m->now;
-   n->event_delta = m->iteration;
+   NEXUS_HOT(m, n, last_event) = m->now;
+   NEXUS_HOT(m, n, event_delta) = m->iteration;
 
    if (n->flags & NET_F_CACHE_EVENT)
       n->signal->shared.flags |= SIG_F_EVENT_FLAG;
 
-   wakeup_all(m, &(n->pending));
+   wakeup_all(m, &NEXUS_HOT(m, n, pending));
 }
 
 static void put_effective(rt_model_t *m, rt_nexus_t *n, const void *value)
@@ -2874,7 +3864,7 @@ static void put_effective(rt_model_t *m, rt_nexus_t *n, const void *value)
 
    const size_t valuesz = n->size * n->width;
 
-   n->active_delta = m->iteration;
+   NEXUS_HOT(m, n, active_delta) = m->iteration;
 
    if (!cmp_bytes(eff, value, valuesz)) {
       copy2(last, eff, value, valuesz);
@@ -2893,7 +3883,7 @@ static void enqueue_effective(rt_model_t *m, rt_nexus_t *n)
 
 static void update_effective(rt_model_t *m, rt_nexus_t *n)
 {
-   n->active_delta = m->iteration;
+   NEXUS_HOT(m, n, active_delta) = m->iteration;
    n->flags &= ~NET_F_PENDING;
 
    calculate_effective_value(m, n);
@@ -2937,18 +3927,18 @@ static void defer_driving_update(rt_model_t *m, rt_nexus_t *n)
 static void update_driving(rt_model_t *m, rt_nexus_t *n, bool safe)
 {
    if (n->n_sources == 1 || safe) {
-      n->active_delta = m->iteration;
+      NEXUS_HOT(m, n, active_delta) = m->iteration;
       n->flags &= ~NET_F_PENDING;
 
       // TODO: add an event epoch or similar
-      n->event_delta = DELTA_CYCLE_MAX;
+      NEXUS_HOT(m, n, event_delta) = DELTA_CYCLE_MAX;
 
       calculate_driving_value(m, n);
 
       // Update output ports if the effective value must be calculated
       // separately or there was an event on this signal
       const bool update_output_ports = !!(n->flags & NET_F_EFFECTIVE)
-         || (n->event_delta == m->iteration && n->last_event == m->now);
+         || nexus_event(m, n);
 
       for (rt_source_t *o = n->outputs; o; o = o->chain_output) {
          switch (o->tag) {
@@ -3095,6 +4085,10 @@ static void iteration_limit_proc_cb(void *fn, void *arg, void *extra)
 
    if (fn == async_run_process)
       proc = arg;
+   else if (fn == async_run_group) {
+      rt_group_t *g = arg;
+      proc = g->procs[0];
+   }
    else if (fn == async_transfer_signal) {
       rt_transfer_t *t = arg;
       proc = t->proc;
@@ -3142,7 +4136,7 @@ static void reached_iteration_limit(rt_model_t *m)
    diag_hint(d, NULL, "you can increase this limit with $bold$--stop-delta$$");
    diag_emit(d);
 
-   m->force_stop = true;
+   relaxed_store(&m->force_stop, true);
 }
 
 static void sync_event_cache(rt_model_t *m)
@@ -3151,8 +4145,7 @@ static void sync_event_cache(rt_model_t *m)
       rt_signal_t *s = m->eventsigs.items[i];
       assert(s->shared.flags & SIG_F_CACHE_EVENT);
 
-      const bool event = s->nexus.last_event == m->now
-         && s->nexus.event_delta == m->iteration;
+      const bool event = nexus_event(m, &(s->nexus));
 
       TRACE("sync event flag %d for %s", event, istr(tree_ident(s->where)));
 
@@ -3163,6 +4156,151 @@ static void sync_event_cache(rt_model_t *m)
    }
 }
 
+static void parallel_batch_cb(void *context, void *arg)
+{
+   rt_model_t *m = context;
+   model_batch_t *b = arg;
+
+   MODEL_ENTRY(m);
+
+   assert(__batch == NULL);
+   __batch = b;
+
+   // Allocate the per-thread state now as this needs the model lock
+   // which cannot be acquired later while holding a signal lock
+   (void)model_thread(m);
+
+   for (int i = 0; i < b->count; i++) {
+      if (i + 1 < b->count)
+         prefetch_read(b->tasks[i + 1].arg);
+
+      run_process(m, b->tasks[i].arg);
+      model_unlock_all(m);
+   }
+
+   __batch = NULL;
+}
+
+static void parallel_run(rt_model_t *m, deferq_t *dq)
+{
+   int nparallel = 0;
+   for (int i = 0; i < dq->count; i++) {
+      if (dq->tasks[i].fn == async_run_process) {
+         rt_proc_t *proc = dq->tasks[i].arg;
+         nparallel += proc->wakeable.parallel;
+      }
+   }
+
+   const int nbatches = MIN(m->nbatches, nparallel / PARALLEL_CHUNK);
+   if (nbatches < 2) {
+      deferq_run(m, dq);   // Not worth the synchronisation overhead
+      return;
+   }
+
+   TRACE("run %d processes in %d parallel batches", nparallel, nbatches);
+
+   // Move the processes that can run concurrently to the front of the
+   // queue preserving their relative order and defer everything else
+   // until after the barrier
+   assert(m->serialq.count == 0);
+
+   int wptr = 0;
+   for (int i = 0; i < dq->count; i++) {
+      const defer_task_t task = dq->tasks[i];
+      if (task.fn == async_run_process
+          && ((rt_proc_t *)task.arg)->wakeable.parallel) {
+         rt_proc_t *proc = task.arg;
+         assert(proc->wakeable.pending);
+         proc->wakeable.pending = false;
+
+         dq->tasks[wptr++] = task;
+      }
+      else
+         deferq_do(&m->serialq, task.fn, task.arg);
+   }
+
+   assert(wptr == nparallel);
+
+   for (int i = 0; i < nbatches; i++) {
+      const int first = (i * nparallel) / nbatches;
+      const int last = ((i + 1) * nparallel) / nbatches;
+
+      model_batch_t *b = &(m->batches[i]);
+      b->tasks = dq->tasks + first;
+      b->count = last - first;
+
+      workq_do(m->workq, parallel_batch_cb, b);
+   }
+
+   // Waveforms are mostly released by the main thread during the driver
+   // update phase so set aside its free list for the workers
+   if (m->spare_waveforms == NULL) {
+      m->spare_waveforms = m->threads[0]->free_waveforms;
+      m->threads[0]->free_waveforms = NULL;
+   }
+
+   m->parallel = true;
+   workq_start(m->workq);
+   workq_drain(m->workq);
+   m->parallel = false;
+
+   dq->count = 0;
+
+   // Merge the deferred work in batch order so the scheduling is the
+   // same regardless of which thread executed each batch
+   for (int i = 0; i < nbatches; i++) {
+      model_batch_t *b = &(m->batches[i]);
+
+      deferq_concat(&m->procq, &b->procq);
+      deferq_concat(&m->driverq, &b->driverq);
+      deferq_concat(&m->postponedq, &b->postponedq);
+      deferq_concat(&m->nonblockq, &b->nonblockq);
+      deferq_concat(&m->serialq, &b->reschedq);
+
+      for (int j = 0; j < b->events.count; j++) {
+         const batch_event_t *be = &(b->events.items[j]);
+         if (be->event != NULL)
+            wheel_insert(m->eventq, be->when, be->event);
+      }
+
+      for (int j = 0; j < b->eventsigs.count; j++)
+         APUSH(m->eventsigs, b->eventsigs.items[j]);
+
+      ATRIM(b->events, 0);
+      ATRIM(b->eventsigs, 0);
+      b->tasks = NULL;
+      b->count = 0;
+   }
+
+   deferq_run(m, &m->serialq);
+}
+
+static void run_levelised(rt_model_t *m, rt_proc_t *proc)
+{
+   // Combinational processes run in the signal update phase in order of
+   // their level and their zero delay assignments take effect straight
+   // away rather than in the next delta cycle
+
+   assert(proc->wakeable.pending);
+   proc->wakeable.pending = false;
+   proc->level_epoch = m->trigger_epoch;
+
+   const bool next_is_delta = m->next_is_delta;
+   const unsigned mark = m->driverq.count;
+
+   m->levelising = true;
+   run_process(m, proc);
+   m->levelising = false;
+
+   const unsigned end = m->driverq.count;
+   for (unsigned i = mark; i < end; i++)
+      (*m->driverq.tasks[i].fn)(m, m->driverq.tasks[i].arg);
+
+   assert(m->driverq.count == end);
+   m->driverq.count = mark;
+   m->next_is_delta = next_is_delta;
+}
+
 static void model_cycle(rt_model_t *m)
 {
    // Simulation cycle is described in LRM 93 section 12.6.4
@@ -3173,7 +4311,7 @@ static void model_cycle(rt_model_t *m)
    if (is_delta_cycle)
       m->iteration = m->iteration + 1;
    else {
-      m->now = heap_min_key(m->eventq_heap);
+      m->now = wheel_min_key(m->eventq);
       m->iteration = 0;
    }
 
@@ -3193,7 +4331,7 @@ static void model_cycle(rt_model_t *m)
 
    if (!is_delta_cycle) {
       for (;;) {
-         void *e = heap_extract_min(m->eventq_heap);
+         void *e = wheel_extract_min(m->eventq);
          switch (pointer_tag(e)) {
          case EVENT_PROCESS:
             {
@@ -3223,9 +4361,9 @@ static void model_cycle(rt_model_t *m)
             break;
          }
 
-         if (heap_size(m->eventq_heap) == 0)
+         if (wheel_size(m->eventq) == 0)
             break;
-         else if (heap_min_key(m->eventq_heap) > m->now)
+         else if (wheel_min_key(m->eventq) > m->now)
             break;
       }
    }
@@ -3233,7 +4371,7 @@ static void model_cycle(rt_model_t *m)
    deferq_swap(&m->next_driverq, &m->driverq);
    deferq_run(m, &m->next_driverq);
 
-   do {
+   for (;;) {
       for (int i = 0; i < m->reschedq.count; i++)
          (*m->reschedq.tasks[i].fn)(m, m->reschedq.tasks[i].arg);
       m->reschedq.count = 0;
@@ -3247,7 +4385,12 @@ static void model_cycle(rt_model_t *m)
          rt_nexus_t *n = heap_extract_min(m->effective_heap);
          update_effective(m, n);
       }
-   } while (m->reschedq.count > 0);
+
+      if (heap_size(m->level_heap) > 0)
+         run_levelised(m, heap_extract_min(m->level_heap));
+      else if (m->reschedq.count == 0)
+         break;
+   }
 
    sync_event_cache(m);
 
@@ -3270,7 +4413,10 @@ static void model_cycle(rt_model_t *m)
 
    // Run all non-postponed processes and event callbacks
    deferq_swap(&m->next_procq, &m->procq);
-   deferq_run(m, &m->next_procq);
+   if (m->workq != NULL)
+      parallel_run(m, &m->next_procq);
+   else
+      deferq_run(m, &m->next_procq);
 
    run_callbacks(m, END_OF_PROCESSES);
 
@@ -3321,10 +4467,10 @@ static bool should_stop_now(rt_model_t *m, uint64_t stop_time)
    }
    else if (m->next_is_delta)
       return false;
-   else if (heap_size(m->eventq_heap) == 0)
+   else if (wheel_size(m->eventq) == 0)
       return true;
    else
-      return heap_min_key(m->eventq_heap) > stop_time;
+      return wheel_min_key(m->eventq) > stop_time;
 }
 
 static void check_liveness_properties(rt_model_t *m, rt_scope_t *s)
@@ -3407,7 +4553,7 @@ static inline void check_delay(int64_t delay)
 void force_signal(rt_model_t *m, rt_signal_t *s, const void *values,
                   int offset, size_t count)
 {
-   RT_LOCK(s->lock);
+   PARALLEL_LOCK(m, s->lock);
 
    TRACE("force signal %s+%d to %s", istr(tree_ident(s->where)), offset,
          fmt_values(values, count));
@@ -3437,7 +4583,7 @@ void force_signal(rt_model_t *m, rt_signal_t *s, const void *values,
 
 void release_signal(rt_model_t *m, rt_signal_t *s, int offset, size_t count)
 {
-   RT_LOCK(s->lock);
+   PARALLEL_LOCK(m, s->lock);
 
    TRACE("release signal %s+%d", istr(tree_ident(s->where)), offset);
 
@@ -3468,7 +4614,7 @@ static bool heap_delete_ptr_cb(uint64_t key, void *value, void *ctx)
 void deposit_signal(rt_model_t *m, rt_signal_t *s, const void *values,
                     int offset, size_t count)
 {
-   RT_LOCK(s->lock);
+   PARALLEL_LOCK(m, s->lock);
 
    TRACE("deposit signal %s+%d value=%s count=%zd", istr(tree_ident(s->where)),
          offset, fmt_values(values, count * s->nexus.size), count);
@@ -3490,13 +4636,13 @@ void deposit_signal(rt_model_t *m, rt_signal_t *s, const void *values,
          copy2(last, eff, vptr, valuesz);
          m->trigger_epoch++;
 
-         n->last_event = m->now;
-         n->event_delta = m->iteration;
+         NEXUS_HOT(m, n, last_event) = m->now;
+         NEXUS_HOT(m, n, event_delta) = m->iteration;
 
          if (n->flags & NET_F_CACHE_EVENT)
             n->signal->shared.flags |= SIG_F_EVENT_FLAG;
 
-         wakeup_all(m, &(n->pending));
+         wakeup_all(m, &NEXUS_HOT(m, n, pending));
       }
 
       if (n->flags & NET_F_PENDING) {
@@ -3512,7 +4658,7 @@ void deposit_signal(rt_model_t *m, rt_signal_t *s, const void *values,
 void sched_deposit(rt_model_t *m, rt_signal_t *s, const void *values,
                    int offset, size_t count, int64_t after, bool nonblock)
 {
-   RT_LOCK(s->lock);
+   PARALLEL_LOCK(m, s->lock);
 
    TRACE("schedule deposit %s+%d value=%s count=%zd after=%s",
          istr(tree_ident(s->where)), offset,
@@ -3533,13 +4679,14 @@ void sched_deposit(rt_model_t *m, rt_signal_t *s, const void *values,
       if (!src->pseudoqueued) {
          if (after == 0) {
             if (nonblock)
-               deferq_do(&m->nonblockq, async_pseudo_source, src);
+               deferq_do(local_deferq(m, &m->nonblockq),
+                         async_pseudo_source, src);
             else
                deltaq_insert_pseudo_source(m, src);
          }
          else if (after > 0) {
             void *e = tag_pointer(src, EVENT_PSEUDO);
-            heap_insert(m->eventq_heap, m->now + after, e);
+            eventq_insert(m, m->now + after, e);
          }
 
          src->pseudoqueued = 1;  // TODO: should be after == 0 branch
@@ -3549,6 +4696,54 @@ void sched_deposit(rt_model_t *m, rt_signal_t *s, const void *values,
    }
 }
 
+bool set_signal_value(rt_model_t *m, rt_signal_t *s, const char *name,
+                      const char *str, set_value_t how, text_buf_t *err)
+{
+   // Parse a value from the shell or command line and force or deposit
+   // it on the whole signal
+   type_t type = tree_type(s->where);
+
+   parsed_value_t value;
+   if (!parse_value(type, str, &value)) {
+      tb_printf(err, "value '%s' is not valid for type %s", str,
+                type_pp(type));
+      return false;
+   }
+
+   const void *values;
+   int width;
+   if (type_is_scalar(type)) {
+      values = &value.integer;
+      width = 1;
+   }
+   else if (type_is_character_array(type)) {
+      width = signal_width(s);
+      if (value.enums->count != width) {
+         tb_printf(err, "expected %d elements for signal %s but have %d",
+                   width, name, value.enums->count);
+         free(value.enums);
+         return false;
+      }
+
+      values = value.enums->values;
+   }
+   else {
+      tb_printf(err, "cannot %s signals of type %s",
+                how == SET_FORCE ? "force" : "deposit", type_pp(type));
+      return false;
+   }
+
+   if (how == SET_FORCE)
+      force_signal(m, s, values, 0, width);
+   else
+      sched_deposit(m, s, values, 0, width, 0, false);
+
+   if (!type_is_scalar(type))
+      free(value.enums);
+
+   return true;
+}
+
 bool model_can_create_delta(rt_model_t *m)
 {
    return m->can_create_delta;
@@ -3564,10 +4759,10 @@ int64_t model_now(rt_model_t *m, unsigned *deltas)
 
 int64_t model_next_time(rt_model_t *m)
 {
-   if (heap_size(m->eventq_heap) == 0)
+   if (wheel_size(m->eventq) == 0)
       return TIME_HIGH;
    else
-      return heap_min_key(m->eventq_heap);
+      return wheel_min_key(m->eventq);
 }
 
 void model_stop(rt_model_t *m)
@@ -3601,7 +4796,7 @@ void model_set_timeout_cb(rt_model_t *m, uint64_t when, rt_event_fn_t fn,
    assert(when > m->now);   // TODO: delta timeouts?
 
    void *e = tag_pointer(cb, EVENT_TIMEOUT);
-   heap_insert(m->eventq_heap, when, e);
+   wheel_insert(m->eventq, when, e);
 }
 
 rt_watch_t *watch_new(rt_model_t *m, sig_event_fn_t fn, void *user,
@@ -3631,7 +4826,7 @@ void watch_free(rt_model_t *m, rt_watch_t *w)
    for (int i = 0; i < w->next_slot; i++) {
       rt_nexus_t *n = &(w->signals[i]->nexus);
       for (int j = 0; j < w->signals[i]->n_nexus; j++, n = n->chain)
-         clear_event(m, &(n->pending), &(w->wakeable));
+         clear_event(m, &NEXUS_HOT(m, n, pending), &(w->wakeable));
    }
 
    rt_watch_t **last = &m->watches;
@@ -3666,7 +4861,7 @@ rt_watch_t *model_set_event_cb(rt_model_t *m, rt_signal_t *s, int offset,
       count -= n->width;
       assert(count >= 0);
 
-      sched_event(m, &(n->pending), &(w->wakeable));
+      sched_event(m, &NEXUS_HOT(m, n, pending), &(w->wakeable));
    }
 
    return w;
@@ -3707,15 +4902,16 @@ static bool nexus_active(rt_model_t *m, rt_nexus_t *nexus)
    if (nexus->n_sources > 0) {
       for (rt_source_t *s = &(nexus->sources); s; s = s->chain_input) {
          if (s->tag == SOURCE_PORT) {
-            RT_LOCK(s->u.port.input->signal->lock);
+            PARALLEL_LOCK(m, s->u.port.input->signal->lock);
             if (nexus_active(m, s->u.port.input))
                return true;
          }
          else if (s->tag == SOURCE_DRIVER
                   && s->u.driver.waveforms.when == m->now) {
-            if (nexus->active_delta == m->iteration)
+            if (NEXUS_HOT(m, nexus, active_delta) == m->iteration)
                return true;
-            else if (nexus->active_delta == m->iteration + 1 && s->was_active)
+            else if (NEXUS_HOT(m, nexus, active_delta) == m->iteration + 1
+                     && s->was_active)
                return true;
          }
       }
@@ -3731,7 +4927,7 @@ static uint64_t nexus_last_active(rt_model_t *m, rt_nexus_t *nexus)
    if (nexus->n_sources > 0) {
       for (rt_source_t *s = &(nexus->sources); s; s = s->chain_input) {
           if (s->tag == SOURCE_PORT) {
-             RT_LOCK(s->u.port.input->signal->lock);
+             PARALLEL_LOCK(m, s->u.port.input->signal->lock);
              last = MIN(last, nexus_last_active(m, s->u.port.input));
          }
          else if (s->tag == SOURCE_DRIVER
@@ -3772,7 +4968,7 @@ static void arm_trigger(rt_model_t *m, rt_trigger_t *t, rt_wakeable_t *obj)
          int32_t offset = t->args[1].integer;
 
          rt_nexus_t *n = split_nexus(m, s, offset, 1);
-         sched_event(m, &(n->pending), obj);
+         sched_event(m, &NEXUS_HOT(m, n, pending), obj);
       }
       break;
    case FUNC_TRIGGER:
@@ -3784,7 +4980,7 @@ static void arm_trigger(rt_model_t *m, rt_trigger_t *t, rt_wakeable_t *obj)
             rt_signal_t *s = container_of(ss, rt_signal_t, shared);
 
             rt_nexus_t *n = split_nexus(m, s, offset, 1);
-            sched_event(m, &(n->pending), obj);
+            sched_event(m, &NEXUS_HOT(m, n, pending), obj);
          }
       }
       break;
@@ -3797,13 +4993,23 @@ static void arm_trigger(rt_model_t *m, rt_trigger_t *t, rt_wakeable_t *obj)
 
          rt_nexus_t *n = split_nexus(m, s, offset, count);
          for (; count > 0; n = n->chain) {
-            sched_event(m, &(n->pending), obj);
+            sched_event(m, &NEXUS_HOT(m, n, pending), obj);
 
             count -= n->width;
             assert(count >= 0);
          }
       }
       break;
+   case EDGE_TRIGGER:
+      {
+         assert(t->nargs == 4);
+         rt_signal_t *s = t->args[0].pointer;
+         int32_t offset = t->args[1].integer;
+
+         rt_nexus_t *n = split_nexus(m, s, offset, 1);
+         sched_event(m, &NEXUS_HOT(m, n, pending), obj);
+      }
+      break;
    case OR_TRIGGER:
       {
          assert(t->nargs == 2);
@@ -4009,7 +5215,11 @@ void x_sched_process(int64_t delay)
    TRACE("schedule process %s delay=%s", istr(proc->name), trace_time(delay));
 
    check_delay(delay);
-   deltaq_insert_proc(get_model(), delay, proc);
+
+   rt_model_t *m = get_model();
+   MODEL_LOCK(m);
+
+   deltaq_insert_proc(m, delay, proc);
 }
 
 void x_sched_inactive(void)
@@ -4028,7 +5238,8 @@ void x_sched_waveform_s(sig_shared_t *ss, uint32_t offset, uint64_t scalar,
                         int64_t after, int64_t reject)
 {
    rt_signal_t *s = container_of(ss, rt_signal_t, shared);
-   RT_LOCK(s->lock);
+   rt_model_t *m = get_model();
+   PARALLEL_LOCK(m, s->lock);
 
    TRACE("_sched_waveform_s %s+%d value=%"PRIi64" after=%s reject=%s",
          istr(tree_ident(s->where)), offset, scalar, trace_time(after),
@@ -4040,7 +5251,6 @@ void x_sched_waveform_s(sig_shared_t *ss, uint32_t offset, uint64_t scalar,
    check_postponed(after, proc);
    check_reject_limit(s, after, reject);
 
-   rt_model_t *m = get_model();
    rt_nexus_t *n = split_nexus(m, s, offset, 1);
 
    sched_driver(m, n, after, reject, &scalar, proc);
@@ -4050,7 +5260,8 @@ void x_sched_waveform(sig_shared_t *ss, uint32_t offset, void *values,
                       int32_t count, int64_t after, int64_t reject)
 {
    rt_signal_t *s = container_of(ss, rt_signal_t, shared);
-   RT_LOCK(s->lock);
+   rt_model_t *m = get_model();
+   PARALLEL_LOCK(m, s->lock);
 
    TRACE("_sched_waveform %s+%d value=%s count=%d after=%s reject=%s",
          istr(tree_ident(s->where)), offset,
@@ -4063,7 +5274,6 @@ void x_sched_waveform(sig_shared_t *ss, uint32_t offset, void *values,
    check_postponed(after, proc);
    check_reject_limit(s, after, reject);
 
-   rt_model_t *m = get_model();
    rt_nexus_t *n = split_nexus(m, s, offset, count);
    char *vptr = values;
    for (; count > 0; n = n->chain) {
@@ -4108,7 +5318,7 @@ void x_transfer_signal(sig_shared_t *target_ss, uint32_t toffset,
    t->wakeable.delayed   = false;
 
    for (rt_nexus_t *n = t->source; count > 0; n = n->chain) {
-      sched_event(m, &(n->pending), &(t->wakeable));
+      sched_event(m, &NEXUS_HOT(m, n, pending), &(t->wakeable));
 
       if (!t->wakeable.pending) {
          // Schedule initial update immediately
@@ -4124,16 +5334,16 @@ void x_transfer_signal(sig_shared_t *target_ss, uint32_t toffset,
 int32_t x_test_net_event(sig_shared_t *ss, uint32_t offset, int32_t count)
 {
    rt_signal_t *s = container_of(ss, rt_signal_t, shared);
-   RT_LOCK(s->lock);
+   rt_model_t *m = get_model();
+   PARALLEL_LOCK(m, s->lock);
 
    TRACE("_test_net_event %s offset=%d count=%d",
          istr(tree_ident(s->where)), offset, count);
 
    int32_t result = 0;
-   rt_model_t *m = get_model();
    rt_nexus_t *n = split_nexus(m, s, offset, count);
    for (; count > 0; n = n->chain) {
-      if (n->last_event == m->now && n->event_delta == m->iteration) {
+      if (nexus_event(m, n)) {
          result = 1;
          break;
       }
@@ -4146,7 +5356,12 @@ int32_t x_test_net_event(sig_shared_t *ss, uint32_t offset, int32_t count)
       assert(!(ss->flags & SIG_F_CACHE_EVENT));   // Should have taken fast-path
       ss->flags |= SIG_F_CACHE_EVENT | (result ? SIG_F_EVENT_FLAG : 0);
       s->nexus.flags |= NET_F_CACHE_EVENT;
-      APUSH(m->eventsigs, s);
+
+      model_batch_t *b = __batch;
+      if (b == NULL)
+         APUSH(m->eventsigs, s);
+      else
+         APUSH(b->eventsigs, s);   // Merged at the barrier
    }
 
    return result;
@@ -4155,12 +5370,13 @@ int32_t x_test_net_event(sig_shared_t *ss, uint32_t offset, int32_t count)
 int32_t x_test_net_active(sig_shared_t *ss, uint32_t offset, int32_t count)
 {
    rt_signal_t *s = container_of(ss, rt_signal_t, shared);
-   RT_LOCK(s->lock);
+   rt_model_t *m = get_model();
+   MODEL_LOCK(m);
+   PARALLEL_LOCK(m, s->lock);
 
    TRACE("_test_net_active %s offset=%d count=%d",
          istr(tree_ident(s->where)), offset, count);
 
-   rt_model_t *m = get_model();
    rt_nexus_t *n = split_nexus(m, s, offset, count);
    for (; count > 0; n = n->chain) {
       if (nexus_active(m, n))
@@ -4176,17 +5392,18 @@ int32_t x_test_net_active(sig_shared_t *ss, uint32_t offset, int32_t count)
 void x_sched_event(sig_shared_t *ss, uint32_t offset, int32_t count)
 {
    rt_signal_t *s = container_of(ss, rt_signal_t, shared);
-   RT_LOCK(s->lock);
+   rt_model_t *m = get_model();
+   MODEL_LOCK(m);
+   PARALLEL_LOCK(m, s->lock);
 
    TRACE("schedule event %s+%d count=%d", istr(tree_ident(s->where)),
          offset, count);
 
    rt_wakeable_t *obj = get_active_wakeable();
 
-   rt_model_t *m = get_model();
    rt_nexus_t *n = split_nexus(m, s, offset, count);
    for (; count > 0; n = n->chain) {
-      sched_event(m, &(n->pending), obj);
+      sched_event(m, &NEXUS_HOT(m, n, pending), obj);
 
       count -= n->width;
       assert(count >= 0);
@@ -4196,16 +5413,17 @@ void x_sched_event(sig_shared_t *ss, uint32_t offset, int32_t count)
 void x_clear_event(sig_shared_t *ss, uint32_t offset, int32_t count)
 {
    rt_signal_t *s = container_of(ss, rt_signal_t, shared);
-   RT_LOCK(s->lock);
+   rt_model_t *m = get_model();
+   MODEL_LOCK(m);
+   PARALLEL_LOCK(m, s->lock);
 
    TRACE("clear event %s+%d count=%d",
          istr(tree_ident(s->where)), offset, count);
 
-   rt_model_t *m = get_model();
    rt_proc_t *proc = get_active_proc();
    rt_nexus_t *n = split_nexus(m, s, offset, count);
    for (; count > 0; n = n->chain) {
-      clear_event(m, &(n->pending), &(proc->wakeable));
+      clear_event(m, &NEXUS_HOT(m, n, pending), &(proc->wakeable));
 
       count -= n->width;
       assert(count >= 0);
@@ -4215,13 +5433,14 @@ void x_clear_event(sig_shared_t *ss, uint32_t offset, int32_t count)
 void x_sched_active(sig_shared_t *ss, uint32_t offset, int32_t count)
 {
    rt_signal_t *s = container_of(ss, rt_signal_t, shared);
-   RT_LOCK(s->lock);
+   rt_model_t *m = get_model();
+   MODEL_LOCK(m);
+   PARALLEL_LOCK(m, s->lock);
 
    TRACE("schedule active %s+%d count=%d", istr(tree_ident(s->where)),
          offset, count);
 
    rt_wakeable_t *obj = get_active_wakeable();
-   rt_model_t *m = get_model();
 
    rt_nexus_t *n = split_nexus(m, s, offset, count);
    for (; count > 0; n = n->chain) {
@@ -4241,10 +5460,12 @@ void x_sched_active(sig_shared_t *ss, uint32_t offset, int32_t count)
 
 void x_enable_trigger(rt_trigger_t *trigger)
 {
+   rt_model_t *m = get_model();
+   MODEL_LOCK(m);
+
    TRACE("enable trigger %p", trigger);
 
    rt_wakeable_t *obj = get_active_wakeable();
-   rt_model_t *m = get_model();
 
    if (trigger->pending == NULL)
       arm_trigger(m, trigger, &(trigger->wakeable));
@@ -4254,10 +5475,12 @@ void x_enable_trigger(rt_trigger_t *trigger)
 
 void x_disable_trigger(rt_trigger_t *trigger)
 {
+   rt_model_t *m = get_model();
+   MODEL_LOCK(m);
+
    TRACE("disable trigger %p", trigger);
 
    rt_wakeable_t *obj = get_active_wakeable();
-   rt_model_t *m = get_model();
 
    clear_event(m, &(trigger->pending), obj);
 }
@@ -4292,18 +5515,19 @@ void x_alias_signal(sig_shared_t *ss, uint32_t offset, tree_t where)
 int64_t x_last_event(sig_shared_t *ss, uint32_t offset, int32_t count)
 {
    rt_signal_t *s = container_of(ss, rt_signal_t, shared);
-   RT_LOCK(s->lock);
+   rt_model_t *m = get_model();
+   MODEL_LOCK(m);
+   PARALLEL_LOCK(m, s->lock);
 
    TRACE("_last_event %s offset=%d count=%d",
          istr(tree_ident(s->where)), offset, count);
 
    int64_t last = TIME_HIGH;
 
-   rt_model_t *m = get_model();
    rt_nexus_t *n = split_nexus(m, s, offset, count);
    for (; count > 0; n = n->chain) {
-      if (n->last_event <= m->now)
-         last = MIN(last, m->now - n->last_event);
+      if (NEXUS_HOT(m, n, last_event) <= m->now)
+         last = MIN(last, m->now - NEXUS_HOT(m, n, last_event));
 
       count -= n->width;
       assert(count >= 0);
@@ -4315,14 +5539,15 @@ int64_t x_last_event(sig_shared_t *ss, uint32_t offset, int32_t count)
 int64_t x_last_active(sig_shared_t *ss, uint32_t offset, int32_t count)
 {
    rt_signal_t *s = container_of(ss, rt_signal_t, shared);
-   RT_LOCK(s->lock);
+   rt_model_t *m = get_model();
+   MODEL_LOCK(m);
+   PARALLEL_LOCK(m, s->lock);
 
    TRACE("_last_active %s offset=%d count=%d",
          istr(tree_ident(s->where)), offset, count);
 
    int64_t last = TIME_HIGH;
 
-   rt_model_t *m = get_model();
    rt_nexus_t *n = split_nexus(m, s, offset, count);
    for (; count > 0; n = n->chain) {
       last = MIN(last, nexus_last_active(m, n));
@@ -4468,14 +5693,15 @@ void x_pop_scope(void)
 bool x_driving(sig_shared_t *ss, uint32_t offset, int32_t count)
 {
    rt_signal_t *s = container_of(ss, rt_signal_t, shared);
-   RT_LOCK(s->lock);
+   rt_model_t *m = get_model();
+   MODEL_LOCK(m);
+   PARALLEL_LOCK(m, s->lock);
 
    TRACE("_driving %s offset=%d count=%d",
          istr(tree_ident(s->where)), offset, count);
 
    int ntotal = 0, ndriving = 0;
    bool found = false;
-   rt_model_t *m = get_model();
    rt_proc_t *proc = get_active_proc();
    rt_nexus_t *n = split_nexus(m, s, offset, count);
    for (; count > 0; n = n->chain) {
@@ -4502,12 +5728,13 @@ bool x_driving(sig_shared_t *ss, uint32_t offset, int32_t count)
 void *x_driving_value(sig_shared_t *ss, uint32_t offset, int32_t count)
 {
    rt_signal_t *s = container_of(ss, rt_signal_t, shared);
-   RT_LOCK(s->lock);
+   rt_model_t *m = get_model();
+   MODEL_LOCK(m);
+   PARALLEL_LOCK(m, s->lock);
 
    TRACE("driving value %s offset=%d count=%d", istr(tree_ident(s->where)),
          offset, count);
 
-   rt_model_t *m = get_model();
    rt_nexus_t *n = split_nexus(m, s, offset, count);
 
    rt_proc_t *proc = get_active_proc();
@@ -4547,6 +5774,9 @@ void x_disconnect(sig_shared_t *ss, uint32_t offset, int32_t count,
                   int64_t after, int64_t reject)
 {
    rt_signal_t *s = container_of(ss, rt_signal_t, shared);
+   rt_model_t *m = get_model();
+   MODEL_LOCK(m);
+   PARALLEL_LOCK(m, s->lock);
 
    TRACE("_disconnect %s+%d len=%d after=%s reject=%s",
          istr(tree_ident(s->where)), offset, count, trace_time(after),
@@ -4557,7 +5787,6 @@ void x_disconnect(sig_shared_t *ss, uint32_t offset, int32_t count,
    check_postponed(after, proc);
    check_reject_limit(s, after, reject);
 
-   rt_model_t *m = get_model();
    rt_nexus_t *n = split_nexus(m, s, offset, count);
    for (; count > 0; n = n->chain) {
       count -= n->width;
@@ -4570,12 +5799,13 @@ void x_disconnect(sig_shared_t *ss, uint32_t offset, int32_t count,
 void x_force(sig_shared_t *ss, uint32_t offset, int32_t count, void *values)
 {
    rt_signal_t *s = container_of(ss, rt_signal_t, shared);
+   rt_model_t *m = get_model();
+   MODEL_LOCK(m);
 
    TRACE("force signal %s+%d value=%s count=%d", istr(tree_ident(s->where)),
          offset, fmt_values(values, count), count);
 
    rt_proc_t *proc = get_active_proc();
-   rt_model_t *m = get_model();
 
    check_postponed(0, proc);
 
@@ -4585,12 +5815,13 @@ void x_force(sig_shared_t *ss, uint32_t offset, int32_t count, void *values)
 void x_release(sig_shared_t *ss, uint32_t offset, int32_t count)
 {
    rt_signal_t *s = container_of(ss, rt_signal_t, shared);
+   rt_model_t *m = get_model();
+   MODEL_LOCK(m);
 
    TRACE("release signal %s+%d count=%d", istr(tree_ident(s->where)),
          offset, count);
 
    rt_proc_t *proc = get_active_proc();
-   rt_model_t *m = get_model();
 
    check_postponed(0, proc);
 
@@ -4602,6 +5833,7 @@ void x_deposit_signal(sig_shared_t *ss, uint32_t offset, int32_t count,
 {
    rt_signal_t *s = container_of(ss, rt_signal_t, shared);
    rt_model_t *m = get_model();
+   MODEL_LOCK(m);
 
    deposit_signal(m, s, values, offset, count);
 }
@@ -4611,6 +5843,7 @@ void x_sched_deposit(sig_shared_t *ss, uint32_t offset, int32_t count,
 {
    rt_signal_t *s = container_of(ss, rt_signal_t, shared);
    rt_model_t *m = get_model();
+   MODEL_LOCK(m);
 
    sched_deposit(m, s, values, offset, count, after, true);
 }
@@ -4619,12 +5852,14 @@ void x_put_driver(sig_shared_t *ss, uint32_t offset, int32_t count,
                   void *values)
 {
    rt_signal_t *s = container_of(ss, rt_signal_t, shared);
+   rt_model_t *m = get_model();
+   MODEL_LOCK(m);
+   PARALLEL_LOCK(m, s->lock);
 
    TRACE("put driver %s+%d value=%s count=%d", istr(tree_ident(s->where)),
          offset, fmt_values(values, count * s->nexus.size), count);
 
    rt_proc_t *proc = get_active_proc();
-   rt_model_t *m = get_model();
    rt_nexus_t *n = split_nexus(m, s, offset, count);
    const char *vptr = values;
    for (; count > 0; n = n->chain) {
@@ -4653,7 +5888,7 @@ void x_put_driver(sig_shared_t *ss, uint32_t offset, int32_t count,
          switch (o->tag) {
          case SOURCE_PORT:
             defer_driving_update(m, o->u.port.output);
-            m->next_is_delta = true;
+            relaxed_store(&m->next_is_delta, true);
             break;
          case SOURCE_ACTIVE:
             wakeup_one(m, o->u.wakeable);
@@ -4724,6 +5959,7 @@ void *x_function_trigger(jit_handle_t handle, unsigned nargs,
                          const jit_scalar_t *args)
 {
    rt_model_t *m = get_model();
+   MODEL_LOCK(m);
 
    uint64_t hash = mix_bits_32(handle);
    for (int i = 0; i < nargs; i++)
@@ -4738,6 +5974,7 @@ void *x_function_trigger(jit_handle_t handle, unsigned nargs,
 rt_trigger_t *x_or_trigger(rt_trigger_t *left, rt_trigger_t *right)
 {
    rt_model_t *m = get_model();
+   MODEL_LOCK(m);
 
    uint64_t hash = mix_bits_64(left) ^ mix_bits_64(right);
 
@@ -4753,8 +5990,9 @@ rt_trigger_t *x_or_trigger(rt_trigger_t *left, rt_trigger_t *right)
 
 void *x_cmp_trigger(sig_shared_t *ss, uint32_t offset, int64_t right)
 {
-   rt_model_t *m = get_model();
    rt_signal_t *s = container_of(ss, rt_signal_t, shared);
+   rt_model_t *m = get_model();
+   MODEL_LOCK(m);
 
    uint64_t hash = mix_bits_64(s) ^ mix_bits_32(offset) ^ mix_bits_64(right);
 
@@ -4772,8 +6010,9 @@ void *x_cmp_trigger(sig_shared_t *ss, uint32_t offset, int64_t right)
 
 void *x_level_trigger(sig_shared_t *ss, uint32_t offset, int32_t count)
 {
-   rt_model_t *m = get_model();
    rt_signal_t *s = container_of(ss, rt_signal_t, shared);
+   rt_model_t *m = get_model();
+   MODEL_LOCK(m);
 
    uint64_t hash = mix_bits_64(s) ^ mix_bits_32(offset) ^ mix_bits_32(count);
 
@@ -4789,6 +6028,34 @@ void *x_level_trigger(sig_shared_t *ss, uint32_t offset, int32_t count)
    return new_trigger(m, LEVEL_TRIGGER, hash, JIT_HANDLE_INVALID, 3, args);
 }
 
+void *x_edge_trigger(sig_shared_t *ss, uint32_t offset, uint64_t mask,
+                     rt_trigger_t *inner)
+{
+   rt_signal_t *s = container_of(ss, rt_signal_t, shared);
+   rt_model_t *m = get_model();
+   MODEL_LOCK(m);
+   PARALLEL_LOCK(m, s->lock);
+
+   rt_nexus_t *n = split_nexus(m, s, offset, 1);
+   if (n->size != 1)
+      return inner;   // Mask is indexed by a single byte value
+
+   uint64_t hash = mix_bits_64(s) ^ mix_bits_32(offset)
+      ^ mix_bits_64(mask) ^ mix_bits_64(inner);
+
+   TRACE("edge trigger %s+%d mask=%"PRIx64" inner=%p hash=%"PRIx64,
+         istr(tree_ident(s->where)), offset, mask, inner, hash);
+
+   const jit_scalar_t args[] = {
+      { .pointer = s },
+      { .integer = offset },
+      { .integer = mask },
+      { .pointer = inner }
+   };
+
+   return new_trigger(m, EDGE_TRIGGER, hash, JIT_HANDLE_INVALID, 4, args);
+}
+
 void x_add_trigger(void *ptr)
 {
    TRACE("add trigger %p", ptr);
@@ -4797,6 +6064,23 @@ void x_add_trigger(void *ptr)
    assert(obj->trigger == NULL);
 
    obj->trigger = ptr;
+
+   rt_trigger_t *t = ptr;
+   if (t->kind == EDGE_TRIGGER) {
+      // Wait on the trigger instead of the clock nexus so the process
+      // is never queued for an event on the opposite edge
+      rt_model_t *m = get_model();
+      MODEL_LOCK(m);
+
+      rt_signal_t *s = t->args[0].pointer;
+      rt_nexus_t *n = split_nexus(m, s, t->args[1].integer, 1);
+      clear_event(m, &NEXUS_HOT(m, n, pending), obj);
+
+      if (t->pending == NULL)
+         arm_trigger(m, t, &(t->wakeable));
+
+      sched_event(m, &(t->pending), obj);
+   }
 }
 
 void x_instance_name(attr_kind_t kind, text_buf_t *tb)
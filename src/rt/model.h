@@ -26,6 +26,11 @@ typedef enum {
    WATCH_POSTPONED,
 } watch_kind_t;
 
+typedef enum {
+   SET_FORCE,
+   SET_DEPOSIT,
+} set_value_t;
+
 typedef enum {
    END_OF_INITIALISATION,
    START_OF_SIMULATION,
@@ -42,6 +47,7 @@ typedef enum {
 rt_model_t *model_new(jit_t *jit, cover_data_t *cover);
 void model_free(rt_model_t *m);
 void model_reset(rt_model_t *m);
+void model_precompile(rt_model_t *m);
 void model_run(rt_model_t *m, uint64_t stop_time);
 bool model_step(rt_model_t *m);
 bool model_can_create_delta(rt_model_t *m);
@@ -94,7 +100,10 @@ void deposit_signal(rt_model_t *m, rt_signal_t *s, const void *values,
                     int offset, size_t count);
 void sched_deposit(rt_model_t *m, rt_signal_t *s, const void *values,
                    int offset, size_t count, int64_t after, bool nonblock);
-rt_watch_t *find_watch(rt_nexus_t *n, sig_event_fn_t fn);
+bool set_signal_value(rt_model_t *m, rt_signal_t *s, const char *name,
+                      const char *str, set_value_t how, text_buf_t *err);
+rt_watch_t *find_watch(rt_model_t *m, rt_nexus_t *n, sig_event_fn_t fn);
+void *nexus_pending(rt_model_t *m, rt_nexus_t *n);
 void get_forcing_value(rt_signal_t *s, uint8_t *value);
 
 #endif  // _RT_MODEL_H
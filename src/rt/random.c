@@ -87,6 +87,14 @@ uint32_t get_random(void)
    return mt19937_next();
 }
 
+void set_random_seed(uint32_t seed)
+{
+   SCOPED_LOCK(lock);
+
+   opt_set_int(OPT_RANDOM_SEED, seed);
+   mti = MT_N + 1;   // Initialise again on next use
+}
+
 DLLEXPORT
 void _nvc_random_get_next(jit_scalar_t *args)
 {
@@ -21,5 +21,6 @@
 #include "prim.h"
 
 uint32_t get_random(void);
+void set_random_seed(uint32_t seed);
 
 #endif  // _RT_RANDOM_H
@@ -36,11 +36,11 @@ typedef A(rt_proc_t *) proc_list_t;
 typedef A(rt_alias_t *) alias_list_t;
 
 typedef enum {
-   W_PROC, W_WATCH, W_PROPERTY, W_TRANSFER, W_TRIGGER,
+   W_PROC, W_WATCH, W_PROPERTY, W_TRANSFER, W_TRIGGER, W_GROUP,
 } wakeable_kind_t;
 
 typedef enum {
-   FUNC_TRIGGER, OR_TRIGGER, CMP_TRIGGER, LEVEL_TRIGGER
+   FUNC_TRIGGER, OR_TRIGGER, CMP_TRIGGER, LEVEL_TRIGGER, EDGE_TRIGGER
 } trigger_kind_t;
 
 typedef struct {
@@ -50,6 +50,8 @@ typedef struct {
    unsigned        delayed : 1;
    unsigned        zombie : 1;
    unsigned        reschedule : 1;
+   unsigned        parallel : 1;
+   unsigned        levelised : 1;
    rt_trigger_t   *trigger;
 } rt_wakeable_t;
 
@@ -72,11 +74,19 @@ typedef struct _rt_proc {
    tlab_t        *tlab;
    rt_scope_t    *scope;
    mptr_t         privdata;
+   uint32_t       level;
+   uint32_t       level_epoch;
    ffi_closure_t  closure;   // Has a flexible member
 } rt_proc_t;
 
 STATIC_ASSERT(sizeof(rt_proc_t) <= 128);
 
+typedef struct {
+   rt_wakeable_t  wakeable;
+   unsigned       count;
+   rt_proc_t     *procs[];
+} rt_group_t;
+
 typedef struct _rt_prop {
    rt_wakeable_t  wakeable;
    psl_node_t     where;
@@ -157,23 +167,23 @@ STATIC_ASSERT(sizeof(rt_source_t) <= 64);
 typedef struct {
    ffi_closure_t closure;
    res_flags_t   flags;
+   int           nlits;
    int8_t        tab2[16][16];
    int8_t        tab1[16];
 } res_memo_t;
 
+// Frequently updated state such as the time of the last event is
+// stored separately in arrays indexed by the nexus ID
 typedef struct _rt_nexus {
    rt_nexus_t    *chain;
    rt_signal_t   *signal;
    uint32_t       offset;
-   delta_cycle_t  active_delta;
-   delta_cycle_t  event_delta;
+   uint32_t       id;
    uint32_t       width;
    net_flags_t    flags;
    uint8_t        size;
    uint8_t        n_sources;
    uint8_t        rank;
-   uint64_t       last_event;
-   void          *pending;
    rt_source_t   *outputs;
    void          *free_value;
    rt_source_t    sources;
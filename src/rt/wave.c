@@ -23,6 +23,7 @@
 #include "hash.h"
 #include "jit/jit-layout.h"
 #include "option.h"
+#include "rt/assert.h"
 #include "rt/model.h"
 #include "rt/rt.h"
 #include "rt/structs.h"
@@ -79,6 +80,15 @@ typedef struct {
    } u;
 } fst_type_t;
 
+// Value of an element at the start of the history window
+typedef struct {
+   char     *bytes;
+   uint32_t  len;
+   uint32_t  max;
+   bool      varlen;
+   bool      valid;
+} fst_value_t;
+
 typedef struct _fst_data {
    wave_dumper_t *dumper;
    fst_type_t    *type;
@@ -87,9 +97,31 @@ typedef struct _fst_data {
    rt_signal_t   *signal;
    unsigned       size;
    unsigned       count;
+   bool           recorded;
+   fst_value_t   *initial;
    fstHandle      handle[];
 } fst_data_t;
 
+typedef struct {
+   uint64_t    when;
+   fst_data_t *data;
+   uint32_t    index;
+   uint32_t    len : 31;
+   uint32_t    varlen : 1;
+} fst_record_t;
+
+// Value changes are held in a circular buffer of fst_record_t headers
+// each followed by the value bytes, and the oldest records are
+// overwritten when it is full
+typedef struct {
+   char    *buf;
+   size_t   size;
+   size_t   head;
+   size_t   used;
+   int64_t  nerrors;
+   bool     flushing;
+} fst_ring_t;
+
 typedef A(fst_data_t *) data_array_t;
 
 typedef struct {
@@ -114,10 +146,15 @@ typedef struct _wave_dumper {
    FILE          *vcdfile;
    char          *tmpfst;
    uint64_t       last_time;
+   uint64_t       start_time;
+   uint64_t       stop_time;
+   bool           enabled;
+   bool           keep_open;
    jit_t         *jit;
    hash_t        *typecache;
    fst_type_t    *datatypes[DT_STRING + 1];
    data_array_t   dumped;
+   fst_ring_t    *ring;
 } wave_dumper_t;
 
 static glob_array_t incl;
@@ -145,10 +182,199 @@ static bool should_dump_array(tree_t where, unsigned length)
    return false;
 }
 
+static void ring_read(fst_ring_t *r, size_t pos, void *dst, size_t len)
+{
+   pos %= r->size;
+   const size_t first = MIN(len, r->size - pos);
+   memcpy(dst, r->buf + pos, first);
+   memcpy((char *)dst + first, r->buf, len - first);
+}
+
+static void ring_write(fst_ring_t *r, size_t pos, const void *src, size_t len)
+{
+   pos %= r->size;
+   const size_t first = MIN(len, r->size - pos);
+   memcpy(r->buf + pos, src, first);
+   memcpy(r->buf, (const char *)src + first, len - first);
+}
+
+static fst_value_t *ring_initial(const fst_record_t *rec)
+{
+   fst_data_t *data = rec->data;
+   if (data->initial == NULL)
+      data->initial = xcalloc_array(data->count, sizeof(fst_value_t));
+
+   fst_value_t *v = &(data->initial[rec->index]);
+   if (rec->len > v->max)
+      v->bytes = xrealloc(v->bytes, (v->max = rec->len));
+
+   v->len    = rec->len;
+   v->varlen = rec->varlen;
+   v->valid  = true;
+
+   return v;
+}
+
+static void ring_evict(fst_ring_t *r)
+{
+   fst_record_t old;
+   ring_read(r, r->head, &old, sizeof(fst_record_t));
+
+   // The overwritten change gives the value of the element at the start
+   // of the window unless there is a later change still in the buffer
+   fst_value_t *v = ring_initial(&old);
+   ring_read(r, r->head + sizeof(fst_record_t), v->bytes, old.len);
+
+   const size_t oldsz = sizeof(fst_record_t) + old.len;
+   r->head = (r->head + oldsz) % r->size;
+   r->used -= oldsz;
+}
+
+static void ring_push(fst_ring_t *r, const fst_record_t *rec, const void *value)
+{
+   const size_t need = sizeof(fst_record_t) + rec->len;
+   if (need > r->size) {
+      // Forget everything before this change
+      while (r->used > 0)
+         ring_evict(r);
+
+      r->head = 0;
+      memcpy(ring_initial(rec)->bytes, value, rec->len);
+      return;
+   }
+
+   while (r->size - r->used < need)
+      ring_evict(r);
+
+   const size_t tail = r->head + r->used;
+   ring_write(r, tail, rec, sizeof(fst_record_t));
+   ring_write(r, tail + sizeof(fst_record_t), value, rec->len);
+   r->used += need;
+}
+
+static void fst_emit(fst_data_t *data, int index, const void *value,
+                     size_t len, bool varlen)
+{
+   wave_dumper_t *wd = data->dumper;
+   fst_ring_t *r = wd->ring;
+   const fstHandle handle = data->handle[index];
+
+   if (r != NULL && !r->flushing) {
+      const fst_record_t rec = {
+         .when   = model_now(wd->model, NULL),
+         .data   = data,
+         .index  = index,
+         .len    = len,
+         .varlen = varlen,
+      };
+      ring_push(r, &rec, value);
+   }
+   else if (varlen)
+      fstWriterEmitVariableLengthValueChange(wd->fst_ctx, handle, value, len);
+   else
+      fstWriterEmitValueChange(wd->fst_ctx, handle, value);
+}
+
+static void fst_flush_ring(wave_dumper_t *wd)
+{
+   fst_ring_t *r = wd->ring;
+   if (r->used == 0)
+      return;
+
+   r->flushing = true;
+
+   fst_record_t rec;
+   ring_read(r, r->head, &rec, sizeof(fst_record_t));
+
+   const uint64_t start = rec.when;
+
+   for (size_t pos = 0; pos < r->used; ) {
+      ring_read(r, r->head + pos, &rec, sizeof(fst_record_t));
+      rec.data->recorded = true;
+      pos += sizeof(fst_record_t) + rec.len;
+   }
+
+   if (start != wd->last_time) {
+      fstWriterEmitTimeChange(wd->fst_ctx, start);
+      wd->last_time = start;
+   }
+
+   // Signals that did not change while recording still have their
+   // current value at the start of the window and the others have the
+   // value from the last change overwritten in the buffer, if any
+   for (int i = 0; i < wd->dumped.count; i++) {
+      fst_data_t *data = wd->dumped.items[i];
+      if (!data->recorded)
+         (*data->type->fn)(data->watch, data);
+
+      if (data->initial == NULL)
+         continue;
+
+      for (int j = 0; j < data->count; j++) {
+         fst_value_t *v = &(data->initial[j]);
+         if (v->valid && data->recorded)
+            fst_emit(data, j, v->bytes, v->len, v->varlen);
+         v->valid = false;
+      }
+   }
+
+   char *value LOCAL = NULL;
+   size_t valuesz = 0;
+
+   for (size_t pos = 0; pos < r->used; ) {
+      ring_read(r, r->head + pos, &rec, sizeof(fst_record_t));
+      pos += sizeof(fst_record_t);
+
+      if (rec.len > valuesz)
+         value = xrealloc(value, (valuesz = rec.len));
+
+      ring_read(r, r->head + pos, value, rec.len);
+      pos += rec.len;
+
+      if (rec.when != wd->last_time) {
+         fstWriterEmitTimeChange(wd->fst_ctx, rec.when);
+         wd->last_time = rec.when;
+      }
+
+      fst_emit(rec.data, rec.index, value, rec.len, rec.varlen);
+      rec.data->recorded = false;
+   }
+
+   r->head = r->used = 0;
+   r->flushing = false;
+}
+
+static void fst_check_errors(wave_dumper_t *wd)
+{
+   fst_ring_t *r = wd->ring;
+
+   // Write out the recorded history after each new error
+   const int64_t nerrors = get_vhdl_assert_count(SEVERITY_ERROR)
+      + get_vhdl_assert_count(SEVERITY_FAILURE);
+   if (nerrors != r->nerrors) {
+      fst_flush_ring(wd);
+      r->nerrors = nerrors;
+   }
+}
+
+static void fst_history_cb(rt_model_t *m, void *arg)
+{
+   wave_dumper_t *wd = arg;
+
+   // Also check at the end of each time step so an error followed by
+   // the simulation stopping does not wait for the next signal change
+   fst_check_errors(wd);
+
+   model_set_phase_cb(m, END_TIME_STEP, fst_history_cb, wd);
+}
+
 static void fst_close(rt_model_t *m, void *arg)
 {
    wave_dumper_t *wd = arg;
 
+   if (wd->ring != NULL)
+      fst_flush_ring(wd);
+
    fstWriterEmitTimeChange(wd->fst_ctx, model_now(m, NULL));
    fstWriterClose(wd->fst_ctx);
 
@@ -185,6 +411,19 @@ static void fst_close(rt_model_t *m, void *arg)
    wd->model   = NULL;
 }
 
+static void fst_end_cb(rt_model_t *m, void *arg)
+{
+   wave_dumper_t *wd = arg;
+
+   if (wd->keep_open) {
+      // The shell can run the simulation again so the file is only
+      // closed when the dumper is freed
+      model_set_phase_cb(m, END_OF_SIMULATION, fst_end_cb, wd);
+   }
+   else
+      fst_close(m, wd);
+}
+
 static inline void fst_write_binary(uint64_t val, size_t size, char *buf)
 {
    for (size_t j = 0; j < size; j++)
@@ -201,14 +440,14 @@ static void fst_fmt_int(rt_watch_t *w, fst_data_t *data)
       char buf[data->type->size + 1];
       fst_write_binary(val[i], data->type->size, buf);
 
-      fstWriterEmitValueChange(data->dumper->fst_ctx, data->handle[i], buf);
+      fst_emit(data, i, buf, data->type->size, false);
    }
 }
 
 static void fst_fmt_real(rt_watch_t *w, fst_data_t *data)
 {
    const void *buf = signal_value(data->signal);
-   fstWriterEmitValueChange(data->dumper->fst_ctx, data->handle[0], buf);
+   fst_emit(data, 0, buf, sizeof(double), false);
 }
 
 static void fst_fmt_physical(rt_watch_t *w, fst_data_t *data)
@@ -224,8 +463,7 @@ static void fst_fmt_physical(rt_watch_t *w, fst_data_t *data)
    checked_sprintf(buf, sizeof(buf), "%"PRIi64" %s",
                    val / unit->mult, unit->name);
 
-   fstWriterEmitVariableLengthValueChange(
-      data->dumper->fst_ctx, data->handle[0], buf, strlen(buf));
+   fst_emit(data, 0, buf, strlen(buf), true);
 }
 
 static void fst_fmt_chars(rt_watch_t *w, fst_data_t *data)
@@ -236,11 +474,10 @@ static void fst_fmt_chars(rt_watch_t *w, fst_data_t *data)
          char buf[data->size];
          for (int j = 0; j < data->size; j++)
             buf[j] = data->type->u.map[p[j]];
-         fstWriterEmitValueChange(data->dumper->fst_ctx, data->handle[i], buf);
+         fst_emit(data, i, buf, data->size, false);
       }
       else
-         fstWriterEmitVariableLengthValueChange(
-            data->dumper->fst_ctx, data->handle[i], p, data->size);
+         fst_emit(data, i, p, data->size, true);
    }
 }
 
@@ -255,10 +492,8 @@ static void fst_fmt_enum(rt_watch_t *w, fst_data_t *data)
       assert(val[i] < e->count);
 
       const char *literal = e->strings + val[i] * e->size;
-      fstWriterEmitVariableLengthValueChange(data->dumper->fst_ctx,
-                                             data->handle[i],
-                                             literal,
-                                             strnlen(literal, e->size));
+      fst_emit(data, i, literal, strnlen(literal, e->size),
+               true);
    }
 }
 #endif
@@ -270,7 +505,7 @@ static void fst_fmt_verilog(rt_watch_t *w, fst_data_t *data)
       char buf[data->size];
       for (int j = 0; j < data->size; j++)
          buf[j] = data->type->u.map[p[j] & 3];
-      fstWriterEmitValueChange(data->dumper->fst_ctx, data->handle[i], buf);
+      fst_emit(data, i, buf, data->size, false);
    }
 }
 
@@ -279,7 +514,9 @@ static void fst_event_cb(uint64_t now, rt_signal_t *s, rt_watch_t *w,
 {
    fst_data_t *data = user;
 
-   if (now != data->dumper->last_time) {
+   if (data->dumper->ring != NULL)
+      fst_check_errors(data->dumper);   // Before overwriting any history
+   else if (now != data->dumper->last_time) {
       fstWriterEmitTimeChange(data->dumper->fst_ctx, now);
       data->dumper->last_time = now;
    }
@@ -728,7 +965,7 @@ static void fst_create_array_var(wave_dumper_t *wd, tree_t d, rt_signal_t *s,
       fstWriterSetAttrEnd(wd->fst_ctx);
    }
 
-   assert(find_watch(&(s->nexus), fst_event_cb) == NULL);
+   assert(find_watch(wd->model, &(s->nexus), fst_event_cb) == NULL);
 
    data->decl   = d;
    data->signal = s;
@@ -771,7 +1008,7 @@ static void fst_create_scalar_var(wave_dumper_t *wd, tree_t d, rt_signal_t *s,
 
    data->handle[0] = fst_create_handle(wd, data, tb_get(tb), dir, type, 0);
 
-   assert(find_watch(&(s->nexus), fst_event_cb) == NULL);
+   assert(find_watch(wd->model, &(s->nexus), fst_event_cb) == NULL);
 
    data->decl   = d;
    data->signal = s;
@@ -907,7 +1144,7 @@ static void fst_create_record_array_var(wave_dumper_t *wd, tree_t d,
 static void fst_alias_var(wave_dumper_t *wd, tree_t d, rt_scope_t *scope,
                           rt_signal_t *s, text_buf_t *tb)
 {
-   rt_watch_t *w = find_watch(&(s->nexus), fst_event_cb);
+   rt_watch_t *w = find_watch(wd->model, &(s->nexus), fst_event_cb);
    if (w == NULL)
       return;   // Did not dump the primary signal
 
@@ -1068,7 +1305,7 @@ static void fst_process_verilog(wave_dumper_t *wd, rt_scope_t *scope,
       FST_SVT_NONE,
       data->type->sdt);
 
-   assert(find_watch(&(s->nexus), fst_event_cb) == NULL);
+   assert(find_watch(wd->model, &(s->nexus), fst_event_cb) == NULL);
 
    data->decl   = wrap;
    data->signal = s;
@@ -1235,6 +1472,94 @@ static void fst_walk_packages(wave_dumper_t *wd)
    }
 }
 
+static void fst_attach(wave_dumper_t *wd)
+{
+   const uint64_t now = model_now(wd->model, NULL);
+
+   for (int i = 0; i < wd->dumped.count; i++) {
+      fst_data_t *data = wd->dumped.items[i];
+      if (data->watch == NULL) {
+         data->watch = watch_new(wd->model, fst_event_cb, data,
+                                 WATCH_POSTPONED, 1);
+
+         const int width = signal_width(data->signal);
+         model_set_event_cb(wd->model, data->signal, 0, width, data->watch);
+      }
+   }
+
+   // Emitting the initial values must happen after all FST variables
+   // are created to avoid expensive mmap/munmap calls
+   for (int i = 0; i < wd->dumped.count; i++) {
+      fst_data_t *data = wd->dumped.items[i];
+      fst_event_cb(now, data->signal, data->watch, data);
+   }
+
+   wd->enabled = true;
+}
+
+static void fst_detach(wave_dumper_t *wd)
+{
+   // Removing the watches avoids the cost of event callbacks for
+   // signals outside the window of interest
+   for (int i = 0; i < wd->dumped.count; i++) {
+      fst_data_t *data = wd->dumped.items[i];
+      if (data->watch != NULL) {
+         watch_free(wd->model, data->watch);
+         data->watch = NULL;
+      }
+   }
+
+   wd->enabled = false;
+}
+
+static void fst_start_cb(rt_model_t *m, void *arg)
+{
+   wave_dumper_t *wd = arg;
+   if (wd->model != NULL && !wd->enabled)
+      fst_attach(wd);
+}
+
+static void fst_stop_cb(rt_model_t *m, void *arg)
+{
+   wave_dumper_t *wd = arg;
+   if (wd->model != NULL && wd->enabled)
+      fst_detach(wd);
+}
+
+void wave_dumper_set_window(wave_dumper_t *wd, uint64_t start, uint64_t stop)
+{
+   assert(wd->model == NULL);
+
+   wd->start_time = start;
+   wd->stop_time  = stop;
+}
+
+void wave_dumper_set_history(wave_dumper_t *wd, size_t size)
+{
+   assert(wd->model == NULL);
+   assert(wd->ring == NULL);
+
+   wd->ring = xcalloc(sizeof(fst_ring_t));
+   wd->ring->buf  = xmalloc(size);
+   wd->ring->size = size;
+}
+
+void wave_dumper_keep_open(wave_dumper_t *wd)
+{
+   assert(wd->model == NULL);
+   wd->keep_open = true;
+}
+
+void wave_dumper_enable(wave_dumper_t *wd, bool enable)
+{
+   assert(wd->model != NULL);
+
+   if (enable && !wd->enabled)
+      fst_attach(wd);
+   else if (!enable && wd->enabled)
+      fst_detach(wd);
+}
+
 void wave_dumper_restart(wave_dumper_t *wd, rt_model_t *m, jit_t *jit)
 {
    wd->last_time = UINT64_MAX;
@@ -1251,14 +1576,24 @@ void wave_dumper_restart(wave_dumper_t *wd, rt_model_t *m, jit_t *jit)
       wd->gtkw = NULL;
    }
 
-   // Emitting the initial values must happen after all FST variables
-   // are created to avoid expensive mmap/munmap calls
-   for (int i = 0; i < wd->dumped.count; i++) {
-      fst_data_t *data = wd->dumped.items[i];
-      fst_event_cb(0, data->signal, data->watch, data);
+   // The watches created while walking the design are needed to find
+   // aliases of dumped signals but are removed again if dumping starts
+   // later
+   wd->enabled = true;
+   if (wd->start_time > model_now(m, NULL)) {
+      fst_detach(wd);
+      model_set_timeout_cb(m, wd->start_time, fst_start_cb, wd);
    }
+   else
+      fst_attach(wd);
+
+   if (wd->stop_time != TIME_HIGH)
+      model_set_timeout_cb(m, wd->stop_time, fst_stop_cb, wd);
+
+   if (wd->ring != NULL)
+      model_set_phase_cb(m, END_TIME_STEP, fst_history_cb, wd);
 
-   model_set_phase_cb(m, END_OF_SIMULATION, fst_close, wd);
+   model_set_phase_cb(m, END_OF_SIMULATION, fst_end_cb, wd);
 }
 
 wave_dumper_t *wave_dumper_new(const char *file, const char *gtkw_file,
@@ -1267,6 +1602,7 @@ wave_dumper_t *wave_dumper_new(const char *file, const char *gtkw_file,
    wave_dumper_t *wd = xcalloc(sizeof(wave_dumper_t));
    wd->top       = top;
    wd->last_time = UINT64_MAX;
+   wd->stop_time = TIME_HIGH;
    wd->typecache = hash_new(128);
 
    if (format == WAVE_FORMAT_VCD) {
@@ -1299,9 +1635,26 @@ wave_dumper_t *wave_dumper_new(const char *file, const char *gtkw_file,
    fstWriterSetFileType(wd->fst_ctx, FST_FT_VHDL);
    fstWriterSetTimescale(wd->fst_ctx, -15);
    fstWriterSetVersion(wd->fst_ctx, PACKAGE_STRING);
-   fstWriterSetPackType(wd->fst_ctx, 0);
    fstWriterSetRepackOnClose(wd->fst_ctx, 1);
-   fstWriterSetParallelMode(wd->fst_ctx, 0);
+
+   if (opt_get_int(OPT_WAVE_ASYNC)) {
+#ifdef FST_WRITER_PARALLEL
+      // Each full block of value changes is handed to a background
+      // thread for compression with the faster LZ4 algorithm so the
+      // simulation thread only appends to the in-memory buffer
+      fstWriterSetPackType(wd->fst_ctx, FST_WR_PT_LZ4);
+      fstWriterSetParallelMode(wd->fst_ctx, 1);
+#else
+      warnf("background waveform compression is not supported on this "
+            "platform");
+      fstWriterSetPackType(wd->fst_ctx, FST_WR_PT_ZLIB);
+      fstWriterSetParallelMode(wd->fst_ctx, 0);
+#endif
+   }
+   else {
+      fstWriterSetPackType(wd->fst_ctx, FST_WR_PT_ZLIB);
+      fstWriterSetParallelMode(wd->fst_ctx, 0);
+   }
 
    if (gtkw_file != NULL) {
       wd->gtkw = xcalloc(sizeof(gtkw_writer_t));
@@ -1317,10 +1670,25 @@ wave_dumper_t *wave_dumper_new(const char *file, const char *gtkw_file,
 
 void wave_dumper_free(wave_dumper_t *wd)
 {
-   for (int i = 0; i < wd->dumped.count; i++)
-      free(wd->dumped.items[i]);
+   if (wd->model != NULL)
+      fst_close(wd->model, wd);   // Simulation did not finish
+
+   for (int i = 0; i < wd->dumped.count; i++) {
+      fst_data_t *data = wd->dumped.items[i];
+      if (data->initial != NULL) {
+         for (int j = 0; j < data->count; j++)
+            free(data->initial[j].bytes);
+         free(data->initial);
+      }
+      free(data);
+   }
    ACLEAR(wd->dumped);
 
+   if (wd->ring != NULL) {
+      free(wd->ring->buf);
+      free(wd->ring);
+   }
+
    hash_free(wd->typecache);
    free(wd);
 }
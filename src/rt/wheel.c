@@ -0,0 +1,342 @@
+//
+//  Copyright (C) 2026  Nick Gasson
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "util.h"
+#include "array.h"
+#include "rt/rt.h"
+#include "rt/wheel.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Hierarchical timing wheel: each key is filed under the highest byte
+// in which it differs from the current base key so that events in the
+// near future can be inserted and extracted in constant time.  Keys
+// which differ from the base above WHEEL_BITS are kept in a binary
+// heap and pulled into the wheel once it drains.
+
+#define SLOT_BITS  8
+#define NSLOTS     (1 << SLOT_BITS)
+#define LEVELS     4
+#define WHEEL_BITS (SLOT_BITS * LEVELS)
+
+typedef struct {
+   uint64_t  key;
+   void     *user;
+} wheel_node_t;
+
+typedef struct {
+   wheel_node_t *nodes;
+   uint32_t      head;
+   uint32_t      count;
+   uint32_t      limit;
+   uint64_t      min;
+} wheel_slot_t;
+
+typedef struct {
+   uint64_t     bitmap[NSLOTS / 64];
+   wheel_slot_t slots[NSLOTS];
+} wheel_level_t;
+
+typedef struct _wheel {
+   uint64_t      base;
+   size_t        count;
+   uint64_t      min_key;
+   bool          min_valid;
+   heap_t       *overflow;
+   nvc_lock_t    lock;
+   wheel_level_t levels[LEVELS];
+} wheel_t;
+
+static inline int slot_for(uint64_t key, int level)
+{
+   return (key >> (level * SLOT_BITS)) & (NSLOTS - 1);
+}
+
+static int next_slot(wheel_level_t *l, int start)
+{
+   for (int i = start / 64; i < NSLOTS / 64; i++) {
+      uint64_t word = l->bitmap[i];
+      if (i == start / 64)
+         word &= ~UINT64_C(0) << (start % 64);
+
+      if (word != 0)
+         return i * 64 + __builtin_ctzll(word);
+   }
+
+   return -1;
+}
+
+static void wheel_place(wheel_t *w, uint64_t key, void *user)
+{
+   assert(key >= w->base);
+
+   const uint64_t diff = key ^ w->base;
+   const int level = diff == 0 ? 0 : (63 - __builtin_clzll(diff)) / SLOT_BITS;
+   assert(level < LEVELS);
+
+   const int slot = slot_for(key, level);
+   wheel_level_t *l = &(w->levels[level]);
+   wheel_slot_t *s = &(l->slots[slot]);
+
+   if (s->count == 0) {
+      l->bitmap[slot / 64] |= UINT64_C(1) << (slot % 64);
+      s->min = key;
+   }
+   else if (key < s->min)
+      s->min = key;
+
+   if (unlikely(s->count == s->limit)) {
+      s->limit = MAX(s->limit * 2, 16);
+      s->nodes = xrealloc_array(s->nodes, s->limit, sizeof(wheel_node_t));
+   }
+
+   s->nodes[s->count++] = (wheel_node_t){ key, user };
+   w->count++;
+}
+
+static inline void wheel_clear_slot(wheel_t *w, int level, int slot)
+{
+   wheel_level_t *l = &(w->levels[level]);
+   l->bitmap[slot / 64] &= ~(UINT64_C(1) << (slot % 64));
+   l->slots[slot].head = l->slots[slot].count = 0;
+}
+
+static void wheel_add(wheel_t *w, uint64_t key, void *user)
+{
+   if ((key ^ w->base) >> WHEEL_BITS)
+      heap_insert(w->overflow, key, user);
+   else
+      wheel_place(w, key, user);
+}
+
+static void wheel_rebase(wheel_t *w, uint64_t base)
+{
+   // Redistribute everything relative to a lower base key: this should
+   // only happen if a key is inserted behind the last extracted key
+   A(wheel_node_t) all = AINIT;
+   for (int i = 0; i < LEVELS; i++) {
+      wheel_level_t *l = &(w->levels[i]);
+      for (int j = next_slot(l, 0); j != -1; j = next_slot(l, j + 1)) {
+         wheel_slot_t *s = &(l->slots[j]);
+         for (int k = s->head; k < s->count; k++)
+            APUSH(all, s->nodes[k]);
+         wheel_clear_slot(w, i, j);
+      }
+   }
+
+   w->count = 0;
+   w->base = base;
+
+   for (int i = 0; i < all.count; i++)
+      wheel_add(w, all.items[i].key, all.items[i].user);
+
+   ACLEAR(all);
+}
+
+static void wheel_refill(wheel_t *w)
+{
+   assert(w->count == 0);
+
+   w->base = heap_min_key(w->overflow);
+
+   while (heap_size(w->overflow) > 0) {
+      const uint64_t key = heap_min_key(w->overflow);
+      if ((key ^ w->base) >> WHEEL_BITS)
+         break;
+
+      wheel_place(w, key, heap_extract_min(w->overflow));
+   }
+}
+
+static void wheel_cascade(wheel_t *w, int level, int slot)
+{
+   wheel_slot_t *s = &(w->levels[level].slots[slot]);
+
+   // All other keys in the wheel share the bits above this level with
+   // the new base so their placement does not change, and every entry
+   // in this slot moves to a lower level
+   w->base = s->min;
+   w->count -= s->count - s->head;
+
+   for (int i = s->head; i < s->count; i++)
+      wheel_place(w, s->nodes[i].key, s->nodes[i].user);
+
+   wheel_clear_slot(w, level, slot);
+}
+
+wheel_t *wheel_new(void)
+{
+   wheel_t *w = xcalloc(sizeof(wheel_t));
+   w->overflow = heap_new(64);
+   return w;
+}
+
+void wheel_free(wheel_t *w)
+{
+   for (int i = 0; i < LEVELS; i++) {
+      for (int j = 0; j < NSLOTS; j++)
+         free(w->levels[i].slots[j].nodes);
+   }
+
+   heap_free(w->overflow);
+   free(w);
+}
+
+size_t wheel_size(wheel_t *w)
+{
+   return w->count + heap_size(w->overflow);
+}
+
+void wheel_insert(wheel_t *w, uint64_t key, void *user)
+{
+   RT_LOCK(w->lock);
+
+   if (w->count == 0 && heap_size(w->overflow) == 0)
+      w->base = key;
+   else if (unlikely(key < w->base))
+      wheel_rebase(w, key);
+
+   if (w->min_valid && key < w->min_key)
+      w->min_key = key;
+
+   wheel_add(w, key, user);
+}
+
+uint64_t wheel_min_key(wheel_t *w)
+{
+   RT_LOCK(w->lock);
+
+   assert(wheel_size(w) > 0);
+
+   if (w->min_valid)
+      return w->min_key;
+
+   // Must not move the base here as the caller may go on to insert
+   // keys smaller than the current minimum
+   uint64_t min = UINT64_MAX;
+   if (w->count == 0)
+      min = heap_min_key(w->overflow);
+   else {
+      for (int i = 0; i < LEVELS; i++) {
+         const int start = i == 0 ? slot_for(w->base, 0) : 0;
+         const int slot = next_slot(&(w->levels[i]), start);
+         if (slot != -1) {
+            min = w->levels[i].slots[slot].min;
+            break;
+         }
+      }
+   }
+
+   w->min_key = min;
+   w->min_valid = true;
+   return min;
+}
+
+void *wheel_extract_min(wheel_t *w)
+{
+   RT_LOCK(w->lock);
+
+   assert(wheel_size(w) > 0);
+
+   if (w->count == 0)
+      wheel_refill(w);
+
+   wheel_level_t *l0 = &(w->levels[0]);
+   int slot = next_slot(l0, slot_for(w->base, 0));
+   for (int i = 1; slot == -1; i++) {
+      assert(i < LEVELS);
+      const int hslot = next_slot(&(w->levels[i]), 0);
+      if (hslot != -1) {
+         wheel_cascade(w, i, hslot);
+         slot = next_slot(l0, slot_for(w->base, 0));
+         i = 0;
+      }
+   }
+
+   wheel_slot_t *s = &(l0->slots[slot]);
+   void *user = s->nodes[s->head++].user;
+
+   w->base = s->min;
+   w->count--;
+
+   if (s->head == s->count) {
+      wheel_clear_slot(w, 0, slot);
+      w->min_valid = false;
+   }
+   else {
+      w->min_key = s->min;
+      w->min_valid = true;
+   }
+
+   return user;
+}
+
+void wheel_walk(wheel_t *w, heap_walk_fn_t fn, void *context)
+{
+   RT_LOCK(w->lock);
+
+   for (int i = 0; i < LEVELS; i++) {
+      for (int j = 0; j < NSLOTS; j++) {
+         wheel_slot_t *s = &(w->levels[i].slots[j]);
+         for (int k = s->head; k < s->count; k++)
+            (*fn)(s->nodes[k].key, s->nodes[k].user, context);
+      }
+   }
+
+   heap_walk(w->overflow, fn, context);
+}
+
+bool wheel_delete(wheel_t *w, heap_delete_fn_t fn, void *context)
+{
+   RT_LOCK(w->lock);
+
+   for (int i = 0; i < LEVELS; i++) {
+      wheel_level_t *l = &(w->levels[i]);
+      for (int j = next_slot(l, 0); j != -1; j = next_slot(l, j + 1)) {
+         wheel_slot_t *s = &(l->slots[j]);
+         for (int k = s->head; k < s->count; k++) {
+            if (!(*fn)(s->nodes[k].key, s->nodes[k].user, context))
+               continue;
+
+            // Preserve insertion order for entries with the same key
+            memmove(s->nodes + k, s->nodes + k + 1,
+                    (s->count - k - 1) * sizeof(wheel_node_t));
+
+            if (--(s->count) == s->head)
+               wheel_clear_slot(w, i, j);
+            else if (i > 0) {
+               s->min = UINT64_MAX;
+               for (int n = s->head; n < s->count; n++)
+                  s->min = MIN(s->min, s->nodes[n].key);
+            }
+
+            w->count--;
+            w->min_valid = false;
+            return true;
+         }
+      }
+   }
+
+   if (heap_delete(w->overflow, fn, context)) {
+      w->min_valid = false;
+      return true;
+   }
+
+   return false;
+}
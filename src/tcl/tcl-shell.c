@@ -22,10 +22,13 @@
 #include "printf.h"
 #include "rt/assert.h"
 #include "rt/model.h"
+#include "rt/random.h"
 #include "rt/structs.h"
+#include "rt/wave.h"
 #include "tcl/tcl-priv.h"
 #include "tcl/tcl-shell.h"
 #include "tcl/tcl-structs.h"
+#include "thread.h"
 #include "tree.h"
 #include "type.h"
 
@@ -38,6 +41,10 @@
 #include <string.h>
 #include <unistd.h>
 
+#ifndef __MINGW32__
+#include <sys/wait.h>
+#endif
+
 #include <readline/readline.h>
 #include <readline/history.h>
 
@@ -536,29 +543,10 @@ static int shell_cmd_force(ClientData cd, Tcl_Interp *interp,
    if (ss == NULL)
       return TCL_ERROR;
 
-   type_t type = tree_type(ss->signal->where);
-
-   parsed_value_t value;
-   if (!parse_value(type, valstr, &value))
-      return tcl_error(sh, "value '%s' is not valid for type %s",
-                       valstr, type_pp(type));
-
-   if (type_is_scalar(type))
-      force_signal(sh->model, ss->signal, &value.integer, 0, 1);
-   else if (type_is_character_array(type)) {
-      const int width = signal_width(ss->signal);
-      if (value.enums->count != width) {
-         tcl_error(sh, "expected %d elements for signal %s but have %d", width,
-                   signame, value.enums->count);
-         free(value.enums);
-         return TCL_ERROR;
-      }
-
-      force_signal(sh->model, ss->signal, value.enums->values, 0, width);
-      free(value.enums);
-   }
-   else
-      return tcl_error(sh, "cannot force signals of type %s", type_pp(type));
+   LOCAL_TEXT_BUF err = tb_new();
+   if (!set_signal_value(sh->model, ss->signal, signame, valstr,
+                         SET_FORCE, err))
+      return tcl_error(sh, "%s", tb_get(err));
 
    return TCL_OK;
 }
@@ -610,6 +598,196 @@ static int shell_cmd_noforce(ClientData cd, Tcl_Interp *interp,
    return TCL_OK;
 }
 
+static const char deposit_help[] =
+   "Deposit a value on a signal\n"
+   "\n"
+   "Syntax:\n"
+   "  deposit <signal> <value>\n"
+   "\n"
+   "Value has the same format as for $bold$force$$. The new value takes "
+   "effect in the next delta cycle and unlike a forced value is replaced "
+   "by the next update from a driver of the signal.\n"
+   "\n"
+   "Examples:\n"
+   "  deposit /uut/foo '1'\n"
+   "  deposit /bitvec \"10011\"\n";
+
+static int shell_cmd_deposit(ClientData cd, Tcl_Interp *interp,
+                             int objc, Tcl_Obj *const objv[])
+{
+   tcl_shell_t *sh = cd;
+
+   if (!shell_has_model(sh))
+      return TCL_ERROR;
+   else if (objc != 3)
+      return syntax_error(sh, objv);
+
+   const char *signame = Tcl_GetString(objv[1]);
+   const char *valstr = Tcl_GetString(objv[2]);
+
+   shell_signal_t *ss = get_signal(sh, signame);
+   if (ss == NULL)
+      return TCL_ERROR;
+
+   LOCAL_TEXT_BUF err = tb_new();
+   if (!set_signal_value(sh->model, ss->signal, signame, valstr,
+                         SET_DEPOSIT, err))
+      return tcl_error(sh, "%s", tb_get(err));
+
+   return TCL_OK;
+}
+
+static const char fork_help[] =
+   "Continue the simulation in a child process\n"
+   "\n"
+   "Syntax:\n"
+   "  fork [-seed <integer>]\n"
+   "\n"
+   "Returns zero in the child process and the process ID of the child "
+   "in the parent. The child shares the state of the simulation with the "
+   "parent until either modifies it, which makes it cheap to run many "
+   "variants of a test after a long initialisation sequence.\n"
+   "\n"
+   "Options:\n"
+   "  -seed <integer>\tSet the random seed in the child process.\n"
+   "\n"
+   "Examples:\n"
+   "  run 10 us\n"
+   "  foreach s {1 2 3} {\n"
+   "    if {[fork -seed $s] == 0} { run; exit }\n"
+   "  }\n"
+   "  exit -code [wait]\n";
+
+static int shell_cmd_fork(ClientData cd, Tcl_Interp *interp,
+                          int objc, Tcl_Obj *const objv[])
+{
+   tcl_shell_t *sh = cd;
+
+   if (!shell_has_model(sh))
+      return TCL_ERROR;
+
+   int pos = 1, seed = 0;
+   bool have_seed = false;
+   for (const char *opt; (opt = next_option(&pos, objc, objv)); ) {
+      if (strcmp(opt, "-seed") == 0 && pos < objc) {
+         if (Tcl_GetIntFromObj(interp, objv[pos++], &seed) != TCL_OK)
+            return TCL_ERROR;
+         have_seed = true;
+      }
+      else
+         return syntax_error(sh, objv);
+   }
+
+   if (pos != objc)
+      return syntax_error(sh, objv);
+
+#ifdef __MINGW32__
+   return tcl_error(sh, "fork is not supported on this platform");
+#else
+   Tcl_Flush(Tcl_GetStdChannel(TCL_STDOUT));
+   fflush(NULL);
+
+   const int pid = thread_fork();
+   if (pid < 0)
+      return tcl_error(sh, "fork failed: %s", last_os_error());
+   else if (pid == 0 && have_seed)
+      set_random_seed(seed);
+
+   Tcl_SetObjResult(interp, Tcl_NewIntObj(pid));
+   return TCL_OK;
+#endif
+}
+
+static const char wait_help[] =
+   "Wait for all child processes created by $bold$fork$$\n"
+   "\n"
+   "Syntax:\n"
+   "  wait\n"
+   "\n"
+   "Returns the highest exit status of any child process.\n";
+
+static int shell_cmd_wait(ClientData cd, Tcl_Interp *interp,
+                          int objc, Tcl_Obj *const objv[])
+{
+   tcl_shell_t *sh = cd;
+
+   if (objc != 1)
+      return syntax_error(sh, objv);
+
+   int status = 0;
+#ifndef __MINGW32__
+   for (;;) {
+      int wstatus;
+      if (waitpid(-1, &wstatus, 0) < 0) {
+         if (errno == EINTR)
+            continue;
+         else if (errno == ECHILD)
+            break;
+         return tcl_error(sh, "wait failed: %s", last_os_error());
+      }
+
+      if (WIFEXITED(wstatus))
+         status = MAX(status, WEXITSTATUS(wstatus));
+      else if (WIFSIGNALED(wstatus))
+         status = MAX(status, 128 + WTERMSIG(wstatus));
+   }
+#endif
+
+   Tcl_SetObjResult(interp, Tcl_NewIntObj(status));
+   return TCL_OK;
+}
+
+static const char wave_help[] =
+   "Start or stop writing waveform data\n"
+   "\n"
+   "Syntax:\n"
+   "  wave on [<file>]\n"
+   "  wave off\n"
+   "\n"
+   "The first $bold$wave on$$ command creates the FST file which defaults "
+   "to $bold$wave.fst$$. Signal changes are only recorded while dumping is "
+   "switched on, which avoids the overhead of recording the whole "
+   "simulation.\n"
+   "\n"
+   "Examples:\n"
+   "  run 1 ms\n"
+   "  wave on dump.fst\n"
+   "  run 10 us\n"
+   "  wave off\n";
+
+static int shell_cmd_wave(ClientData cd, Tcl_Interp *interp,
+                          int objc, Tcl_Obj *const objv[])
+{
+   tcl_shell_t *sh = cd;
+
+   if (!shell_has_model(sh))
+      return TCL_ERROR;
+   else if (objc < 2 || objc > 3)
+      return syntax_error(sh, objv);
+
+   const char *what = Tcl_GetString(objv[1]);
+   if (strcmp(what, "on") == 0) {
+      if (sh->wave == NULL) {
+         const char *file = objc == 3 ? Tcl_GetString(objv[2]) : "wave.fst";
+         sh->wave = wave_dumper_new(file, NULL, sh->top, WAVE_FORMAT_FST);
+         wave_dumper_keep_open(sh->wave);
+         wave_dumper_restart(sh->wave, sh->model, sh->jit);
+      }
+      else if (objc == 3)
+         return tcl_error(sh, "waveform file is already open");
+      else
+         wave_dumper_enable(sh->wave, true);
+   }
+   else if (strcmp(what, "off") == 0 && objc == 2) {
+      if (sh->wave != NULL)
+         wave_dumper_enable(sh->wave, false);
+   }
+   else
+      return syntax_error(sh, objv);
+
+   return TCL_OK;
+}
+
 static const char exit_help[] =
    "Exit the simulator and return a status code\n"
    "\n"
@@ -899,6 +1077,10 @@ tcl_shell_t *shell_new(tree_t top, jit_t *jit, rt_model_t *m)
    shell_add_cmd(sh, "exa", shell_cmd_examine, examine_help);
    shell_add_cmd(sh, "force", shell_cmd_force, force_help);
    shell_add_cmd(sh, "noforce", shell_cmd_noforce, noforce_help);
+   shell_add_cmd(sh, "deposit", shell_cmd_deposit, deposit_help);
+   shell_add_cmd(sh, "fork", shell_cmd_fork, fork_help);
+   shell_add_cmd(sh, "wait", shell_cmd_wait, wait_help);
+   shell_add_cmd(sh, "wave", shell_cmd_wave, wave_help);
    shell_add_cmd(sh, "echo", shell_cmd_echo, echo_help);
    shell_add_cmd(sh, "describe", shell_cmd_describe, describe_help);
 
@@ -911,6 +1093,9 @@ tcl_shell_t *shell_new(tree_t top, jit_t *jit, rt_model_t *m)
 
 void shell_free(tcl_shell_t *sh)
 {
+   if (sh->wave != NULL)
+      wave_dumper_free(sh->wave);
+
    hash_free(sh->namemap);
    printer_free(sh->printer);
    Tcl_DeleteInterp(sh->interp);
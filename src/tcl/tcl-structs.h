@@ -72,6 +72,7 @@ typedef struct _tcl_shell {
    int64_t          now_var;
    unsigned         deltas_var;
    printer_t       *printer;
+   wave_dumper_t   *wave;
    get_line_fn_t    getline;
    shell_handler_t  handler;
    bool             quit;
@@ -1267,6 +1267,30 @@ void async_free(void *ptr)
    // TODO: free when all threads in quiescent state
 }
 
+int thread_fork(void)
+{
+#ifdef __MINGW32__
+   fatal("fork is not supported on this platform");
+#else
+   assert(my_thread->kind == MAIN_THREAD);
+
+   // Threads created by the user or a plugin cannot be stopped here
+   for (int i = 1; i < MAX_THREADS; i++) {
+      nvc_thread_t *t = atomic_load(&threads[i]);
+      if (t != NULL && relaxed_load(&t->kind) == USER_THREAD)
+         fatal("cannot fork while thread %s is running", t->name);
+   }
+
+   // Only the calling thread exists in the child so finish any pending
+   // work and stop the workers first: they are created again on demand
+   async_barrier();
+   join_worker_threads();
+   atomic_store(&should_stop, false);
+
+   return fork();
+#endif
+}
+
 #ifdef POSIX_SUSPEND
 static void suspend_handler(int sig, siginfo_t *info, void *context)
 {
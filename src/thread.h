@@ -105,6 +105,8 @@ void async_do(task_fn_t fn, void *context, void *arg);
 void async_barrier(void);
 void async_free(void *ptr);
 
+int thread_fork(void);
+
 struct cpu_state;
 typedef void (*stop_world_fn_t)(int, struct cpu_state *, void *);
 
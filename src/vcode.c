@@ -772,6 +772,7 @@ void vcode_opt(void)
             case VCODE_OP_ALLOC:
             case VCODE_OP_FUNCTION_TRIGGER:
             case VCODE_OP_CMP_TRIGGER:
+            case VCODE_OP_EDGE_TRIGGER:
             case VCODE_OP_OR_TRIGGER:
                if (uses[o->result] == -1) {
                   vcode_dump_with_mark(j, NULL, NULL);
@@ -1050,7 +1051,7 @@ const char *vcode_op_string(vcode_op_t op)
       "or trigger", "cmp trigger", "instance name",
       "bind external", "array scope", "record scope",
       "dir check", "sched process", "table ref", "get counters", "put driver",
-      "deposit signal", "sched active",
+      "deposit signal", "sched active", "edge trigger",
    };
    if ((unsigned)op >= ARRAY_LEN(strs))
       return "???";
@@ -2390,6 +2391,19 @@ void vcode_dump_with_mark(int mark_op, vcode_dump_fn_t callback, void *arg)
             }
             break;
 
+         case VCODE_OP_EDGE_TRIGGER:
+            {
+               col += vcode_dump_reg(op->result);
+               col += nvc_printf(" := %s ", vcode_op_string(op->kind));
+               col += vcode_dump_reg(op->args.items[0]);
+               col += printf(" mask ");
+               col += vcode_dump_reg(op->args.items[1]);
+               col += printf(" && ");
+               col += vcode_dump_reg(op->args.items[2]);
+               vcode_dump_result_type(col, op);
+            }
+            break;
+
          case VCODE_OP_ADD_TRIGGER:
             {
                printf("%s ", vcode_op_string(op->kind));
@@ -6122,6 +6136,24 @@ vcode_reg_t emit_cmp_trigger(vcode_reg_t left, vcode_reg_t right)
    return (op->result = vcode_add_reg(vtype_trigger(), VCODE_INVALID_STAMP));
 }
 
+vcode_reg_t emit_edge_trigger(vcode_reg_t signal, vcode_reg_t mask,
+                              vcode_reg_t inner)
+{
+   op_t *op = vcode_add_op(VCODE_OP_EDGE_TRIGGER);
+   vcode_add_arg(op, signal);
+   vcode_add_arg(op, mask);
+   vcode_add_arg(op, inner);
+
+   VCODE_ASSERT(vcode_reg_kind(signal) == VCODE_TYPE_SIGNAL,
+                "edge trigger signal argument must be signal");
+   VCODE_ASSERT(vcode_reg_kind(mask) == VCODE_TYPE_INT,
+                "edge trigger mask argument must be integer");
+   VCODE_ASSERT(vcode_reg_kind(inner) == VCODE_TYPE_TRIGGER,
+                "edge trigger inner argument must be trigger");
+
+   return (op->result = vcode_add_reg(vtype_trigger(), VCODE_INVALID_STAMP));
+}
+
 void emit_add_trigger(vcode_reg_t trigger)
 {
    op_t *op = vcode_add_op(VCODE_OP_ADD_TRIGGER);
@@ -172,6 +172,7 @@ typedef enum {
    VCODE_OP_PUT_DRIVER,
    VCODE_OP_DEPOSIT_SIGNAL,
    VCODE_OP_SCHED_ACTIVE,
+   VCODE_OP_EDGE_TRIGGER,
 } vcode_op_t;
 
 typedef enum {
@@ -529,6 +530,8 @@ vcode_reg_t emit_function_trigger(ident_t func, const vcode_reg_t *args,
                                   int nargs);
 vcode_reg_t emit_or_trigger(vcode_reg_t left, vcode_reg_t right);
 vcode_reg_t emit_cmp_trigger(vcode_reg_t left, vcode_reg_t right);
+vcode_reg_t emit_edge_trigger(vcode_reg_t signal, vcode_reg_t mask,
+                              vcode_reg_t inner);
 void emit_add_trigger(vcode_reg_t trigger);
 void emit_bind_foreign(vcode_reg_t spec, vcode_reg_t length, vcode_reg_t locus);
 vcode_reg_t emit_instance_name(vcode_reg_t kind);
@@ -1453,17 +1453,24 @@ static mir_value_t vlog_lower_trigger(vlog_gen_t *g, vlog_node_t v)
          else {
             vlog_select_t lvalue = vlog_lower_select(g, vlog_value(v));
 
+            // The edge trigger mask is indexed by the low bits of the
+            // new net value where bit 0 is the A bit and bit 1 the B
+            // bit: a posedge can only end in 1, X, or Z and a negedge
+            // can only end in 0, X, or Z
             ident_t func;
+            uint64_t mask;
             switch (kind) {
             case V_EVENT_POSEDGE:
                func = ident_new("@posedge");
                mir_defer(mir_get_context(g->mu), func, NULL, MIR_UNIT_FUNCTION,
                          vlog_lower_posedge_fn, NULL);
+               mask = UINT64_C(0xeeeeeeeeeeeeeeee);
                break;
             case V_EVENT_NEGEDGE:
                func = ident_new("@negedge");
                mir_defer(mir_get_context(g->mu), func, NULL, MIR_UNIT_FUNCTION,
                          vlog_lower_negedge_fn, NULL);
+               mask = UINT64_C(0xdddddddddddddddd);
                break;
             default:
                should_not_reach_here();
@@ -1471,7 +1478,11 @@ static mir_value_t vlog_lower_trigger(vlog_gen_t *g, vlog_node_t v)
 
             mir_value_t context = mir_build_context_upref(g->mu, 0);
             mir_value_t args[] = { context, lvalue.obj };
-            return mir_build_function_trigger(g->mu, func, args, 2);
+            mir_value_t fn = mir_build_function_trigger(g->mu, func, args, 2);
+
+            mir_type_t t_offset = mir_offset_type(g->mu);
+            mir_value_t bits = mir_const(g->mu, t_offset, mask);
+            return mir_build_edge_trigger(g->mu, lvalue.obj, bits, fn);
          }
       }
    case V_NUMBER:
@@ -0,0 +1,126 @@
+//
+//  Copyright (C) 2026  Nick Gasson
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "util.h"
+#include "fbuf.h"
+#include "option.h"
+#include "thread.h"
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+const char copy_string[] = "";
+const char version_string[] = "";
+
+#define DEFAULT_MB 256
+#define BENCH_FILE "fbufbench.tmp"
+
+static const struct {
+   const char *name;
+   fbuf_zip_t  zip;
+} codecs[] = {
+   { "none",   FBUF_ZIP_NONE },
+   { "fastlz", FBUF_ZIP_FASTLZ },
+   { "lz4",    FBUF_ZIP_LZ4 },
+   { "zstd",   FBUF_ZIP_ZSTD },
+};
+
+static inline uint64_t next_value(uint32_t *rng)
+{
+   // Mostly small integers with some repetition, similar to the object
+   // kinds, indexes, and ident references in a library unit
+   *rng = *rng * 1103515245 + 12345;
+   const uint32_t r = *rng >> 8;
+   switch (r & 7) {
+   case 0: return r >> 3;
+   case 1: case 2: return (r >> 3) & 0xfff;
+   default: return (r >> 3) & 0x1f;
+   }
+}
+
+static void write_file(fbuf_zip_t zip, uint64_t count)
+{
+   fbuf_t *f = fbuf_open(BENCH_FILE, FBUF_OUT, FBUF_CS_ADLER32);
+   if (f == NULL)
+      fatal_errno("cannot create %s", BENCH_FILE);
+
+   fbuf_set_zip(f, zip);
+
+   uint32_t rng = 42;
+   for (uint64_t i = 0; i < count; i++)
+      fbuf_put_uint(f, next_value(&rng));
+
+   fbuf_close(f, NULL);
+}
+
+static uint64_t read_file(uint64_t count)
+{
+   fbuf_t *f = fbuf_open(BENCH_FILE, FBUF_IN, FBUF_CS_ADLER32);
+   if (f == NULL)
+      fatal_errno("cannot open %s", BENCH_FILE);
+
+   uint64_t sum = 0;
+   for (uint64_t i = 0; i < count; i++)
+      sum += fbuf_get_uint(f);
+
+   fbuf_close(f, NULL);
+   return sum;
+}
+
+int main(int argc, char **argv)
+{
+   term_init();
+   thread_init();
+   register_signal_handlers();
+   set_default_options();
+
+   opt_set_str(OPT_COMPRESSION, NULL);   // Allow fbuf_set_zip
+
+   const int mb = argc > 1 ? atoi(argv[1]) : DEFAULT_MB;
+   if (mb <= 0)
+      fatal("usage: %s [MEGABYTES]", argv[0]);
+
+   // Each value encodes to about one and a half bytes on average
+   const uint64_t count = (uint64_t)mb * 1024 * 1024 * 2 / 3;
+
+   printf("CODEC    SIZE (MB)   WRITE MB/s   READ MB/s\n");
+
+   for (int i = 0; i < ARRAY_LEN(codecs); i++) {
+      const uint64_t wstart = get_timestamp_us();
+      write_file(codecs[i].zip, count);
+      const uint64_t wend = get_timestamp_us();
+
+      file_info_t info;
+      if (!get_file_info(BENCH_FILE, &info))
+         fatal_errno("%s", BENCH_FILE);
+
+      // Run once to warm the page cache then measure
+      read_file(count);
+
+      const uint64_t rstart = get_timestamp_us();
+      read_file(count);
+      const uint64_t rend = get_timestamp_us();
+
+      printf("%-8s %9.1f %12.1f %11.1f\n", codecs[i].name,
+             info.size / 1048576.0, mb / ((wend - wstart) / 1.0e6),
+             mb / ((rend - rstart) / 1.0e6));
+   }
+
+   remove(BENCH_FILE);
+   return 0;
+}
@@ -339,6 +339,8 @@ static void usage(void)
           "     --baseline\t\t Save current results as baseline\n"
           " -f PATTERN\t\t Only run tests matching PATTERN\n"
           " -L PATH\t\tAdd PATH to library search paths\n"
+          "     --vector-width=BITS Limit vector intrinsics to BITS wide\n"
+          "\t\t\t (0 disables them and 1 removes the limit)\n"
           "\n");
 
    LOCAL_TEXT_BUF tb = tb_new();
@@ -367,6 +369,7 @@ int main(int argc, char **argv)
    static struct option long_options[] = {
       { "baseline", no_argument, 0, 'b' },
       { "std", required_argument, 0, 's' },
+      { "vector-width", required_argument, 0, 'w' },
       { 0, 0, 0, 0 }
    };
 
@@ -400,6 +403,18 @@ int main(int argc, char **argv)
       case 'i':
          opt_set_int(OPT_JIT_THRESHOLD, 0);
          break;
+      case 'w':
+         {
+            char *eptr = NULL;
+            const int width = strtol(optarg, &eptr, 10);
+            if (*eptr != '\0' || (width != 0 && width != 1
+                                  && width != 128 && width != 256
+                                  && width != 512))
+               fatal("invalid vector width %s (allowed 0, 1, 128, 256, 512)",
+                     optarg);
+            opt_set_int(OPT_VECTOR_INTRINSICS, width);
+         }
+         break;
       default:
          if (optopt == 0)
             fatal("unrecognised option $bold$%s$$", argv[optind - 1]);
@@ -5,6 +5,11 @@ package std_logic_perf is
     procedure test_xor;
     procedure test_equal;
     procedure test_not_equal;
+    procedure test_to_x01_wide;
+    procedure test_and_wide;
+    procedure test_xor_wide;
+    procedure test_not_wide;
+    procedure test_equal_wide;
 end package;
 
 library ieee;
@@ -82,4 +87,63 @@ package body std_logic_perf is
         end loop;
         assert count = 0;
     end procedure;
+
+    -- Wide datapath variants to compare vector intrinsic widths
+
+    procedure test_to_x01_wide is
+        constant ITERS : integer := 100;
+        variable s     : std_logic_vector(511 downto 0);
+    begin
+        for i in 1 to ITERS loop
+            s := (others => 'H');
+            s(i) := 'Z';
+            s := to_x01(s);
+            assert s(i) = 'X';
+        end loop;
+    end procedure;
+
+    procedure test_and_wide is
+        constant ITERS : integer := 100;
+        variable x, y  : std_logic_vector(511 downto 0);
+    begin
+        y := (others => '1');
+        for i in 1 to ITERS loop
+            x(i) := '1';
+            x := x and y;
+        end loop;
+    end procedure;
+
+    procedure test_xor_wide is
+        constant ITERS : integer := 100;
+        variable x, y  : std_logic_vector(511 downto 0) := (others => '0');
+    begin
+        for i in 1 to ITERS loop
+            y(i) := '1';
+            x := x xor y;
+        end loop;
+    end procedure;
+
+    procedure test_not_wide is
+        constant ITERS : integer := 100;
+        variable x     : std_logic_vector(511 downto 0) := (others => '0');
+    begin
+        for i in 1 to ITERS loop
+            x(i) := '1';
+            x := not x;
+        end loop;
+    end procedure;
+
+    procedure test_equal_wide is
+        constant ITERS : integer := 500;
+        variable x, y  : std_logic_vector(511 downto 0);
+        variable count : natural := 0;
+    begin
+        for i in 1 to ITERS loop
+            if x = y then
+                count := count + 1;
+                x(i rem 512) := y(0);
+            end if;
+        end loop;
+        assert count = ITERS;
+    end procedure;
 end package body;
@@ -0,0 +1,60 @@
+library ieee;
+use ieee.std_logic_1164.all;
+use ieee.numeric_std.all;
+
+entity aot1_counter is
+    generic ( WIDTH : positive );
+    port ( clk   : in std_logic;
+           count : out unsigned(WIDTH - 1 downto 0) );
+end entity;
+
+architecture rtl of aot1_counter is
+    signal r : unsigned(WIDTH - 1 downto 0) := (others => '0');
+begin
+    process (clk) is
+    begin
+        if rising_edge(clk) then
+            r <= r + 1;
+        end if;
+    end process;
+
+    count <= r;
+end architecture;
+
+-------------------------------------------------------------------------------
+
+library ieee;
+use ieee.std_logic_1164.all;
+use ieee.numeric_std.all;
+
+entity aot1 is
+end entity;
+
+architecture test of aot1 is
+    signal clk  : std_logic := '0';
+    signal c4   : unsigned(3 downto 0);
+    signal c8   : unsigned(7 downto 0);
+    signal c8b  : unsigned(7 downto 0);
+begin
+
+    u1: entity work.aot1_counter generic map (4) port map (clk, c4);
+    u2: entity work.aot1_counter generic map (8) port map (clk, c8);
+    u3: entity work.aot1_counter generic map (8) port map (clk, c8b);
+
+    check: process is
+    begin
+        for i in 1 to 300 loop
+            clk <= '1';
+            wait for 1 ns;
+            clk <= '0';
+            wait for 1 ns;
+        end loop;
+
+        assert c4 = to_unsigned(300 mod 16, 4);
+        assert c8 = to_unsigned(300 mod 256, 8);
+        assert c8b = c8;
+        assert to_integer(c8) = 44;
+        wait;
+    end process;
+
+end architecture;
@@ -0,0 +1,67 @@
+entity driver24 is
+end entity;
+
+library ieee;
+use ieee.std_logic_1164.all;
+
+architecture test of driver24 is
+    constant W : integer := 100;
+
+    type drivers_t is array (1 to 4) of std_ulogic_vector(1 to W);
+
+    signal d      : drivers_t;
+    signal bus3   : std_logic_vector(1 to W);   -- Three drivers
+    signal bus4   : std_logic_vector(1 to W);   -- Four drivers
+    signal narrow : std_logic_vector(1 to 5);
+begin
+
+    bus3 <= d(1);
+    bus3 <= d(2);
+    bus3 <= d(3);
+
+    g: for i in 1 to 4 generate
+        bus4 <= d(i);
+        narrow <= d(i)(1 to 5);
+    end generate;
+
+    check: process
+        constant vals : std_ulogic_vector := "UX01ZWLH-";
+        variable seed : natural := 1;
+        variable v    : drivers_t;
+    begin
+        for iter in 1 to 50 loop
+            for i in 1 to 4 loop
+                for j in 1 to W loop
+                    seed := (seed * 75 + 74) mod 65537;
+                    if iter mod 3 = 0 and (seed / 11) mod 4 /= 0 then
+                        -- Mostly tri-stated like a real bus
+                        v(i)(j) := 'Z';
+                    else
+                        v(i)(j) := vals((seed / 7) mod 9);
+                    end if;
+                end loop;
+            end loop;
+
+            d <= v;
+            wait for 1 ns;
+
+            for j in 1 to W loop
+                assert bus3(j) = resolved(std_ulogic_vector'(
+                    v(1)(j), v(2)(j), v(3)(j)))
+                    report "bus3(" & integer'image(j) & ") = "
+                    & std_ulogic'image(bus3(j));
+                assert bus4(j) = resolved(std_ulogic_vector'(
+                    v(1)(j), v(2)(j), v(3)(j), v(4)(j)))
+                    report "bus4(" & integer'image(j) & ") = "
+                    & std_ulogic'image(bus4(j));
+            end loop;
+
+            for j in 1 to 5 loop
+                assert narrow(j) = bus4(j);
+            end loop;
+        end loop;
+
+        wait;
+    end process;
+
+end architecture;
@@ -0,0 +1,63 @@
+entity driver25 is
+end entity;
+
+architecture test of driver25 is
+
+    -- Only ever has two sources: the assertion must not fire while the
+    -- resolution function is being memoised
+    function two_sources (v : bit_vector) return bit is
+        variable r : bit := '0';
+    begin
+        assert v'length <= 2 report "too many sources" severity error;
+        for i in v'range loop
+            r := r or v(i);
+        end loop;
+        return r;
+    end function;
+
+    -- Same as a fold with "or" for up to three sources but not four
+    function up_to_three (v : bit_vector) return bit is
+        variable n : natural := 0;
+    begin
+        for i in v'range loop
+            if v(i) = '1' then
+                n := n + 1;
+            end if;
+        end loop;
+        if n > 0 and n < 4 then
+            return '1';
+        else
+            return '0';
+        end if;
+    end function;
+
+    subtype two_bit is two_sources bit;
+    subtype three_bit is up_to_three bit;
+
+    signal s : two_bit;
+    signal t : three_bit;
+begin
+
+    s <= '0';
+    s <= '1' after 1 ns;
+
+    g: for i in 1 to 4 generate
+        t <= '1' after i * ns;
+    end generate;
+
+    check: process is
+    begin
+        wait for 0 ns;
+        assert s = '0';
+        assert t = '0';
+        wait for 1 ns;
+        assert s = '1';
+        assert t = '1';
+        wait for 2 ns;
+        assert t = '1';                 -- Three sources are '1'
+        wait for 1 ns;
+        assert t = '0';                 -- Four sources are '1'
+        wait;
+    end process;
+
+end architecture;
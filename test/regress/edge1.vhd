@@ -0,0 +1,91 @@
+library ieee;
+use ieee.std_logic_1164.all;
+
+entity edge1 is
+end entity;
+
+architecture test of edge1 is
+    signal clk              : std_logic := '0';
+    signal bclk             : bit := '0';
+    signal rises, falls     : natural := 0;
+    signal brises, bfalls   : natural := 0;
+    signal both             : natural := 0;
+begin
+
+    -- Each of these has a single IF statement as the whole body so
+    -- events on the opposite edge never wake the process
+
+    p1: process (clk) is
+    begin
+        if rising_edge(clk) then
+            rises <= rises + 1;
+        end if;
+    end process;
+
+    p2: process (clk) is
+    begin
+        if falling_edge(clk) then
+            falls <= falls + 1;
+        end if;
+    end process;
+
+    p3: process (bclk) is
+    begin
+        if rising_edge(bclk) then
+            brises <= brises + 1;
+        end if;
+    end process;
+
+    p4: process (bclk) is
+    begin
+        if falling_edge(bclk) then
+            bfalls <= bfalls + 1;
+        end if;
+    end process;
+
+    -- Shares the trigger with p1
+    p5: process (clk) is
+    begin
+        if rising_edge(clk) then
+            both <= both + 1;
+        end if;
+    end process;
+
+    stim: process is
+    begin
+        wait for 1 ns;
+        clk <= '1';                     -- Rising
+        wait for 1 ns;
+        clk <= '0';                     -- Falling
+        wait for 1 ns;
+        clk <= 'H';                     -- Rising
+        wait for 1 ns;
+        clk <= 'L';                     -- Falling
+        wait for 1 ns;
+        clk <= 'X';                     -- Neither
+        wait for 1 ns;
+        clk <= '1';                     -- Neither
+        wait for 1 ns;
+        clk <= 'H';                     -- Neither
+        wait for 1 ns;
+        clk <= '0';                     -- Falling
+        wait for 1 ns;
+        clk <= '1';                     -- Rising
+        wait for 1 ns;
+        assert rises = 3;
+        assert falls = 3;
+        assert both = 3;
+
+        for i in 1 to 5 loop
+            bclk <= '1';
+            wait for 1 ns;
+            bclk <= '0';
+            wait for 1 ns;
+        end loop;
+        assert brises = 5;
+        assert bfalls = 5;
+
+        wait;
+    end process;
+
+end architecture;
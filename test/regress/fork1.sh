@@ -0,0 +1,52 @@
+set -xe
+
+pwd
+which nvc
+
+cat >fork1.vhd <<EOF2
+library nvc;
+use nvc.random.all;
+
+entity fork1 is
+end entity;
+
+architecture test of fork1 is
+  signal x : integer := 0;
+  signal s : string(1 to 3) := "abc";
+begin
+  process is
+  begin
+    wait for 2 ns;
+    report "x = " & integer'image(x) & " s = " & s
+      & " r = " & t_uint32'image(get_random);
+    wait;
+  end process;
+end architecture;
+EOF2
+
+nvc -a fork1.vhd -e fork1
+
+# Each variant runs in its own child with a different deposit
+nvc --seed=1 -r --fork-at=1ns --fork=/x=5 --fork='/x=7,/s="xyz"' \
+  --fork=seed=42 --fork='/s="a,b",/x=3' fork1 2>&1 | tee out
+
+grep "x = 5 s = abc" out
+grep "x = 7 s = xyz" out
+grep "x = 0 s = abc" out
+grep "x = 3 s = a,b" out
+[ $(grep -c "x = " out) = 4 ] || exit 1
+
+# The reseeded child must match a run with that seed from the start
+nvc --seed=1 -r fork1 2>&1 | grep -o "r = [0-9]*" > seed1
+nvc --seed=42 -r fork1 2>&1 | grep -o "r = [0-9]*" > seed42
+cmp -s seed1 seed42 && exit 1
+grep "x = 0 s = abc $(cat seed42)" out
+grep "x = 5 s = abc $(cat seed1)" out
+
+nvc -r --fork-at=1ns --fork=/y=1 fork1 2>err && exit 1
+grep "cannot find signal /y" err
+
+nvc -r --threads=2 --fork-at=1ns --fork=/x=1 fork1 2>err && exit 1
+grep "cannot be combined" err
+
+exit 0
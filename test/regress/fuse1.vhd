@@ -0,0 +1,67 @@
+entity fuse1 is
+end entity;
+
+architecture test of fuse1 is
+    type int_array is array (natural range <>) of integer;
+
+    signal clk, rst : bit := '0';
+    signal count    : int_array(1 to 8) := (others => 0);
+    signal other    : integer := 0;
+    signal sum      : integer := 0;
+begin
+
+    -- Eight processes sensitive only to clk which can share one group
+    g: for i in count'range generate
+        process (clk) is
+        begin
+            if clk'event and clk = '1' then
+                count(i) <= count(i) + i;
+            end if;
+        end process;
+    end generate;
+
+    -- Different sensitivity list so not in the same group
+    process (clk, rst) is
+    begin
+        if rst = '1' then
+            other <= 0;
+        elsif clk'event and clk = '1' then
+            other <= other + 1;
+        end if;
+    end process;
+
+    -- Woken by the group members
+    process (count) is
+        variable total : integer;
+    begin
+        total := 0;
+        for i in count'range loop
+            total := total + count(i);
+        end loop;
+        sum <= total;
+    end process;
+
+    check: process is
+    begin
+        for i in 1 to 10 loop
+            clk <= '1';
+            wait for 1 ns;
+            clk <= '0';
+            wait for 1 ns;
+        end loop;
+
+        for i in count'range loop
+            assert count(i) = i * 10;
+        end loop;
+
+        assert other = 10;
+        assert sum = 360;
+
+        rst <= '1';
+        wait for 1 ns;
+        assert other = 0;
+
+        wait;
+    end process;
+
+end architecture;
@@ -0,0 +1,78 @@
+entity ieee21 is
+end entity;
+
+library ieee;
+use ieee.std_logic_1164.all;
+
+architecture test of ieee21 is
+
+    -- Reference implementations of the reduction operators
+
+    function ref_and (v : std_ulogic_vector) return std_ulogic is
+        variable r : std_ulogic := '1';
+    begin
+        for i in v'reverse_range loop
+            r := r and v(i);
+        end loop;
+        return r;
+    end function;
+
+    function ref_or (v : std_ulogic_vector) return std_ulogic is
+        variable r : std_ulogic := '0';
+    begin
+        for i in v'reverse_range loop
+            r := r or v(i);
+        end loop;
+        return r;
+    end function;
+
+    function ref_xor (v : std_ulogic_vector) return std_ulogic is
+        variable r : std_ulogic := '0';
+    begin
+        for i in v'reverse_range loop
+            r := r xor v(i);
+        end loop;
+        return r;
+    end function;
+
+begin
+
+    process
+        constant vals : std_ulogic_vector := "UX01ZWLH-";
+        variable v    : std_ulogic_vector(1 to 150);
+        variable seed : natural := 1;
+    begin
+        for n in 0 to v'length loop
+            for k in 1 to 20 loop
+                for i in 1 to n loop
+                    seed := (seed * 75 + 74) mod 65537;
+                    case k mod 4 is
+                        when 0 => v(i) := vals((seed / 7) mod 9);
+                        when 1 => v(i) := '1';
+                        when others => v(i) := vals(2 + (seed / 7) mod 2);
+                    end case;
+                end loop;
+
+                assert (and v(1 to n)) = ref_and(v(1 to n));
+                assert (nand v(1 to n)) = not ref_and(v(1 to n));
+                assert (or v(1 to n)) = ref_or(v(1 to n));
+                assert (nor v(1 to n)) = not ref_or(v(1 to n));
+                assert (xor v(1 to n)) = ref_xor(v(1 to n));
+                assert (xnor v(1 to n)) = not ref_xor(v(1 to n));
+            end loop;
+        end loop;
+
+        v := (others => '0');
+        v(77) := 'L';
+        assert (or v) = '0';
+        v(100) := 'H';
+        assert (or v) = '1';
+        assert (xor v) = '1';
+        v(5) := 'U';
+        assert (and v) = '0';
+        assert (xor v) = 'U';
+
+        wait;
+    end process;
+
+end architecture;
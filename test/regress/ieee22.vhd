@@ -0,0 +1,104 @@
+entity ieee22 is
+end entity;
+
+library ieee;
+use ieee.std_logic_1164.all;
+
+architecture test of ieee22 is
+
+    -- Element-wise reference implementations to check the vectorised
+    -- intrinsics for every length including partial vectors
+
+    function ref_and (a, b : std_ulogic_vector) return std_ulogic_vector is
+        variable r : std_ulogic_vector(a'range);
+    begin
+        for i in a'range loop
+            r(i) := a(i) and b(i);
+        end loop;
+        return r;
+    end function;
+
+    function ref_or (a, b : std_ulogic_vector) return std_ulogic_vector is
+        variable r : std_ulogic_vector(a'range);
+    begin
+        for i in a'range loop
+            r(i) := a(i) or b(i);
+        end loop;
+        return r;
+    end function;
+
+    function ref_xor (a, b : std_ulogic_vector) return std_ulogic_vector is
+        variable r : std_ulogic_vector(a'range);
+    begin
+        for i in a'range loop
+            r(i) := a(i) xor b(i);
+        end loop;
+        return r;
+    end function;
+
+    function ref_not (a : std_ulogic_vector) return std_ulogic_vector is
+        variable r : std_ulogic_vector(a'range);
+    begin
+        for i in a'range loop
+            r(i) := not a(i);
+        end loop;
+        return r;
+    end function;
+
+    function ref_x01 (a : std_ulogic_vector) return std_ulogic_vector is
+        variable r : std_ulogic_vector(a'range);
+    begin
+        for i in a'range loop
+            r(i) := to_x01(a(i));
+        end loop;
+        return r;
+    end function;
+
+    function ref_eq (a, b : std_ulogic_vector) return boolean is
+    begin
+        for i in a'range loop
+            if a(i) /= b(i) then
+                return false;
+            end if;
+        end loop;
+        return true;
+    end function;
+
+begin
+
+    process
+        constant vals : std_ulogic_vector := "UX01ZWLH-";
+        variable a, b : std_ulogic_vector(1 to 200);
+        variable seed : natural := 1;
+    begin
+        for n in 0 to a'length loop
+            for k in 1 to 6 loop
+                for i in 1 to n loop
+                    seed := (seed * 75 + 74) mod 65537;
+                    a(i) := vals((seed / 7) mod 9);
+                    if k mod 2 = 0 then
+                        b(i) := a(i);
+                    else
+                        seed := (seed * 75 + 74) mod 65537;
+                        b(i) := vals((seed / 7) mod 9);
+                    end if;
+                end loop;
+
+                if k = 4 and n > 0 then
+                    -- Differ in only the last element
+                    b(n) := 'Z' when a(n) /= 'Z' else '1';
+                end if;
+
+                assert (a(1 to n) and b(1 to n)) = ref_and(a(1 to n), b(1 to n));
+                assert (a(1 to n) or b(1 to n)) = ref_or(a(1 to n), b(1 to n));
+                assert (a(1 to n) xor b(1 to n)) = ref_xor(a(1 to n), b(1 to n));
+                assert (not a(1 to n)) = ref_not(a(1 to n));
+                assert to_x01(a(1 to n)) = ref_x01(a(1 to n));
+                assert (a(1 to n) = b(1 to n)) = ref_eq(a(1 to n), b(1 to n));
+            end loop;
+        end loop;
+
+        wait;
+    end process;
+
+end architecture;
@@ -0,0 +1,64 @@
+set -xe
+
+pwd
+which nvc
+
+cat >pack.vhd <<EOF2
+package pack is
+  constant k : integer := 1;
+end package;
+EOF2
+
+cat >ent.vhd <<EOF2
+use work.pack.all;
+entity ent is
+end entity;
+architecture test of ent is
+begin
+  assert k = 1;
+end architecture;
+EOF2
+
+cat >other.vhd <<EOF2
+entity other is
+end entity;
+architecture test of other is
+begin
+end architecture;
+EOF2
+
+nvc -a --incremental pack.vhd ent.vhd other.vhd
+
+[ -f work/_sources ] || exit 1
+
+# Nothing changed so every file is skipped
+NVC_LIB_VERBOSE=1 nvc -a --incremental pack.vhd ent.vhd other.vhd 2>out
+cat out
+grep "skipping unchanged file pack.vhd" out
+grep "skipping unchanged file ent.vhd" out
+grep "skipping unchanged file other.vhd" out
+
+# The same files named through a different path or --relative
+NVC_LIB_VERBOSE=1 nvc -a --incremental --relative=.. $(pwd)/pack.vhd \
+  ./ent.vhd 2>out
+cat out
+[ $(grep -c "skipping unchanged file" out) = 2 ] || exit 1
+
+# Changing the package reanalyses it and the entity that depends on it
+cat >pack.vhd <<EOF2
+package pack is
+  constant k : integer := 2;
+end package;
+EOF2
+
+NVC_LIB_VERBOSE=1 nvc -a --incremental pack.vhd ent.vhd other.vhd 2>out
+cat out
+grep "skipping unchanged file pack.vhd" out && exit 1
+grep "skipping unchanged file ent.vhd" out && exit 1
+grep "skipping unchanged file other.vhd" out
+
+# Analysis without --incremental discards the database
+nvc -a other.vhd
+[ -f work/_sources ] && exit 1
+
+exit 0
@@ -0,0 +1,45 @@
+package jitcache1_pack is
+    type int_vec is array (natural range <>) of integer;
+    constant table : int_vec := (1, 5, 7, 11, 13, 17, 19, 23);
+    function lookup (x : natural) return integer;
+end package;
+
+package body jitcache1_pack is
+    function lookup (x : natural) return integer is
+    begin
+        return table(x mod table'length);
+    end function;
+end package body;
+
+-------------------------------------------------------------------------------
+
+use work.jitcache1_pack.all;
+
+entity jitcache1 is
+end entity;
+
+architecture test of jitcache1 is
+
+    function sum (n : natural) return integer is
+        constant str : string := "hello";
+        variable s   : integer := 0;
+    begin
+        for i in 0 to n - 1 loop
+            s := s + lookup(i) + character'pos(str(1 + i mod str'length));
+        end loop;
+        return s;
+    end function;
+
+begin
+
+    process is
+        variable total : integer := 0;
+    begin
+        for i in 1 to 500 loop
+            total := total + sum(i mod 17);
+        end loop;
+        assert total = 460805;
+        wait;
+    end process;
+
+end architecture;
@@ -0,0 +1,64 @@
+set -xe
+
+pwd
+which nvc
+
+# The object cache requires the LLVM backend
+nvc --version | grep -q LLVM || exit 0
+
+cat >jitcache2.vhd <<EOF2
+package jitcache2_pack is
+  type int_vec is array (natural range <>) of integer;
+  constant table : int_vec := (1, 5, 7, 11, 13, 17, 19, 23);
+  function lookup (x : natural) return integer;
+end package;
+
+package body jitcache2_pack is
+  function lookup (x : natural) return integer is
+  begin
+    return table(x mod table'length);
+  end function;
+end package body;
+
+use work.jitcache2_pack.all;
+
+entity jitcache2 is
+end entity;
+
+architecture test of jitcache2 is
+  signal s : integer := 0;
+begin
+  process is
+    variable total : integer := 0;
+  begin
+    for i in 1 to 200 loop
+      total := total + lookup(i) * i;
+      s <= total;
+      wait for 1 ns;
+    end loop;
+    report "total = " & integer'image(total) & " s = " & integer'image(s);
+    wait;
+  end process;
+end architecture;
+EOF2
+
+nvc -a jitcache2.vhd -e jitcache2
+
+# Compile everything synchronously so the cache contents do not
+# depend on timing
+export NVC_JIT_THRESHOLD=1
+export NVC_JIT_ASYNC=0
+
+rm -rf work/_NVC_JIT
+nvc -r --jit-cache jitcache2 2>&1 | tee out1
+[ -n "$(ls work/_NVC_JIT)" ] || exit 1
+
+NVC_JIT_LOG=1 nvc -r --jit-cache jitcache2 2>&1 | tee out2
+grep "loaded from cache" out2
+
+grep "total = " out1 > report1
+grep "total = " out2 > report2
+diff report1 report2
+grep "total = 242200 s = 242200" report1
+
+exit 0
@@ -0,0 +1,66 @@
+set -xe
+
+pwd
+which nvc
+
+cat >top.vhd <<EOF2
+use work.pack2.all;
+entity top is
+end entity;
+architecture test of top is
+begin
+  process is
+  begin
+    report "value is " & integer'image(value);
+    wait;
+  end process;
+end architecture;
+EOF2
+
+cat >pack2.vhd <<EOF2
+use work.pack1.all;
+package pack2 is
+  constant value : integer := base * 2;
+end package;
+EOF2
+
+cat >pack1.vhd <<EOF2
+package pack1 is
+  constant base : integer := 21;
+end package;
+EOF2
+
+cat >other.vhd <<EOF2
+entity other is
+end entity;
+architecture test of other is
+begin
+end architecture;
+EOF2
+
+# Each file depends on the one after it
+nvc -a --jobs=4 top.vhd pack2.vhd other.vhd pack1.vhd
+
+nvc -e top -r 2>&1 | tee out
+grep "value is 42" out
+
+cat >bad.vhd <<EOF2
+entity bad is
+end entity;
+architecture test of bad is
+begin
+  x <= 1;
+end architecture;
+EOF2
+
+cat >good.vhd <<EOF2
+entity good is
+end entity;
+EOF2
+
+# Files without errors are still saved when another file fails
+nvc -a --jobs=2 bad.vhd good.vhd && exit 1
+[ -f work/WORK.GOOD ] || exit 1
+[ -f work/WORK.BAD ] && exit 1
+
+exit 0
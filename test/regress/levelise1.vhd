@@ -0,0 +1,109 @@
+library ieee;
+use ieee.std_logic_1164.all;
+
+entity levelise1 is
+end entity;
+
+architecture test of levelise1 is
+    signal a, b, c, d : bit := '0';
+    signal x, y       : std_logic_vector(7 downto 0);
+    signal z          : std_logic_vector(7 downto 0);
+    signal clk, q     : bit := '0';
+    signal sclk, rst_n : std_logic := '0';
+    signal s1, s2     : std_logic;
+begin
+
+    -- Chain of combinational processes listed in reverse order
+    d <= not c;
+    c <= not b;
+
+    p1: process (a) is
+    begin
+        b <= not a;
+    end process;
+
+    -- Two combinational sources for a resolved signal
+    z <= x;
+    z <= y;
+
+    -- Not combinational as d is not in the sensitivity list
+    reg: process (clk) is
+    begin
+        if clk'event and clk = '1' then
+            q <= d;
+        end if;
+    end process;
+
+    -- Reset synchroniser: the first stage only assigns constants but
+    -- is clocked so must not see the second stage update early
+    sync1: process (sclk, rst_n) is
+    begin
+        if rst_n = '0' then
+            s1 <= '0';
+        elsif rising_edge(sclk) then
+            s1 <= '1';
+        end if;
+    end process;
+
+    sync2: process (sclk, rst_n) is
+    begin
+        if rst_n = '0' then
+            s2 <= '0';
+        elsif rising_edge(sclk) then
+            s2 <= s1;
+        end if;
+    end process;
+
+    check: process is
+    begin
+        wait for 0 ns;
+        assert d = '1';
+
+        a <= '1';
+        wait on a;
+        -- The whole chain settles in the same delta cycle
+        assert b = '0';
+        assert c = '1';
+        assert d = '0';
+        assert q = '0';
+
+        x <= (others => 'Z');
+        y <= X"5a";
+        wait on y;
+        assert z = X"5a";
+
+        x <= X"ff";
+        wait on x;
+        assert z = "X1X11X1X" report to_string(z);
+
+        a <= '0';
+        wait on a;
+        assert d = '1';
+
+        clk <= '1';
+        wait on clk;
+        assert q = '0';                 -- Register updates a delta later
+        wait on q;
+        assert q = '1';
+
+        rst_n <= '1';
+        wait for 1 ns;
+        assert s1 = '0';
+        assert s2 = '0';
+
+        sclk <= '1';
+        wait for 1 ns;
+        assert s1 = '1';
+        assert s2 = '0' report "second stage sampled new value";
+
+        sclk <= '0';
+        wait for 1 ns;
+        sclk <= '1';
+        wait for 1 ns;
+        assert s1 = '1';
+        assert s2 = '1';
+
+        wait;
+    end process;
+
+end architecture;
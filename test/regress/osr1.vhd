@@ -0,0 +1,51 @@
+entity osr1 is
+end entity;
+
+architecture test of osr1 is
+
+    -- Called once and loops long enough to be compiled mid-loop
+    function collatz_steps (n : natural) return natural is
+        variable total : natural := 0;
+        variable x     : natural;
+    begin
+        for i in 1 to n loop
+            x := i;
+            while x /= 1 loop
+                if x mod 2 = 0 then
+                    x := x / 2;
+                else
+                    x := 3 * x + 1;
+                end if;
+                total := total + 1;
+            end loop;
+        end loop;
+        return total;
+    end function;
+
+    function case_sum (n : natural) return natural is
+        variable sum : natural := 0;
+    begin
+        for i in 0 to n - 1 loop
+            case i mod 4 is
+                when 0 => sum := (sum + i) mod 1000003;
+                when 1 => sum := (sum + 1000002) mod 1000003;
+                when 2 => sum := (sum + 3) mod 1000003;
+                when others => null;
+            end case;
+        end loop;
+        return sum;
+    end function;
+
+begin
+
+    process
+        variable n : natural;
+    begin
+        n := 20000;
+        wait for 1 ns;                  -- Prevent constant folding
+        assert collatz_steps(n) = 1834634;
+        assert case_sum(n * 10) = 985003;
+        wait;
+    end process;
+
+end architecture;
@@ -0,0 +1,62 @@
+set -xe
+
+pwd
+which nvc
+
+# Native code can only be saved with the LLVM backend
+nvc --version | grep -q LLVM || exit 0
+
+cat >pack.vhd <<EOF2
+package prepack is
+  function triangle (n : natural) return natural;
+end package;
+
+package body prepack is
+  function triangle (n : natural) return natural is
+    variable sum : natural := 0;
+  begin
+    for i in 1 to n loop
+      sum := sum + i;
+    end loop;
+    return sum;
+  end function;
+end package body;
+EOF2
+
+cat >top.vhd <<EOF2
+library prelib;
+use prelib.prepack.all;
+
+entity precompile1 is
+end entity;
+
+architecture test of precompile1 is
+begin
+  process is
+    variable total : natural := 0;
+  begin
+    for i in 1 to 100 loop
+      total := total + triangle(i);
+    end loop;
+    report "total = " & integer'image(total);
+    wait;
+  end process;
+end architecture;
+EOF2
+
+rm -rf prelib
+nvc --work=prelib -a pack.vhd --precompile
+[ -n "$(ls prelib/_NVC_JIT)" ] || exit 1
+
+nvc -L . -a top.vhd -e precompile1
+
+# Compile synchronously on the first call so any function that was not
+# loaded from the library would be logged as compiled here
+NVC_JIT_LOG=1 NVC_JIT_THRESHOLD=1 NVC_JIT_ASYNC=0 \
+  nvc -L . -r precompile1 2>&1 | tee out
+
+grep "PRELIB.PREPACK.TRIANGLE.* loaded from cache" out
+grep "PRELIB.PREPACK.TRIANGLE.* at 0x" out && exit 1
+grep "total = 171700" out
+
+exit 0
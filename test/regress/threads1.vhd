@@ -0,0 +1,49 @@
+entity threads1 is
+end entity;
+
+architecture test of threads1 is
+    constant N : natural := 64;
+
+    type int_vector is array (natural range <>) of integer;
+
+    signal clk    : bit := '0';
+    signal inputs : int_vector(1 to N) := (others => 0);
+    signal sums   : int_vector(1 to N) := (others => 0);
+begin
+
+    clk <= not clk after 5 ns when now < 500 ns;
+
+    g: for i in 1 to N generate
+
+        stim: process (clk) is
+        begin
+            if clk'event and clk = '1' then
+                inputs(i) <= inputs(i) + i;
+            end if;
+        end process;
+
+        accum: process (inputs(i)) is
+            variable total : integer := 0;
+        begin
+            total := total + inputs(i);
+            sums(i) <= total;
+        end process;
+
+    end generate;
+
+    check: process is
+        variable expect : integer;
+    begin
+        wait for 1 us;
+        for i in 1 to N loop
+            -- inputs(i) takes values i, 2i, ... 50i
+            expect := i * 50 * 51 / 2;
+            assert sums(i) = expect
+                report "sums(" & integer'image(i) & ") = "
+                & integer'image(sums(i)) & " expected "
+                & integer'image(expect);
+        end loop;
+        wait;
+    end process;
+
+end architecture;
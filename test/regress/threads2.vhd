@@ -0,0 +1,95 @@
+package threads2_pack is
+    type int_vector is array (natural range <>) of integer;
+end package;
+
+-------------------------------------------------------------------------------
+
+use work.threads2_pack.all;
+
+entity threads2_sub is
+    generic ( N : natural );
+    port ( p : in bit_vector(0 to N - 1);
+           q : out int_vector(0 to N - 1) );
+end entity;
+
+architecture test of threads2_sub is
+begin
+
+    g: for k in 0 to N - 1 generate
+
+        -- The index is not static so the port nexus is split when the
+        -- process first waits
+        watch: process is
+            variable idx   : natural := k;
+            variable count : integer := 0;
+        begin
+            q(k) <= count;
+            wait on p(idx);
+            count := count + 1;
+        end process;
+
+    end generate;
+
+end architecture;
+
+-------------------------------------------------------------------------------
+
+use work.threads2_pack.all;
+
+entity threads2 is
+end entity;
+
+architecture test of threads2 is
+    constant N : natural := 32;
+
+    signal clk : bit := '0';
+    signal odd : boolean := false;
+    signal v   : bit_vector(0 to N - 1);
+    signal q1  : int_vector(0 to N - 1);
+    signal q2  : int_vector(0 to N / 2 - 1);
+begin
+
+    clk <= not clk after 5 ns when now < 100 ns;
+    odd <= true after 30 ns;
+
+    g: for i in 0 to N - 1 generate
+
+        stim: process (clk) is
+        begin
+            if clk'event and clk = '1' and (i mod 3 = 0 or odd) then
+                v(i) <= not v(i);
+            end if;
+        end process;
+
+    end generate;
+
+    u1: entity work.threads2_sub
+        generic map ( N )
+        port map ( v, q1 );
+
+    u2: entity work.threads2_sub
+        generic map ( N / 2 )
+        port map ( v(N / 2 to N - 1), q2 );
+
+    check: process is
+        variable expect : integer;
+    begin
+        wait for 200 ns;
+        for i in 0 to N - 1 loop
+            -- Rising edges at 5, 15, ..., 95 ns
+            expect := 7 + 3 * boolean'pos(i mod 3 = 0);
+            assert q1(i) = expect
+                report "q1(" & integer'image(i) & ") = "
+                & integer'image(q1(i)) & " expected "
+                & integer'image(expect);
+            if i >= N / 2 then
+                assert q2(i - N / 2) = expect
+                    report "q2(" & integer'image(i - N / 2) & ") = "
+                    & integer'image(q2(i - N / 2)) & " expected "
+                    & integer'image(expect);
+            end if;
+        end loop;
+        wait;
+    end process;
+
+end architecture;
@@ -0,0 +1,27 @@
+set -xe
+
+pwd
+which nvc
+which fstdump
+
+nvc -a $TESTDIR/regress/wave14.vhd -e wave14 \
+    -r --stop-time=12ns -w --wave-history=140 2>err || true
+
+grep "x is ten" err
+
+fstdump wave14.fst > wave14.dump
+cat wave14.dump
+
+# Only the last four changes before the error at 10ns fit in the buffer
+grep "^#7000000 " wave14.dump && exit 1
+grep "^#8000000 wave14.x\[7:0\] 00001000" wave14.dump
+grep "^#10000000 wave14.x\[7:0\] 00001010" wave14.dump
+
+# Signals have their value at the start of the window even if they
+# changed earlier or later within it
+grep "^#8000000 wave14.y 1" wave14.dump
+grep "^#8000000 wave14.z 1" wave14.dump
+grep "^#9000000 wave14.z 0" wave14.dump
+
+# The changes after the error are written when the simulation ends
+grep "^#12000000 wave14.x\[7:0\] 00001100" wave14.dump
@@ -0,0 +1,28 @@
+entity wave14 is
+end entity;
+
+library ieee;
+use ieee.numeric_bit.all;
+
+architecture test of wave14 is
+    signal x    : bit_vector(7 downto 0);
+    signal y, z : bit;
+begin
+
+    count: process is
+    begin
+        wait for 1 ns;
+        x <= bit_vector(unsigned(x) + 1);
+    end process;
+
+    y <= '1' after 2 ns;
+    z <= '1' after 5 ns, '0' after 9 ns;
+
+    check: process is
+    begin
+        wait until x = X"0a";
+        report "x is ten" severity error;
+        wait;
+    end process;
+
+end architecture;
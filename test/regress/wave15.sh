@@ -0,0 +1,45 @@
+set -xe
+
+pwd
+which nvc
+which fstdump
+
+cat >wave15.vhd <<EOF2
+library ieee;
+use ieee.numeric_bit.all;
+
+entity wave15 is
+end entity;
+
+architecture test of wave15 is
+  signal x : bit_vector(7 downto 0);
+  signal y : bit;
+begin
+  process is
+  begin
+    wait for 1 ns;
+    x <= bit_vector(unsigned(x) + 1);
+  end process;
+
+  y <= '1' after 2 ns;
+end architecture;
+EOF2
+
+nvc -a wave15.vhd -e wave15 -r --stop-time=12ns -w \
+    --wave-start=5ns --wave-stop=8ns
+
+fstdump wave15.fst > wave15.dump
+cat wave15.dump
+
+# Nothing is recorded outside the window
+grep "^#[0-4]000000 " wave15.dump && exit 1
+grep "^#\(9\|1[0-9]\)000000 " wave15.dump && exit 1
+
+# Every signal has its current value when the window opens
+grep "^#5000000 wave15.y 1" wave15.dump
+grep "^#5000000 wave15.x\[7:0\] " wave15.dump
+grep "^#7000000 wave15.x\[7:0\] 00000111" wave15.dump
+
+# The stop time must be after the start time
+nvc -r --wave-start=5ns --wave-stop=2ns -w wave15 2>err && exit 1
+grep "must be after" err
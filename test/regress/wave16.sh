@@ -0,0 +1,45 @@
+set -xe
+
+pwd
+which nvc
+which fstdump
+
+cat >wave16.vhd <<EOF2
+library ieee;
+use ieee.numeric_bit.all;
+
+entity wave16 is
+end entity;
+
+architecture test of wave16 is
+  type vec_array is array (natural range <>) of bit_vector(31 downto 0);
+  signal v : vec_array(0 to 15);
+  signal n : integer := 0;
+  signal r : real := 0.0;
+begin
+  g: for i in v'range generate
+    process is
+      variable s : unsigned(31 downto 0) := to_unsigned(i + 1, 32);
+    begin
+      wait for (i + 1) * 1 ns;
+      s := s(30 downto 0) & (s(31) xor s(21) xor s(1) xor s(0));
+      v(i) <= bit_vector(s);
+    end process;
+  end generate;
+
+  n <= n + 1 after 1 ns when n < 50000;
+  r <= r + 0.5 after 3 ns when n < 50000;
+end architecture;
+EOF2
+
+nvc -a wave16.vhd -e wave16
+
+# The parallel FST writer must produce the same value changes as the
+# serial writer
+nvc -r --stop-time=60us --wave=serial.fst --dump-arrays wave16
+nvc -r --stop-time=60us --wave=async.fst --wave-async --dump-arrays wave16
+
+fstdump serial.fst > serial.dump
+fstdump async.fst > async.dump
+test -s serial.dump
+diff -u serial.dump async.dump
@@ -108,6 +108,9 @@
 #define F_ARRAYS  (1 << 26)
 #define F_SEED    (1 << 27)
 #define F_PERFILE (1 << 28)
+#define F_THREADS (1 << 29)
+#define F_CACHE   (1 << 30)
+#define F_AOT     (1u << 31)
 
 typedef struct test test_t;
 typedef struct param param_t;
@@ -128,7 +131,7 @@ struct param {
 struct test {
    char      *name;
    test_t    *next;
-   int        flags;
+   unsigned   flags;
    char      *stop;
    param_t   *params;
    char      *relax;
@@ -141,6 +144,9 @@ struct test {
    char      *plusarg;
    unsigned   arrays;
    int        seed;
+   unsigned   threads;
+   bool       levelise;
+   bool       fuse;
    double     duration;
 };
 
@@ -466,6 +472,22 @@ static bool parse_test_list(void)
                goto out_close;
             }
          }
+         else if (strcmp(opt, "jit-cache") == 0)
+            test->flags |= F_CACHE;
+         else if (strcmp(opt, "aot") == 0)
+            test->flags |= F_AOT;
+         else if (strcmp(opt, "levelise") == 0)
+            test->levelise = true;
+         else if (strcmp(opt, "fuse") == 0)
+            test->fuse = true;
+         else if (strncmp(opt, "threads=", 8) == 0) {
+            test->flags |= F_THREADS;
+            if (sscanf(opt + 8, "%u", &(test->threads)) != 1) {
+               fprintf(stderr, "Error on testlist line %d: invalid "
+                               "threads argument %s\n", lineno, opt);
+               goto out_close;
+            }
+         }
          else if (strncmp(opt, "O", 1) == 0) {
             if (sscanf(opt + 1, "%u", &(test->olevel)) != 1) {
                fprintf(stderr, "Error on testlist line %d: invalid "
@@ -969,6 +991,9 @@ static bool run_test(test_t *test)
       if (test->flags & F_NOCOLL)
          push_arg(&args, "--no-collapse");
 
+      if (test->flags & F_AOT)
+         push_arg(&args, "--aot");
+
       if (test->flags & F_COVER) {
          if (test->cover)
             push_arg(&args, "--cover=%s", test->cover);
@@ -1035,6 +1060,18 @@ static bool run_test(test_t *test)
       if (test->flags & F_SHUFFLE)
          push_arg(&args, "--shuffle");
 
+      if (test->flags & F_THREADS)
+         push_arg(&args, "--threads=%u", test->threads);
+
+      if (test->flags & F_CACHE)
+         push_arg(&args, "--jit-cache");
+
+      if (test->levelise)
+         push_arg(&args, "--levelise");
+
+      if (test->fuse)
+         push_arg(&args, "--fuse-processes");
+
       if (test->plusarg != NULL)
          push_arg(&args, "+%s", test->plusarg);
 
@@ -0,0 +1,20 @@
+entity deposit1 is
+end entity;
+
+architecture test of deposit1 is
+    signal x : integer;
+    signal z : bit_vector(1 to 3);
+begin
+
+    tb: process is
+    begin
+        wait for 1 ns;
+        assert x = integer'left;
+        assert z = "000";
+        wait for 1 ns;
+        assert x = 5;
+        assert z = "101";
+        wait;
+    end process;
+
+end architecture;
@@ -19,6 +19,7 @@
 #include "common.h"
 #include "lib.h"
 #include "object.h"
+#include "option.h"
 #include "tree.h"
 #include "type.h"
 #include "util.h"
@@ -325,6 +326,72 @@ START_TEST(test_lib_save)
 }
 END_TEST
 
+START_TEST(test_lib_compress)
+{
+   static const struct {
+      const char *option;
+      const char *unit;
+      char        format;
+   } codecs[] = {
+      { "none",   "TEST_LIB.NONE",   '-' },
+      { "fastlz", "TEST_LIB.FASTLZ", 'F' },
+      { "lz4",    "TEST_LIB.LZ4",    'L' },
+      { "zstd",   "TEST_LIB.ZSTD",   'Z' },
+      { NULL,     "TEST_LIB.UNITS",  'L' },   // Default for units
+   };
+
+   for (int i = 0; i < ARRAY_LEN(codecs); i++) {
+      opt_set_str(OPT_COMPRESSION, codecs[i].option);
+
+      make_new_arena();
+
+      tree_t ent = tree_new(T_ENTITY);
+      tree_set_ident(ent, ident_new(codecs[i].unit));
+
+      for (int j = 0; j < 100; j++) {
+         tree_t p = tree_new(T_PORT_DECL);
+         tree_set_ident(p, ident_sprintf("p%d", j));
+         tree_set_subkind(p, PORT_IN);
+         tree_set_type(p, my_int_type());
+         tree_add_port(ent, p);
+      }
+
+      lib_put(work, ent);
+      lib_save(work);
+
+      FILE *f = lib_fopen(work, codecs[i].unit, "rb");
+      fail_if(f == NULL);
+
+      char header[5];
+      ck_assert_int_eq(fread(header, 1, sizeof(header), f), sizeof(header));
+      ck_assert_int_eq(header[4], codecs[i].format);
+
+      fclose(f);
+   }
+
+   opt_set_str(OPT_COMPRESSION, NULL);
+
+   lib_free(work);
+
+   lib_add_search_path(tmp);
+   work = lib_find(ident_new("test_lib"));
+   fail_if(work == NULL);
+
+   for (int i = 0; i < ARRAY_LEN(codecs); i++) {
+      tree_t ent = lib_get(work, ident_new(codecs[i].unit));
+      fail_if(ent == NULL);
+      fail_unless(tree_kind(ent) == T_ENTITY);
+      ck_assert_int_eq(tree_ports(ent), 100);
+
+      for (int j = 0; j < 100; j++) {
+         tree_t p = tree_port(ent, j);
+         fail_unless(tree_ident(p) == ident_sprintf("p%d", j));
+         fail_unless(type_kind(tree_type(p)) == T_INTEGER);
+      }
+   }
+}
+END_TEST
+
 Suite *get_lib_tests(void)
 {
    Suite *s = suite_create("lib");
@@ -334,6 +401,7 @@ Suite *get_lib_tests(void)
    tcase_add_test(tc_core, test_lib_new);
    tcase_add_test(tc_core, test_lib_fopen);
    tcase_add_test(tc_core, test_lib_save);
+   tcase_add_test(tc_core, test_lib_compress);
    suite_add_tcase(s, tc_core);
 
    return s;
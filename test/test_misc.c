@@ -24,6 +24,7 @@
 #include "printf.h"
 #include "rt/copy.h"
 #include "rt/heap.h"
+#include "rt/wheel.h"
 #include "thread.h"
 #include "util.h"
 #include "stdint.h"
@@ -296,6 +297,12 @@ static int magnitude_compar(const void *a, const void *b)
    return *(const uintptr_t*)a - *(const uintptr_t*)b;
 }
 
+static int key_compar(const void *a, const void *b)
+{
+   const uintptr_t ka = *(const uintptr_t*)a, kb = *(const uintptr_t*)b;
+   return ka < kb ? -1 : ka > kb;
+}
+
 static void walk_fn(uint64_t key, void *user, void *context)
 {
    uint64_t *last = context;
@@ -407,6 +414,135 @@ START_TEST(test_heap_delete)
 }
 END_TEST
 
+START_TEST(test_wheel_basic)
+{
+   wheel_t *w = wheel_new();
+
+   wheel_insert(w, 5, (void*)5);
+   wheel_insert(w, 2, (void*)2);
+   wheel_insert(w, 62, (void*)62);
+   wheel_insert(w, UINT64_C(1) << 40, (void*)1);
+
+   ck_assert_int_eq(wheel_size(w), 4);
+   ck_assert_int_eq(wheel_min_key(w), 2);
+
+   ck_assert_ptr_eq(wheel_extract_min(w), (void*)2);
+   ck_assert_ptr_eq(wheel_extract_min(w), (void*)5);
+
+   wheel_insert(w, 6, (void*)6);
+   wheel_insert(w, 1, (void*)1);   // Behind the last extracted key
+
+   ck_assert_int_eq(wheel_min_key(w), 1);
+   ck_assert_ptr_eq(wheel_extract_min(w), (void*)1);
+   ck_assert_ptr_eq(wheel_extract_min(w), (void*)6);
+   ck_assert_ptr_eq(wheel_extract_min(w), (void*)62);
+   ck_assert_int_eq(wheel_min_key(w), UINT64_C(1) << 40);
+   ck_assert_ptr_eq(wheel_extract_min(w), (void*)1);
+
+   ck_assert_int_eq(wheel_size(w), 0);
+
+   wheel_free(w);
+}
+END_TEST
+
+START_TEST(test_wheel_rand)
+{
+   wheel_t *w = wheel_new();
+
+   static const int N = 1024;
+   uintptr_t keys[N];
+
+   for (int i = 0; i < N; i++) {
+      keys[i] = rand() >> (rand() % 24);
+      wheel_insert(w, keys[i], (void*)keys[i]);
+   }
+
+   qsort(keys, N, sizeof(uintptr_t), magnitude_compar);
+
+   for (int i = 0; i < N; i++) {
+      ck_assert_int_eq(wheel_min_key(w), keys[i]);
+      ck_assert_ptr_eq(wheel_extract_min(w), (void*)keys[i]);
+   }
+
+   wheel_free(w);
+}
+END_TEST
+
+START_TEST(test_wheel_sim)
+{
+   // Interleave inserts and extracts the way the simulation kernel does
+   wheel_t *w = wheel_new();
+   heap_t *h = heap_new(128);
+
+   uint64_t now = 0;
+   for (int i = 0; i < 10000; i++) {
+      const int ninsert = rand() % 4;
+      for (int j = 0; j < ninsert; j++) {
+         uint64_t delay;
+         switch (rand() % 4) {
+         case 0: delay = rand() % 16; break;
+         case 1: delay = rand() % 100000; break;
+         case 2: delay = (uint64_t)rand() << (rand() % 24); break;
+         default: delay = 1000000; break;
+         }
+
+         wheel_insert(w, now + delay, (void*)(now + delay));
+         heap_insert(h, now + delay, (void*)(now + delay));
+      }
+
+      if (heap_size(h) == 0)
+         continue;
+
+      ck_assert_int_eq(wheel_size(w), heap_size(h));
+      ck_assert_int_eq(wheel_min_key(w), heap_min_key(h));
+
+      now = heap_min_key(h);
+      while (heap_size(h) > 0 && heap_min_key(h) == now) {
+         ck_assert_ptr_eq(wheel_extract_min(w), heap_extract_min(h));
+         if (rand() % 8 == 0)
+            break;
+      }
+   }
+
+   ck_assert_int_eq(wheel_size(w), heap_size(h));
+
+   wheel_free(w);
+   heap_free(h);
+}
+END_TEST
+
+START_TEST(test_wheel_delete)
+{
+   wheel_t *w = wheel_new();
+
+   static const int N = 1024;
+   uintptr_t keys[N];
+
+   for (int i = 0; i < N; i++) {
+      keys[i] = 1 + ((uint64_t)rand() << (rand() % 16));
+      wheel_insert(w, keys[i], (void*)keys[i]);
+   }
+
+   int deleted = 0;
+   for (int i = 0; i < N; i++) {
+      if (rand() % 20 == 0) {
+         ck_assert(wheel_delete(w, heap_delete_cb, (void*)keys[i]));
+         keys[i] = 0;
+         deleted++;
+      }
+   }
+
+   ck_assert_int_eq(wheel_size(w), N - deleted);
+
+   qsort(keys, N, sizeof(uintptr_t), key_compar);
+
+   for (int i = deleted; i < N; i++)
+      ck_assert_ptr_eq(wheel_extract_min(w), (void*)keys[i]);
+
+   wheel_free(w);
+}
+END_TEST
+
 START_TEST(test_strip)
 {
    LOCAL_TEXT_BUF tb = tb_new();
@@ -963,6 +1099,13 @@ Suite *get_misc_tests(void)
    tcase_add_test(tc_heap, test_heap_delete);
    suite_add_tcase(s, tc_heap);
 
+   TCase *tc_wheel = tcase_create("wheel");
+   tcase_add_test(tc_wheel, test_wheel_basic);
+   tcase_add_test(tc_wheel, test_wheel_rand);
+   tcase_add_test(tc_wheel, test_wheel_sim);
+   tcase_add_test(tc_wheel, test_wheel_delete);
+   suite_add_tcase(s, tc_wheel);
+
    TCase *tc_util = tcase_create("util");
    tcase_add_test(tc_util, test_strip);
    suite_add_tcase(s, tc_util);
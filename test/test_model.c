@@ -249,18 +249,19 @@ START_TEST(test_pending1)
    fail_if(sx == NULL);
    fail_unless(sx->n_nexus == 1);
 
-   ck_assert_ptr_null(sx->nexus.pending);
+   rt_nexus_t *nx = &(sx->nexus);
+   ck_assert_ptr_null(nexus_pending(m, nx));
 
    model_step(m);
 
-   ck_assert_int_eq(pointer_tag(sx->nexus.pending), 1);
-   ck_assert_ptr_eq(untag_pointer(sx->nexus.pending, rt_wakeable_t),
+   ck_assert_int_eq(pointer_tag(nexus_pending(m, nx)), 1);
+   ck_assert_ptr_eq(untag_pointer(nexus_pending(m, nx), rt_wakeable_t),
                     &(pwakeup->wakeable));
 
    model_step(m);
 
-   ck_assert_int_eq(pointer_tag(sx->nexus.pending), 1);
-   ck_assert_ptr_eq(untag_pointer(sx->nexus.pending, rt_wakeable_t),
+   ck_assert_int_eq(pointer_tag(nexus_pending(m, nx)), 1);
+   ck_assert_ptr_eq(untag_pointer(nexus_pending(m, nx), rt_wakeable_t),
                     &(pwakeup->wakeable));
 
    model_free(m);
@@ -53,6 +53,7 @@ static jit_t *get_native_jit(void)
 {
    opt_set_int(OPT_JIT_THRESHOLD, 1);
    opt_set_int(OPT_JIT_ASYNC, 0);
+   opt_set_int(OPT_JIT_BASELINE, 1);
 
    jit_t *j = jit_new(NULL, NULL);
    jit_register_native_plugin(j);
@@ -641,6 +642,21 @@ START_TEST(test_shift)
    ck_assert_int_eq(jit_call(j, h2, 8, 1).integer, 4);
    ck_assert_int_eq(jit_call(j, h2, 128, 5).integer, 4);
    ck_assert_int_eq(jit_call(j, h2, 4, 5).integer, 0);
+   ck_assert_int_eq(jit_call(j, h2, -8, 100).integer, -1);
+
+   const char *text3 =
+      "    RECV      R0, #0          \n"
+      "    RECV      R1, #1          \n"
+      "    SHR       R2, R0, R1      \n"
+      "    SEND      #0, R2          \n"
+      "    RET                       \n";
+
+   jit_handle_t h3 = assemble(j, text3, "shift3", "ii");
+   ck_assert_int_eq(jit_call(j, h3, 8, 1).integer, 4);
+   ck_assert_int_eq(jit_call(j, h3, 128, 5).integer, 4);
+   ck_assert_int_eq(jit_call(j, h3, -1, 60).integer, 15);
+   ck_assert_int_eq(jit_call(j, h3, -1, 64).integer, 0);
+   ck_assert_int_eq(jit_call(j, h1, 1, 64).integer, 0);
 
    jit_free(j);
 }
@@ -905,6 +921,21 @@ START_TEST(test_exp)
    ck_assert_int_eq(jit_call(j, h1, 666, 1).integer, 666);
    ck_assert_int_eq(jit_call(j, h1, 99, 0).integer, 1);
 
+   const char *text2 =
+      "    RECV     R0, #0          \n"
+      "    RECV     R1, #1          \n"
+      "    $EXP.O.32 R2, R0, R1     \n"
+      "    CSET     R3              \n"
+      "    SEND     #0, R3          \n"
+      "    RET                      \n";
+
+   jit_handle_t h2 = assemble(j, text2, "exp2", "ii");
+   ck_assert_int_eq(jit_call(j, h2, 3, 12).integer, 0);
+   ck_assert_int_eq(jit_call(j, h2, 2, 30).integer, 0);
+   ck_assert_int_eq(jit_call(j, h2, 2, 31).integer, 1);
+   ck_assert_int_eq(jit_call(j, h2, -2, 31).integer, 0);
+   ck_assert_int_eq(jit_call(j, h2, 10, 10).integer, 1);
+
    jit_free(j);
 }
 END_TEST
@@ -1034,6 +1065,68 @@ START_TEST(test_ccmp)
 }
 END_TEST
 
+START_TEST(test_fccmp)
+{
+   jit_t *j = get_native_jit();
+
+   const char *text1 =
+      "    RECV      R0, #0          \n"
+      "    RECV      R1, #1          \n"
+      "    FCMP.GE   R0, %0.0        \n"
+      "    FCCMP.LT  R0, R1          \n"
+      "    CSET      R2              \n"
+      "    SEND      #0, R2          \n"
+      "    RET                       \n";
+
+   jit_handle_t h1 = assemble(j, text1, "fccmp1", "ff");
+   ck_assert_int_eq(jit_call(j, h1, 0.5, 1.0).integer, 1);
+   ck_assert_int_eq(jit_call(j, h1, -0.5, 1.0).integer, 0);
+   ck_assert_int_eq(jit_call(j, h1, 2.0, 1.0).integer, 0);
+   ck_assert_int_eq(jit_call(j, h1, 0.5, NAN).integer, 0);
+
+   jit_free(j);
+}
+END_TEST
+
+START_TEST(test_sadd)
+{
+   jit_t *j = get_native_jit();
+
+   const char *text1 =
+      "    RECV      R0, #0          \n"
+      "    RECV      R1, #1          \n"
+      "    $SALLOC   R2, #0, #1      \n"
+      "    STORE.8   R0, [R2]        \n"
+      "    $SADD.8   [R2], R1        \n"
+      "    ULOAD.8   R3, [R2]        \n"
+      "    SEND      #0, R3          \n"
+      "    RET                       \n";
+
+   jit_handle_t h1 = assemble(j, text1, "sadd1", "ii");
+   ck_assert_int_eq(jit_call(j, h1, 1, 2).integer, 3);
+   ck_assert_int_eq(jit_call(j, h1, 250, 5).integer, 255);
+   ck_assert_int_eq(jit_call(j, h1, 250, 6).integer, 255);
+   ck_assert_int_eq(jit_call(j, h1, 255, 1).integer, 255);
+
+   const char *text2 =
+      "    RECV      R0, #0          \n"
+      "    RECV      R1, #1          \n"
+      "    $SALLOC   R2, #0, #4      \n"
+      "    STORE.32  R0, [R2]        \n"
+      "    $SADD.32  [R2], R1        \n"
+      "    ULOAD.32  R3, [R2]        \n"
+      "    SEND      #0, R3          \n"
+      "    RET                       \n";
+
+   jit_handle_t h2 = assemble(j, text2, "sadd2", "ii");
+   ck_assert_int_eq(jit_call(j, h2, 1, 2).integer, 3);
+   ck_assert_int_eq(jit_call(j, h2, -2, 1).integer, UINT32_MAX);
+   ck_assert_int_eq(jit_call(j, h2, -2, 5).integer, UINT32_MAX);
+
+   jit_free(j);
+}
+END_TEST
+
 START_TEST(test_fcmp_nan)
 {
    jit_t *j = get_native_jit();
@@ -1348,6 +1441,8 @@ Suite *get_native_tests(void)
    tcase_add_test(tc, test_memset);
    tcase_add_test(tc, test_move);
    tcase_add_test(tc, test_sub);
+   tcase_add_test(tc, test_fccmp);
+   tcase_add_test(tc, test_sadd);
    suite_add_tcase(s, tc);
 
    return s;
@@ -16,6 +16,7 @@
 //
 
 #include "test_util.h"
+#include "fstapi.h"
 #include "ident.h"
 #include "jit/jit.h"
 #include "phase.h"
@@ -258,6 +259,134 @@ START_TEST(test_force1)
 }
 END_TEST
 
+START_TEST(test_deposit1)
+{
+   const error_t expect[] = {
+      { LINE_INVALID, "expected 3 elements for signal /z but have 2" },
+      { -1, NULL }
+   };
+   expect_errors(expect);
+
+   input_from_file(TESTDIR "/shell/deposit1.vhd");
+
+   mir_context_t *mc = get_mir();
+   unit_registry_t *ur = get_registry();
+   jit_t *j = jit_new(ur, mc);
+
+   tree_t arch = parse_check_and_simplify(T_ENTITY, T_ARCH);
+
+   rt_model_t *m = model_new(j, NULL);
+
+   tree_t top = elab(tree_to_object(arch), j, ur, mc, NULL, NULL, m);
+   fail_if(top == NULL);
+
+   tcl_shell_t *sh = shell_new(top, j, m);
+   shell_reset(sh);
+
+   const char *result = NULL;
+
+   shell_eval(sh, "run 1 ns", &result);
+   ck_assert_str_eq(result, "");
+
+   shell_eval(sh, "deposit /x 5", &result);
+   ck_assert_str_eq(result, "");
+
+   shell_eval(sh, "deposit /z \"101\"", &result);
+   ck_assert_str_eq(result, "");
+
+   fail_if(shell_eval(sh, "deposit /z \"11\"", &result));
+
+   shell_eval(sh, "run", &result);
+   ck_assert_str_eq(result, "");
+
+   shell_eval(sh, "wait", &result);
+   ck_assert_str_eq(result, "0");
+
+   shell_free(sh);
+   model_free(m);
+   jit_free(j);
+
+   check_expected_errors();
+}
+END_TEST
+
+static void wave1_change_cb(void *user, uint64_t time, fstHandle facidx,
+                            const unsigned char *value)
+{
+   uint64_t *times = user;
+   ck_assert_int_lt(time, 3000000);
+   times[time / 1000000]++;
+}
+
+START_TEST(test_wave1)
+{
+   const error_t expect[] = {
+      { LINE_INVALID, "waveform file is already open" },
+      { LINE_INVALID, "syntax error, enter help wave for usage" },
+      { -1, NULL }
+   };
+   expect_errors(expect);
+
+   input_from_file(TESTDIR "/shell/wave1.vhd");
+
+   mir_context_t *mc = get_mir();
+   unit_registry_t *ur = get_registry();
+   jit_t *j = jit_new(ur, mc);
+
+   tree_t arch = parse_check_and_simplify(T_ENTITY, T_ARCH, T_ENTITY, T_ARCH);
+
+   rt_model_t *m = model_new(j, NULL);
+
+   tree_t top = elab(tree_to_object(arch), j, ur, mc, NULL, NULL, m);
+   fail_if(top == NULL);
+
+   tcl_shell_t *sh = shell_new(top, j, m);
+   shell_reset(sh);
+
+   const char *result = NULL;
+
+   shell_eval(sh, "wave off", &result);
+   ck_assert_str_eq(result, "");
+
+   shell_eval(sh, "wave on shell_wave1.fst", &result);
+   ck_assert_str_eq(result, "");
+
+   shell_eval(sh, "wave off", &result);
+   ck_assert_str_eq(result, "");
+
+   shell_eval(sh, "run", &result);
+   ck_assert_str_eq(result, "");
+
+   shell_eval(sh, "wave on", &result);
+   ck_assert_str_eq(result, "");
+
+   fail_if(shell_eval(sh, "wave on other.fst", &result));
+   fail_if(shell_eval(sh, "wave", &result));
+
+   shell_free(sh);   // Closes the FST file
+   model_free(m);
+   jit_free(j);
+
+   void *ctx = fstReaderOpen("shell_wave1.fst");
+   fail_if(ctx == NULL);
+
+   // Only the values when dumping was switched on at 0 and 2 ns are
+   // recorded and not the changes at 1 ns while it was off
+   uint64_t times[3] = {};
+   fstReaderSetFacProcessMaskAll(ctx);
+   fstReaderIterBlocks(ctx, wave1_change_cb, times, NULL);
+   fstReaderClose(ctx);
+
+   ck_assert_int_gt(times[0], 0);
+   ck_assert_int_eq(times[1], 0);
+   ck_assert_int_gt(times[2], 0);
+
+   remove("shell_wave1.fst");
+
+   check_expected_errors();
+}
+END_TEST
+
 static void echo_stdout_handler(const char *buf, size_t nchars, void *ctx)
 {
    int *state = ctx;
@@ -351,6 +480,8 @@ Suite *get_shell_tests(void)
    tcase_add_exit_test(tc, test_exit, 5);
    tcase_add_test(tc, test_echo);
    tcase_add_test(tc, test_describe1);
+   tcase_add_test(tc, test_deposit1);
+   tcase_add_test(tc, test_wave1);
    suite_add_tcase(s, tc);
 
    return s;